@@ -27,6 +27,7 @@
 #include <glibconfig.h>
 #include <sigc++/connection.h>
 #include <vector>
+#include "metrics_exporter.hpp"
 #include "pipe_manager.hpp"
 #include "presets_manager.hpp"
 #include "stream_input_effects.hpp"
@@ -60,6 +61,7 @@ struct _Application {
   StreamOutputEffects* soe;
   StreamInputEffects* sie;
   PresetsManager* presets_manager;
+  MetricsExporter* metrics_exporter;
 
   Data* data;
 };
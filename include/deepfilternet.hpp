@@ -19,14 +19,20 @@
 
 #pragma once
 
+#include <sys/types.h>
+#include <atomic>
+#include <cstddef>
 #include <memory>
+#include <mutex>
 #include <span>
 #include <string>
+#include <thread>
 #include <vector>
 #include "ladspa_wrapper.hpp"
 #include "pipe_manager.hpp"
 #include "plugin_base.hpp"
 #include "resampler.hpp"
+#include "ring_buffer.hpp"
 
 class DeepFilterNet : public PluginBase {
  public:
@@ -48,17 +54,77 @@ class DeepFilterNet : public PluginBase {
                std::span<float>& left_out,
                std::span<float>& right_out) override;
 
+  void process_native(std::span<float>& left_in,
+                      std::span<float>& right_in,
+                      std::span<float>& left_out,
+                      std::span<float>& right_out) override;
+
+  [[nodiscard]] auto get_native_rate() const -> uint override;
+
   auto get_latency_seconds() -> float override;
 
  private:
   std::unique_ptr<ladspa::LadspaWrapper> ladspa_wrapper;
 
+  static constexpr uint native_rate = 48000U;
+
+  static constexpr uint hop_size = 480U;  // frames DeepFilterNet advances per step at 48 kHz
+
+  static constexpr float model_latency = 0.02F;  // seconds added by the model itself
+
   bool resample = false;
-  bool resampler_ready = true;
+  bool buffered = false;  // resampling or using the worker. Otherwise the model runs directly on the quantum.
+  bool buffers_ready = true;
 
   std::unique_ptr<Resampler> resampler_inL, resampler_outL;
   std::unique_ptr<Resampler> resampler_inR, resampler_outR;
 
-  std::vector<float> resampled_outL, resampled_outR;
-  std::vector<float> carryover_l, carryover_r;
+  std::vector<float> resampled_l, resampled_r, hop_l, hop_r, hop_out_l, hop_out_r;
+
+  RingBuffer<float> native_in_l, native_in_r;  // at 48 kHz, waiting for a whole hop
+
+  RingBuffer<float> out_l, out_r;  // back at the graph rate, waiting to be sent
+
+  RingBuffer<float> native_out_l, native_out_r;  // worker output waiting to be sent by process_native()
+
+  /*
+    Optional worker thread running the model. The realtime thread hands it the audio through lock free rings and
+    collects the hops it finished, which are delayed by worker_hops hops. The delay absorbs the spikes in the time the
+    model takes, so the realtime thread never waits for it.
+  */
+
+  uint worker_hops = 0U;  // 0 runs the model in the realtime thread
+
+  bool use_worker = false;  // worker_hops as of the last setup()
+
+  SpscRingBuffer<float> worker_in_l, worker_in_r, worker_out_l, worker_out_r;
+
+  std::vector<float> worker_hop_l, worker_hop_r;
+
+  std::mutex worker_mutex;  // held by the worker while it runs and by setup() while it resizes the rings
+
+  std::atomic<uint> worker_serial = {0U};
+
+  std::atomic<bool> worker_quit = {false};
+
+  std::atomic<bool> worker_flush = {false};  // set by the realtime thread, cleared by the worker once its input is out
+
+  bool flush_pending = false;  // realtime thread only, a flush was requested and the output was not primed again yet
+
+  uint worker_overruns = 0U;  // times the worker fell so far behind that its input ring overflowed
+
+  size_t out_prime_frames = 0U, native_out_prime_frames = 0U;  // silence the output fifos start with
+
+  std::thread worker;
+
+  void worker_loop();
+
+  // Sends a processed hop at 48 kHz to the output fifo
+  void queue_hop(const std::span<const float>& left, const std::span<const float>& right);
+
+  // Asks the worker to drop its input after the ring overflowed
+  void request_worker_flush();
+
+  // Primes the output again once the worker confirmed the flush. False while the realtime thread still has to wait.
+  auto finish_worker_flush(RingBuffer<float>& fifo_l, RingBuffer<float>& fifo_r, const size_t& prime_frames) -> bool;
 };
@@ -19,7 +19,7 @@
 
 #pragma once
 
-#include <sigc++/signal.h>
+#include <atomic>
 #include <span>
 #include <string>
 #include "pipe_manager.hpp"
@@ -47,10 +47,10 @@ class Deesser : public PluginBase {
 
   auto get_latency_seconds() -> float override;
 
-  sigc::signal<void(const double)> compression, detected;
-
-  double compression_port_value = 0.0;
-  double detected_port_value = 0.0;
+  std::atomic<double> compression_port_value = 0.0;
+  std::atomic<double> detected_port_value = 0.0;
 
  private:
+  uint detected_port = 0U;
+  uint compression_port = 0U;
 };
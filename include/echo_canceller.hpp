@@ -19,13 +19,17 @@
 
 #pragma once
 
+#include <fftw3.h>
 #include <speex/speex_echo.h>
+#include <atomic>
 #include <climits>
 #include <span>
 #include <string>
+#include <thread>
 #include <vector>
 #include "pipe_manager.hpp"
 #include "plugin_base.hpp"
+#include "ring_buffer.hpp"
 
 #include <speex/speex_preprocess.h>
 #include <speex/speexdsp_config_types.h>
@@ -58,6 +62,9 @@ class EchoCanceller : public PluginBase {
  private:
   bool notify_latency = false;
   bool ready = false;
+  bool delay_estimation = true;
+  bool linked_mono = false;
+  bool enable_preprocess = true;
 
   uint filter_length_ms = 100U;
   uint latency_n_frames = 0U;
@@ -78,7 +85,63 @@ class EchoCanceller : public PluginBase {
 
   SpeexPreprocessState *state_left = nullptr, *state_right = nullptr;
 
+  /*
+    The probe reaches us before its echo reaches the microphone because of the output and input devices latencies. A
+    worker thread estimates this delay with GCC-PHAT on decimated copies of both signals and the probe is sent through
+    a delay line that removes most of it. This way the echo canceller filter only has to model the room.
+  */
+
+  static constexpr uint analysis_rate = 16000U;
+  static constexpr uint analysis_size = 16384U;  // about 1 second at the analysis rate
+  static constexpr uint analysis_hop = analysis_size / 4U;
+  static constexpr uint max_lag = analysis_size / 2U;
+  static constexpr float delay_margin = 0.01F;  // seconds left for the echo canceller filter to model
+  static constexpr float delay_hysteresis = 0.004F;  // seconds an estimate has to move before it is applied
+
+  uint decimation = 1U;
+  uint decimation_count = 0U;
+  uint applied_delay = 0U;
+
+  size_t delay_line_pos = 0U;
+
+  float mic_sum = 0.0F;
+  float probe_sum = 0.0F;
+
+  std::vector<float> delay_line;
+  std::vector<float> mic_decimated;
+  std::vector<float> probe_decimated;
+
+  SpscRingBuffer<float> estimator_mic;
+  SpscRingBuffer<float> estimator_probe;
+
+  std::atomic<int> estimated_delay = -1;  // frames at the decimated rate, -1 while unknown
+
+  // The members below are only touched by the estimator thread after the constructor
+
+  int last_lag = -1;
+
+  std::vector<float> mic_window;
+  std::vector<float> probe_window;
+  std::vector<float> correlation;
+
+  fftwf_complex* mic_spectrum = nullptr;
+  fftwf_complex* probe_spectrum = nullptr;
+
+  fftwf_plan mic_plan = nullptr;
+  fftwf_plan probe_plan = nullptr;
+  fftwf_plan correlation_plan = nullptr;
+
+  std::atomic<uint> estimator_serial = 0U;
+  std::atomic<bool> estimator_quit = false;
+  std::atomic<bool> estimator_reset = false;  // set by init_speex(), cleared by the estimator once the rings are empty
+
+  std::thread estimator;
+
   void free_speex();
 
   void init_speex();
+
+  void estimator_loop();
+
+  void estimate_delay();
 };
@@ -24,9 +24,11 @@
 #include <pipewire/proxy.h>
 #include <sigc++/connection.h>
 #include <sigc++/signal.h>
+#include <deque>
 #include <map>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 #include "autogain.hpp"
 #include "bass_enhancer.hpp"
@@ -44,6 +46,7 @@
 #include "expander.hpp"
 #include "filter.hpp"
 #include "gate.hpp"
+#include "generic_lv2.hpp"
 #include "limiter.hpp"
 #include "loudness.hpp"
 #include "maximizer.hpp"
@@ -93,6 +96,7 @@ class EffectsBase {
   std::shared_ptr<Expander> expander;
   std::shared_ptr<Filter> filter;
   std::shared_ptr<Gate> gate;
+  std::shared_ptr<GenericLv2> generic_lv2;
   std::shared_ptr<Limiter> limiter;
   std::shared_ptr<Loudness> loudness;
   std::shared_ptr<Maximizer> maximizer;
@@ -108,6 +112,8 @@ class EffectsBase {
 
   void reset_settings();
 
+  void set_export_metrics(const bool& state);
+
   sigc::signal<void(const float&)> pipeline_latency;
 
   auto get_plugins_map() -> std::map<std::string, std::shared_ptr<PluginBase>>;
@@ -122,18 +128,67 @@ class EffectsBase {
 
   std::string schema_base_path;
 
+  bool export_metrics = false;
+
   std::map<std::string, std::shared_ptr<PluginBase>> plugins;
 
+  /*
+    Plugins recently removed from the pipeline, the oldest at the front. They stay alive but disconnected from
+    PipeWire, so a preset that brings them back does not pay for instantiating them again. The settings path of a
+    plugin contains its instance id, so an entry is only reused for the same name. Their settings keep following the
+    database while they wait here.
+  */
+
+  using PooledPlugin = std::pair<std::string, std::shared_ptr<PluginBase>>;
+
+  static constexpr size_t max_pooled_plugins = 8U;
+
+  std::deque<PooledPlugin> plugins_pool;
+
   std::vector<pw_proxy*> list_proxies, list_proxies_listen_mic;
 
+  /*
+    Links of the main chain grouped by the pair of nodes (output, input) they connect. link_chain() compares the new
+    chain against it so that only the links around inserted, removed or moved nodes are created or destroyed.
+  */
+
+  std::map<std::pair<uint, uint>, std::vector<pw_proxy*>> chain_links;
+
   std::vector<sigc::connection> connections;
 
   std::vector<gulong> gconnections, gconnections_global;
 
   void create_filters_if_necessary();
 
+  // Moves the plugins that left the plugins list to plugins_pool
   void remove_unused_filters();
 
+  /*
+    Connects the plugins in the list that are not connected yet. All the connections are requested before waiting for
+    any of them, so the total time is roughly the one of the slowest plugin instead of the sum.
+  */
+
+  void connect_plugins_to_pw(const std::vector<std::string>& list);
+
+  void disconnect_unused_plugins(const std::vector<std::string>& list);
+
+  /*
+    Links the nodes in the order they appear in chain. Links already in place are kept and the new ones are created
+    before the obsolete ones are destroyed, so the audio is never interrupted. When allow_mono_source is true a single
+    link is accepted out of the first node.
+  */
+
+  void link_chain(const std::vector<uint>& chain, const bool& allow_mono_source = false);
+
+  void unlink_chain();
+
+  /*
+    Groups the runs of adjacent plugins in the list that share the same native rate into islands, so the audio is
+    resampled once around each run instead of around every plugin in it. See PluginBase::set_island().
+  */
+
+  void update_islands(const std::vector<std::string>& list);
+
   void activate_filters();
 
   void deactivate_filters();
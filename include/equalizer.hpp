@@ -61,6 +61,8 @@ class Equalizer : public PluginBase {
   static constexpr uint max_bands = 32U;
 
  private:
+  uint latency_port = 0U;
+
   GSettings *settings_left = nullptr, *settings_right = nullptr;
 
   uint latency_n_frames = 0U;
@@ -19,7 +19,7 @@
 
 #pragma once
 
-#include <sigc++/signal.h>
+#include <atomic>
 #include <span>
 #include <string>
 #include "pipe_manager.hpp"
@@ -47,9 +47,8 @@ class Exciter : public PluginBase {
 
   auto get_latency_seconds() -> float override;
 
-  sigc::signal<void(const double)> harmonics;
-
-  double harmonics_port_value = 0.0;
+  std::atomic<double> harmonics_port_value = 0.0;
 
  private:
+  uint harmonics_port = 0U;
 };
@@ -20,8 +20,8 @@
 #pragma once
 
 #include <pipewire/proxy.h>
-#include <sigc++/signal.h>
 #include <sys/types.h>
+#include <atomic>
 #include <span>
 #include <string>
 #include <vector>
@@ -54,14 +54,22 @@ class Expander : public PluginBase {
 
   void update_probe_links() override;
 
-  sigc::signal<void(const float)> reduction, sidechain, curve, envelope;
-
-  float reduction_port_value = 0.0F;
-  float sidechain_port_value = 0.0F;
-  float curve_port_value = 0.0F;
-  float envelope_port_value = 0.0F;
+  std::atomic<float> reduction_port_value = 0.0F;
+  std::atomic<float> sidechain_port_value = 0.0F;
+  std::atomic<float> curve_port_value = 0.0F;
+  std::atomic<float> envelope_port_value = 0.0F;
 
  private:
+  uint latency_port = 0U;
+  uint reduction_l_port = 0U;
+  uint reduction_r_port = 0U;
+  uint sidechain_l_port = 0U;
+  uint sidechain_r_port = 0U;
+  uint curve_l_port = 0U;
+  uint curve_r_port = 0U;
+  uint envelope_l_port = 0U;
+  uint envelope_r_port = 0U;
+
   uint latency_n_frames = 0U;
 
   std::vector<pw_proxy*> list_proxies;
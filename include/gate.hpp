@@ -20,8 +20,8 @@
 #pragma once
 
 #include <pipewire/proxy.h>
-#include <sigc++/signal.h>
 #include <sys/types.h>
+#include <atomic>
 #include <span>
 #include <string>
 #include <vector>
@@ -54,19 +54,30 @@ class Gate : public PluginBase {
 
   void update_probe_links() override;
 
-  sigc::signal<void(const float)> attack_zone_start, attack_threshold, release_zone_start, release_threshold, reduction,
-      sidechain, curve, envelope;
-
-  float attack_zone_start_port_value = 0.0F;
-  float attack_threshold_port_value = 0.0F;
-  float release_zone_start_port_value = 0.0F;
-  float release_threshold_port_value = 0.0F;
-  float reduction_port_value = 0.0F;
-  float sidechain_port_value = 0.0F;
-  float curve_port_value = 0.0F;
-  float envelope_port_value = 0.0F;
+  std::atomic<float> attack_zone_start_port_value = 0.0F;
+  std::atomic<float> attack_threshold_port_value = 0.0F;
+  std::atomic<float> release_zone_start_port_value = 0.0F;
+  std::atomic<float> release_threshold_port_value = 0.0F;
+  std::atomic<float> reduction_port_value = 0.0F;
+  std::atomic<float> sidechain_port_value = 0.0F;
+  std::atomic<float> curve_port_value = 0.0F;
+  std::atomic<float> envelope_port_value = 0.0F;
 
  private:
+  uint latency_port = 0U;
+  uint attack_zone_start_port = 0U;
+  uint attack_threshold_port = 0U;
+  uint release_zone_start_port = 0U;
+  uint release_threshold_port = 0U;
+  uint reduction_l_port = 0U;
+  uint reduction_r_port = 0U;
+  uint sidechain_l_port = 0U;
+  uint sidechain_r_port = 0U;
+  uint curve_l_port = 0U;
+  uint curve_r_port = 0U;
+  uint envelope_l_port = 0U;
+  uint envelope_r_port = 0U;
+
   uint latency_n_frames = 0U;
 
   std::vector<pw_proxy*> list_proxies;
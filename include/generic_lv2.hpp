@@ -0,0 +1,88 @@
+/*
+ *  Copyright © 2017-2024 Wellington Wallace
+ *
+ *  This file is part of Easy Effects.
+ *
+ *  Easy Effects is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Easy Effects is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <sigc++/signal.h>
+#include <sys/types.h>
+#include <climits>
+#include <span>
+#include <string>
+#include <vector>
+#include "lv2_wrapper.hpp"
+#include "pipe_manager.hpp"
+#include "plugin_base.hpp"
+
+/*
+  Hosts any installed LV2 plugin. Its uri is kept in the "uri" key and the values of its input controls in the
+  "controls" dictionary, keyed by port symbol. The plugin runs inside our filter on the buffers PipeWire gives us.
+*/
+
+class GenericLv2 : public PluginBase {
+ public:
+  GenericLv2(const std::string& tag,
+             const std::string& schema,
+             const std::string& schema_path,
+             PipeManager* pipe_manager,
+             PipelineType pipe_type);
+  GenericLv2(const GenericLv2&) = delete;
+  auto operator=(const GenericLv2&) -> GenericLv2& = delete;
+  GenericLv2(const GenericLv2&&) = delete;
+  auto operator=(const GenericLv2&&) -> GenericLv2& = delete;
+  ~GenericLv2() override;
+
+  void setup() override;
+
+  void process(std::span<float>& left_in,
+               std::span<float>& right_in,
+               std::span<float>& left_out,
+               std::span<float>& right_out) override;
+
+  auto get_latency_seconds() -> float override;
+
+  /*
+    Used by the user interface to build the controls of the loaded plugin. Main thread only.
+  */
+
+  [[nodiscard]] auto plugin_found() const -> bool;
+
+  // True when the plugin is installed but has ports we can not connect
+  [[nodiscard]] auto unsupported_ports() const -> bool;
+
+  [[nodiscard]] auto get_control_ports() const -> std::vector<lv2::Port>;
+
+  [[nodiscard]] auto get_control_value(const uint& index) const -> float;
+
+  [[nodiscard]] auto get_default_control_value(const uint& index) const -> float;
+
+  sigc::signal<void()> plugin_changed;  // emitted in the main thread after a new uri was loaded
+
+ private:
+  uint latency_port = UINT_MAX;
+
+  uint latency_n_frames = 0U;
+
+  bool mono_output = false;
+
+  bool has_unsupported_ports = false;
+
+  void load_plugin();
+
+  static auto check_ports(const lv2::Lv2Wrapper& wrapper) -> bool;
+};
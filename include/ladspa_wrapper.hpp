@@ -25,12 +25,15 @@
 #include <glib.h>
 #include <ladspa.h>
 #include <sys/types.h>
+#include <array>
+#include <atomic>
 #include <cmath>
 #include <limits>
 #include <span>
 #include <string>
 #include <tuple>
 #include <unordered_map>
+#include <vector>
 #include "string_literal_wrapper.hpp"
 #include "util.hpp"
 
@@ -63,7 +66,23 @@ class LadspaWrapper {
   void activate();
   void deactivate();
 
-  void run() const;
+  void run();
+
+  /*
+    Buffered processing for callers whose blocks do not live in memory they can hand to the plugin, like the output
+    of a resampler. set_max_block_size() allocates the buffers once. run_buffered() then copies the input to them and
+    runs the plugin on at most that many frames. When the plugin allows it the output is written over the input, so a
+    quantum costs one copy and no allocation. The spans it returns are valid until the next call.
+  */
+
+  void set_max_block_size(const uint& value);
+
+  void run_buffered(const std::span<const float>& left_in,
+                    const std::span<const float>& right_in,
+                    std::span<const float>& left_out,
+                    std::span<const float>& right_out);
+
+  [[nodiscard]] auto supports_in_place() const -> bool;
 
   [[nodiscard]] auto get_control_port_count() const -> uint;
   [[nodiscard]] auto get_control_port_name(uint index) const -> std::string;
@@ -248,6 +267,21 @@ class LadspaWrapper {
   LADSPA_Data* control_ports = nullptr;
   bool* control_ports_initialized = nullptr;
 
+  // Input values set by the main thread. run() copies them to control_ports before processing.
+  std::atomic<LADSPA_Data>* staged_control_ports = nullptr;
+  std::atomic<bool> control_ports_dirty = false;
+
+  void commit_control_ports();
+
+  // Last buffers given to connect_data_ports(): in left/right, probe left/right and out left/right
+  std::array<const LADSPA_Data*, 6U> connected_buffers{};
+
+  uint max_block_size = 0U;
+
+  std::vector<LADSPA_Data> buffer_l, buffer_r;  // input, and output as well when processing in place
+
+  std::vector<LADSPA_Data> buffer_out_l, buffer_out_r;  // only allocated if the plugin can not work in place
+
   std::unordered_map<std::string, unsigned long> map_cp_name_to_idx = std::unordered_map<std::string, unsigned long>();
 };
 
@@ -20,8 +20,8 @@
 #pragma once
 
 #include <pipewire/proxy.h>
-#include <sigc++/signal.h>
 #include <sys/types.h>
+#include <atomic>
 #include <span>
 #include <string>
 #include <vector>
@@ -54,14 +54,18 @@ class Limiter : public PluginBase {
 
   auto get_latency_seconds() -> float override;
 
-  sigc::signal<void(const float)> gain_left, gain_right, sidechain_left, sidechain_right;
-
-  float gain_l_port_value = 0.0F;
-  float gain_r_port_value = 0.0F;
-  float sidechain_l_port_value = 0.0F;
-  float sidechain_r_port_value = 0.0F;
+  std::atomic<float> gain_l_port_value = 0.0F;
+  std::atomic<float> gain_r_port_value = 0.0F;
+  std::atomic<float> sidechain_l_port_value = 0.0F;
+  std::atomic<float> sidechain_r_port_value = 0.0F;
 
  private:
+  uint latency_port = 0U;
+  uint gain_l_port = 0U;
+  uint gain_r_port = 0U;
+  uint sidechain_l_port = 0U;
+  uint sidechain_r_port = 0U;
+
   uint latency_n_frames = 0U;
 
   std::vector<pw_proxy*> list_proxies;
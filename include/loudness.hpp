@@ -48,5 +48,7 @@ class Loudness : public PluginBase {
   auto get_latency_seconds() -> float override;
 
  private:
+  uint latency_port = 0U;
+
   uint latency_n_frames = 0U;
 };
@@ -0,0 +1,69 @@
+/*
+ *  Copyright © 2017-2024 Wellington Wallace
+ *
+ *  This file is part of Easy Effects.
+ *
+ *  Easy Effects is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Easy Effects is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <sys/types.h>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace lv2 {
+
+class Lv2Wrapper;
+
+/*
+  One thread that loads and updates every opened native plugin ui. It ticks at the highest update rate requested by
+  the wrappers it serves and sleeps while no native ui is open.
+*/
+
+class UiScheduler {
+ public:
+  UiScheduler(const UiScheduler&) = delete;
+  auto operator=(const UiScheduler&) -> UiScheduler& = delete;
+  UiScheduler(const UiScheduler&&) = delete;
+  auto operator=(const UiScheduler&&) -> UiScheduler& = delete;
+
+  static auto get() -> UiScheduler&;
+
+  // The native ui of the client is loaded in the next tick
+  void add(Lv2Wrapper* client);
+
+  // Blocks until the current tick is over
+  void remove(Lv2Wrapper* client);
+
+ private:
+  UiScheduler();
+  ~UiScheduler();
+
+  std::mutex mutex;
+
+  std::condition_variable cv;
+
+  std::vector<Lv2Wrapper*> clients;
+
+  bool running = true;
+
+  std::thread thread;
+
+  void loop();
+};
+
+}  // namespace lv2
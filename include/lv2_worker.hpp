@@ -0,0 +1,102 @@
+/*
+ *  Copyright © 2017-2024 Wellington Wallace
+ *
+ *  This file is part of Easy Effects.
+ *
+ *  Easy Effects is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Easy Effects is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <sys/types.h>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <semaphore>
+#include <thread>
+#include <vector>
+
+namespace lv2 {
+
+class Lv2Wrapper;
+
+/*
+  Single producer, single consumer queue of variable sized messages. Neither side locks or allocates, so it can be used
+  from the realtime thread. reset() is only safe while nobody is reading or writing.
+*/
+
+class MessageRing {
+ public:
+  explicit MessageRing(const size_t& capacity);
+
+  auto write(const uint32_t& size, const void* data) -> bool;
+
+  // Copies the next message to data. Returns false when the queue is empty or the message does not fit.
+  auto read(void* data, const uint32_t& capacity, uint32_t& size) -> bool;
+
+  void reset();
+
+  [[nodiscard]] auto get_capacity() const -> size_t { return buffer.size(); }
+
+ private:
+  std::vector<uint8_t> buffer;
+
+  size_t mask = 0U;
+
+  std::atomic<size_t> read_pos = 0U, write_pos = 0U;
+
+  void copy_in(const size_t& pos, const void* data, const size_t& size);
+
+  void copy_out(const size_t& pos, void* data, const size_t& size) const;
+};
+
+/*
+  Non realtime thread shared by all the Lv2Wrapper instances whose plugin implements the LV2 Worker extension. The
+  realtime thread only pushes a request to the wrapper queue and calls wake_up().
+*/
+
+class Worker {
+ public:
+  Worker(const Worker&) = delete;
+  auto operator=(const Worker&) -> Worker& = delete;
+  Worker(const Worker&&) = delete;
+  auto operator=(const Worker&&) -> Worker& = delete;
+
+  static auto get() -> Worker&;
+
+  void add(Lv2Wrapper* client);
+
+  // Blocks until the worker is not running a request of this client anymore
+  void remove(Lv2Wrapper* client);
+
+  void wake_up();
+
+ private:
+  Worker();
+  ~Worker();
+
+  std::mutex mutex;
+
+  std::vector<Lv2Wrapper*> clients;
+
+  std::counting_semaphore<> pending{0};
+
+  std::atomic<bool> running = true;
+
+  std::thread thread;
+
+  void loop();
+};
+
+}  // namespace lv2
@@ -0,0 +1,106 @@
+/*
+ *  Copyright © 2017-2024 Wellington Wallace
+ *
+ *  This file is part of Easy Effects.
+ *
+ *  Easy Effects is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Easy Effects is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <lilv/lilv.h>
+#include <sys/types.h>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "lv2_wrapper.hpp"
+
+namespace lv2 {
+
+/*
+  What Lv2Wrapper needs to know about a plugin before instantiating it. It is kept in a cache file so that a warm start
+  does not have to parse the Turtle files of every installed bundle.
+*/
+
+struct PluginInfo {
+  std::string uri;
+
+  std::string bundle_uri;
+
+  int64_t bundle_mtime = 0;
+
+  std::vector<std::string> required_features;
+
+  std::vector<Port> ports;
+};
+
+/*
+  Process wide LilvWorld shared by all the Lv2Wrapper instances. Lilv is not thread safe, so every access to the world
+  or to the plugins it owns has to be done while holding the lock returned by lock().
+*/
+
+class World {
+ public:
+  World(const World&) = delete;
+  auto operator=(const World&) -> World& = delete;
+  World(const World&&) = delete;
+  auto operator=(const World&&) -> World& = delete;
+
+  static auto get() -> World&;
+
+  [[nodiscard]] auto lock() -> std::unique_lock<std::mutex>;
+
+  auto get_plugin_info(const std::string& uri) -> std::optional<PluginInfo>;
+
+  /*
+    Returns the lilv plugin, parsing only the bundle that contains it. get_plugin_info() must have been called for
+    this uri before. Must be called with the lock held.
+  */
+
+  auto get_plugin(const std::string& uri) -> const LilvPlugin*;
+
+  LilvWorld* world = nullptr;
+
+ private:
+  World();
+  ~World();
+
+  std::mutex mutex;
+
+  LilvWorld* discovery_world = nullptr;  // every installed bundle, only alive while scan_plugins() runs
+
+  std::string cache_file;
+
+  std::set<std::string> loaded_bundles;
+
+  std::unordered_map<std::string, PluginInfo> cache;
+
+  std::set<std::string> missing_plugins;
+
+  void scan_plugins();
+
+  void load_cache();
+
+  void save_cache() const;
+
+  auto read_plugin_info(const LilvPlugin* plugin) -> PluginInfo;
+
+  static auto get_bundle_mtime(const std::string& bundle_uri) -> int64_t;
+};
+
+}  // namespace lv2
@@ -25,10 +25,15 @@
 #include <lilv/lilv.h>
 #include <lv2/buf-size/buf-size.h>
 #include <lv2/core/lv2.h>
+#include <lv2/state/state.h>
 #include <lv2/ui/ui.h>
 #include <lv2/urid/urid.h>
+#include <lv2/worker/worker.h>
 #include <sys/types.h>
 #include <array>
+#include <atomic>
+#include <cstdint>
+#include <deque>
 #include <functional>
 #include <limits>
 #include <mutex>
@@ -36,6 +41,7 @@
 #include <string>
 #include <unordered_map>
 #include <vector>
+#include "lv2_worker.hpp"
 #include "string_literal_wrapper.hpp"
 #include "util.hpp"
 
@@ -47,7 +53,7 @@ using namespace std::string_literals;
 
 #define LV2_UI_makeSONameResident LV2_UI_PREFIX "makeSONameResident"
 
-enum PortType { TYPE_CONTROL, TYPE_AUDIO, TYPE_ATOM };
+enum PortType { TYPE_CONTROL, TYPE_AUDIO, TYPE_ATOM, TYPE_UNSUPPORTED };
 
 struct Port {
   PortType type;  // Datatype
@@ -67,6 +73,10 @@ struct Port {
   bool is_input;  // True if an input port
 
   bool optional;  // True if the connection is optional
+
+  bool is_discrete = false;  // True for toggled, integer and enumeration controls
+
+  bool reports_latency = false;  // True if the plugin writes its latency in frames to this port
 };
 
 class Lv2Wrapper {
@@ -102,16 +112,57 @@ class Lv2Wrapper {
 
   void activate();
 
-  void run() const;
+  void run();
 
   void deactivate();
 
+  /*
+    Control ports should be resolved once with port_ref() or find_control_port() and then accessed through their
+    index. Reading or writing a port by index is a plain array access, so it is cheap enough for process(). The
+    symbol based overloads are kept for setup code.
+
+    Input values are not written to the memory the plugin reads. They are staged and run() commits them at the
+    start of the next quantum.
+  */
+
+  [[nodiscard]] auto find_control_port(const std::string& symbol) const -> uint;
+
+  template <StringLiteralWrapper symbol_wrapper>
+  [[nodiscard]] auto port_ref() const -> uint {
+    return find_control_port(symbol_wrapper.msg.data());
+  }
+
+  void set_control_port_value(const uint& index, const float& value);
+
+  [[nodiscard]] auto get_control_port_value(const uint& index) const -> float;
+
+  [[nodiscard]] auto get_default_control_port_value(const uint& index) const -> float;
+
   void set_control_port_value(const std::string& symbol, const float& value);
 
   auto get_control_port_value(const std::string& symbol) -> float;
 
   auto has_instance() -> bool;
 
+  [[nodiscard]] auto get_ports() const -> const std::vector<Port>&;
+
+  [[nodiscard]] auto get_n_audio_in() const -> uint;
+
+  [[nodiscard]] auto get_n_audio_out() const -> uint;
+
+  // Index of the control output the plugin writes its latency to. UINT_MAX if it does not report one.
+  [[nodiscard]] auto get_latency_port() const -> uint;
+
+  /*
+    Plugin state that is not kept in control ports, saved through the LV2 State extension. create_instance() uses it
+    to carry the state over when the instance has to be created again. Both do nothing if the plugin does not
+    implement the extension.
+  */
+
+  auto save_state() -> bool;
+
+  auto restore_state() -> bool;
+
   void load_ui();
 
   void notify_ui();
@@ -128,91 +179,104 @@ class Lv2Wrapper {
 
   void native_ui_to_gsettings();
 
+  /*
+    Binds every input control port to one gsettings key holding a dictionary of port symbol to value. It is meant for
+    plugins whose ports are only known at runtime. Ports missing from the dictionary are set to their default value.
+  */
+
+  void bind_key_controls(GSettings* settings, const std::string& gkey);
+
   template <StringLiteralWrapper key_wrapper, StringLiteralWrapper gkey_wrapper>
   void bind_key_bool(GSettings* settings) {
-    set_control_port_value(key_wrapper.msg.data(),
-                           static_cast<float>(g_settings_get_boolean(settings, gkey_wrapper.msg.data())));
+    auto* binding = bind_port<key_wrapper>();
+
+    set_control_port_value(
+        binding->index, static_cast<float>(g_settings_get_boolean(settings, gkey_wrapper.msg.data())));
 
     g_signal_connect(settings, ("changed::"s + gkey_wrapper.msg.data()).c_str(),
                      G_CALLBACK(+[](GSettings* settings, char* key, gpointer user_data) {
-                       auto* self = static_cast<Lv2Wrapper*>(user_data);
+                       auto* binding = static_cast<PortBinding*>(user_data);
 
-                       self->set_control_port_value(key_wrapper.msg.data(),
-                                                    static_cast<float>(g_settings_get_boolean(settings, key)));
+                       binding->wrapper->set_control_port_value(
+                           binding->index, static_cast<float>(g_settings_get_boolean(settings, key)));
                      }),
-                     this);
+                     binding);
 
     auto gkey = gkey_wrapper.msg.data();
-    auto key = key_wrapper.msg.data();
+    auto index = binding->index;
 
-    gsettings_sync_funcs.emplace_back([settings, gkey, key, this]() {
-      g_settings_set_boolean(settings, gkey, static_cast<gboolean>(get_control_port_value(key)));
+    gsettings_sync_funcs.emplace_back([settings, gkey, index, this]() {
+      g_settings_set_boolean(settings, gkey, static_cast<gboolean>(get_control_port_value(index)));
     });
   }
 
   template <StringLiteralWrapper key_wrapper, StringLiteralWrapper gkey_wrapper>
   void bind_key_enum(GSettings* settings) {
-    set_control_port_value(key_wrapper.msg.data(),
-                           static_cast<float>(g_settings_get_enum(settings, gkey_wrapper.msg.data())));
+    auto* binding = bind_port<key_wrapper>();
+
+    set_control_port_value(binding->index, static_cast<float>(g_settings_get_enum(settings, gkey_wrapper.msg.data())));
 
     g_signal_connect(settings, ("changed::"s + gkey_wrapper.msg.data()).c_str(),
                      G_CALLBACK(+[](GSettings* settings, char* key, gpointer user_data) {
-                       auto* self = static_cast<Lv2Wrapper*>(user_data);
+                       auto* binding = static_cast<PortBinding*>(user_data);
 
-                       self->set_control_port_value(key_wrapper.msg.data(),
-                                                    static_cast<float>(g_settings_get_enum(settings, key)));
+                       binding->wrapper->set_control_port_value(
+                           binding->index, static_cast<float>(g_settings_get_enum(settings, key)));
                      }),
-                     this);
+                     binding);
 
     auto gkey = gkey_wrapper.msg.data();
-    auto key = key_wrapper.msg.data();
+    auto index = binding->index;
 
-    gsettings_sync_funcs.emplace_back([settings, gkey, key, this]() {
-      g_settings_set_enum(settings, gkey, static_cast<gint>(get_control_port_value(key)));
+    gsettings_sync_funcs.emplace_back([settings, gkey, index, this]() {
+      g_settings_set_enum(settings, gkey, static_cast<gint>(get_control_port_value(index)));
     });
   }
 
   template <StringLiteralWrapper key_wrapper, StringLiteralWrapper gkey_wrapper>
   void bind_key_int(GSettings* settings) {
-    set_control_port_value(key_wrapper.msg.data(),
-                           static_cast<float>(g_settings_get_int(settings, gkey_wrapper.msg.data())));
+    auto* binding = bind_port<key_wrapper>();
+
+    set_control_port_value(binding->index, static_cast<float>(g_settings_get_int(settings, gkey_wrapper.msg.data())));
 
     g_signal_connect(settings, ("changed::"s + gkey_wrapper.msg.data()).c_str(),
                      G_CALLBACK(+[](GSettings* settings, char* key, gpointer user_data) {
-                       auto* self = static_cast<Lv2Wrapper*>(user_data);
+                       auto* binding = static_cast<PortBinding*>(user_data);
 
-                       self->set_control_port_value(key_wrapper.msg.data(),
-                                                    static_cast<float>(g_settings_get_int(settings, key)));
+                       binding->wrapper->set_control_port_value(
+                           binding->index, static_cast<float>(g_settings_get_int(settings, key)));
                      }),
-                     this);
+                     binding);
 
     auto gkey = gkey_wrapper.msg.data();
-    auto key = key_wrapper.msg.data();
+    auto index = binding->index;
 
-    gsettings_sync_funcs.emplace_back([settings, gkey, key, this]() {
-      g_settings_set_int(settings, gkey, static_cast<gint>(get_control_port_value(key)));
+    gsettings_sync_funcs.emplace_back([settings, gkey, index, this]() {
+      g_settings_set_int(settings, gkey, static_cast<gint>(get_control_port_value(index)));
     });
   }
 
   template <StringLiteralWrapper key_wrapper, StringLiteralWrapper gkey_wrapper>
   void bind_key_double(GSettings* settings) {
-    set_control_port_value(key_wrapper.msg.data(),
-                           static_cast<float>(g_settings_get_double(settings, gkey_wrapper.msg.data())));
+    auto* binding = bind_port<key_wrapper>();
+
+    set_control_port_value(
+        binding->index, static_cast<float>(g_settings_get_double(settings, gkey_wrapper.msg.data())));
 
     g_signal_connect(settings, ("changed::"s + gkey_wrapper.msg.data()).c_str(),
                      G_CALLBACK(+[](GSettings* settings, char* key, gpointer user_data) {
-                       auto* self = static_cast<Lv2Wrapper*>(user_data);
+                       auto* binding = static_cast<PortBinding*>(user_data);
 
-                       self->set_control_port_value(key_wrapper.msg.data(),
-                                                    static_cast<float>(g_settings_get_double(settings, key)));
+                       binding->wrapper->set_control_port_value(
+                           binding->index, static_cast<float>(g_settings_get_double(settings, key)));
                      }),
-                     this);
+                     binding);
 
     auto gkey = gkey_wrapper.msg.data();
-    auto key = key_wrapper.msg.data();
+    auto index = binding->index;
 
-    gsettings_sync_funcs.emplace_back([settings, gkey, key, this]() {
-      g_settings_set_double(settings, gkey, static_cast<gdouble>(get_control_port_value(key)));
+    gsettings_sync_funcs.emplace_back([settings, gkey, index, this]() {
+      g_settings_set_double(settings, gkey, static_cast<gdouble>(get_control_port_value(index)));
     });
   }
 
@@ -223,11 +287,13 @@ class Lv2Wrapper {
     auto linear_v =
         (!lower_bound && key_v <= util::minimum_db_d_level) ? 0.0F : static_cast<float>(util::db_to_linear(key_v));
 
-    set_control_port_value(key_wrapper.msg.data(), linear_v);
+    auto* binding = bind_port<key_wrapper>();
+
+    set_control_port_value(binding->index, linear_v);
 
     g_signal_connect(settings, ("changed::"s + gkey_wrapper.msg.data()).c_str(),
                      G_CALLBACK(+[](GSettings* settings, char* key, gpointer user_data) {
-                       auto* self = static_cast<Lv2Wrapper*>(user_data);
+                       auto* binding = static_cast<PortBinding*>(user_data);
 
                        auto key_v = g_settings_get_double(settings, gkey_wrapper.msg.data());
 
@@ -235,15 +301,15 @@ class Lv2Wrapper {
                                            ? 0.0F
                                            : static_cast<float>(util::db_to_linear(key_v));
 
-                       self->set_control_port_value(key_wrapper.msg.data(), linear_v);
+                       binding->wrapper->set_control_port_value(binding->index, linear_v);
                      }),
-                     this);
+                     binding);
 
     auto gkey = gkey_wrapper.msg.data();
-    auto key = key_wrapper.msg.data();
+    auto index = binding->index;
 
-    gsettings_sync_funcs.emplace_back([settings, gkey, key, this]() {
-      const auto linear_v = get_control_port_value(key);
+    gsettings_sync_funcs.emplace_back([settings, gkey, index, this]() {
+      const auto linear_v = get_control_port_value(index);
 
       const auto db_v = (!lower_bound & (linear_v == 0.0F)) ? util::minimum_db_d_level : util::linear_to_db(linear_v);
 
@@ -254,11 +320,17 @@ class Lv2Wrapper {
  private:
   std::string plugin_uri;
 
-  LilvWorld* world = nullptr;
+  const LilvPlugin* plugin = nullptr;  // resolved from the shared world by the constructor
+
+  const LV2_Descriptor* descriptor = nullptr;
 
-  const LilvPlugin* plugin = nullptr;
+  void* plugin_library = nullptr;
 
-  LilvInstance* instance = nullptr;
+  std::string bundle_path;
+
+  LilvInstance instance_data{};
+
+  LilvInstance* instance = nullptr;  // points to instance_data while the plugin is instantiated
 
   LV2UI_Handle ui_handle = nullptr;
 
@@ -276,12 +348,76 @@ class Lv2Wrapper {
 
   uint rate = 0U;
 
-  uint ui_update_rate = 30U;
+  std::atomic<uint> ui_update_rate = 30U;
+
+  bool ui_scheduled = false;  // only used by the main thread
+
+  std::vector<float> ui_sent_values;  // last value of each port sent to the native ui
 
   std::vector<Port> ports;
 
-  // Multiband compressor/gate use 1+8*7=57 control ports. Round up to 64.
-  std::array<std::pair<size_t, uint>, 64> control_ports_cache;
+  std::vector<float> default_values;
+
+  std::unordered_map<std::string, uint> control_port_indices;
+
+  /*
+    Values written by the main thread to the input control ports. They are copied to Port::value by run(), so the
+    plugin never sees a value changing in the middle of a quantum.
+  */
+
+  std::vector<std::atomic<float>> staged_values;
+
+  std::atomic<bool> staged_values_dirty = false;
+
+  /*
+    Continuous controls are ramped to their new value instead of jumping to it. The quantum is split in sub blocks
+    and the value is interpolated between them. Toggles, integers and enumerations are never ramped.
+  */
+
+  // Kept above min_quantum, the minimum block length we promise to the plugins
+  static constexpr uint smoothing_block_size = 64U;
+
+  static constexpr uint max_smoothing_blocks = 16U;
+
+  uint n_ramps = 0U;
+
+  std::vector<uint> ramp_ports;
+
+  std::vector<float> ramp_start, ramp_end;
+
+  /*
+    Buffers the audio ports are connected to, in the order in left/right, probe left/right and out left/right.
+    PipeWire usually hands over the same buffers every cycle, so connect_data_ports() only talks to the plugin when
+    one of them changes.
+  */
+
+  std::array<float*, 6U> data_buffers{};
+
+  void stage_control_value(const uint& index, const float& value);
+
+  void commit_control_values();
+
+  void connect_data_buffers(const uint& offset);
+
+  /*
+    user_data of the gsettings handlers installed by the bind_key_* methods. A deque does not move its elements when
+    it grows, so the pointers given to GLib stay valid.
+  */
+
+  struct PortBinding {
+    Lv2Wrapper* wrapper;
+
+    uint index;
+  };
+
+  std::deque<PortBinding> port_bindings;
+
+  template <StringLiteralWrapper symbol_wrapper>
+  auto bind_port() -> PortBinding* {
+    port_bindings.push_back({this, port_ref<symbol_wrapper>()});
+
+    return &port_bindings.back();
+  }
 
   struct {
     struct { uint left, right; } in;
@@ -291,6 +427,16 @@ class Lv2Wrapper {
 
   std::vector<std::function<void()>> gsettings_sync_funcs;
 
+  GSettings* controls_settings = nullptr;
+
+  std::string controls_gkey;
+
+  gulong controls_handler_id = 0U;  // disconnected by the destructor, unlike the bind_key_* handlers
+
+  void load_controls_from_gsettings();
+
+  std::mutex urid_mutex;
+
   std::unordered_map<std::string, LV2_URID> map_uri_to_urid;
   std::unordered_map<LV2_URID, std::string> map_urid_to_uri;
 
@@ -298,13 +444,65 @@ class Lv2Wrapper {
 
   std::mutex ui_mutex;
 
-  void check_required_features();
+  friend class Worker;
+  friend class UiScheduler;
+
+  static constexpr size_t worker_ring_size = 8192U;
+
+  const LV2_Worker_Interface* worker_iface = nullptr;  // set by the constructor, the worker extension is static
+
+  std::atomic<LV2_Handle> work_handle = nullptr;  // instance the worker thread may use, null while it is replaced
+
+  std::atomic<bool> work_running = false;
 
-  void create_ports();
+  std::atomic<LV2_Handle> retired_handle = nullptr;  // replaced instance the worker thread releases after work()
+
+  LV2_Worker_Schedule worker_schedule{};  // the plugin keeps a pointer to it
+
+  MessageRing work_requests{worker_ring_size};   // realtime thread -> worker
+  MessageRing work_responses{worker_ring_size};  // worker -> realtime thread
+
+  std::vector<uint8_t> work_buffer = std::vector<uint8_t>(worker_ring_size);      // used by the worker thread
+  std::vector<uint8_t> response_buffer = std::vector<uint8_t>(worker_ring_size);  // used by the realtime thread
+
+  const LV2_State_Interface* state_iface = nullptr;
+
+  struct StateProperty {
+    std::string key;
+
+    std::string type;
+
+    uint32_t flags;
+
+    std::vector<uint8_t> value;
+  };
+
+  std::vector<StateProperty> saved_state;
+
+  void process_work_requests();
+
+  void deliver_work_responses();
+
+  void free_instance();
+
+  void release_handle(LV2_Handle handle);
+
+  auto load_descriptor() -> bool;
+
+  void instantiate_ui();
+
+  // Returns false when there is no native ui to update anymore
+  auto ui_tick() -> bool;
+
+  void check_required_features(const std::vector<std::string>& required_features);
+
+  void create_ports(const std::vector<Port>& plugin_ports);
 
   void connect_control_ports();
 
   auto map_urid(const std::string& uri) -> LV2_URID;
+
+  auto unmap_urid(const LV2_URID& urid) -> const char*;
 };
 
 }  // namespace lv2
@@ -19,8 +19,8 @@
 
 #pragma once
 
-#include <sigc++/signal.h>
 #include <sys/types.h>
+#include <atomic>
 #include <span>
 #include <string>
 #include "pipe_manager.hpp"
@@ -48,10 +48,11 @@ class Maximizer : public PluginBase {
 
   auto get_latency_seconds() -> float override;
 
-  sigc::signal<void(const double)> reduction;
-
-  double reduction_port_value = 0.0;
+  std::atomic<double> reduction_port_value = 0.0;
 
  private:
+  uint latency_port = 0U;
+  uint reduction_port = 0U;
+
   uint latency_n_frames = 0U;
 };
@@ -0,0 +1,63 @@
+/*
+ *  Copyright © 2017-2024 Wellington Wallace
+ *
+ *  This file is part of Easy Effects.
+ *
+ *  Easy Effects is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Easy Effects is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <gio/gio.h>
+#include <string>
+#include <vector>
+#include "effects_base.hpp"
+#include "pipe_manager.hpp"
+
+/*
+  Serves a Prometheus style text report on a Unix socket so the audio health of the effects pipelines can be monitored
+  without opening the window. The realtime threads only aggregate the values in atomics. All the formatting is done
+  here in the main thread when a collector connects.
+*/
+
+class MetricsExporter {
+ public:
+  MetricsExporter(PipeManager* pipe_manager, EffectsBase* soe, EffectsBase* sie);
+  MetricsExporter(const MetricsExporter&) = delete;
+  auto operator=(const MetricsExporter&) -> MetricsExporter& = delete;
+  MetricsExporter(const MetricsExporter&&) = delete;
+  auto operator=(const MetricsExporter&&) -> MetricsExporter& = delete;
+  ~MetricsExporter();
+
+  [[nodiscard]] auto build_report() const -> std::string;
+
+ private:
+  std::string log_tag = "metrics_exporter: ";
+
+  std::string socket_path;
+
+  PipeManager* pm = nullptr;
+
+  EffectsBase *soe = nullptr, *sie = nullptr;
+
+  GSettings* settings = nullptr;
+
+  GSocketService* service = nullptr;
+
+  std::vector<gulong> gconnections;
+
+  void start();
+
+  void stop();
+};
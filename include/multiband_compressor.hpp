@@ -23,9 +23,9 @@
 #include <glib-object.h>
 #include <glib.h>
 #include <pipewire/context.h>
-#include <sigc++/signal.h>
 #include <sys/types.h>
 #include <array>
+#include <atomic>
 #include <cstddef>
 #include <span>
 #include <string>
@@ -63,14 +63,19 @@ class MultibandCompressor : public PluginBase {
 
   void update_probe_links() override;
 
-  sigc::signal<void(const std::array<float, n_bands>)> reduction, envelope, curve, frequency_range;
-
-  std::array<float, n_bands> frequency_range_end_port_array = {0.0F, 0.0F, 0.0F, 0.0F, 0.0F, 0.0F, 0.0F, 0.0F};
-  std::array<float, n_bands> envelope_port_array = {0.0F, 0.0F, 0.0F, 0.0F, 0.0F, 0.0F, 0.0F, 0.0F};
-  std::array<float, n_bands> curve_port_array = {0.0F, 0.0F, 0.0F, 0.0F, 0.0F, 0.0F, 0.0F, 0.0F};
-  std::array<float, n_bands> reduction_port_array = {0.0F, 0.0F, 0.0F, 0.0F, 0.0F, 0.0F, 0.0F, 0.0F};
+  std::array<std::atomic<float>, n_bands> frequency_range_end_port_array{};
+  std::array<std::atomic<float>, n_bands> envelope_port_array{};
+  std::array<std::atomic<float>, n_bands> curve_port_array{};
+  std::array<std::atomic<float>, n_bands> reduction_port_array{};
 
  private:
+  uint latency_port = 0U;
+
+  std::array<uint, n_bands> frequency_range_end_port{};
+  std::array<uint, n_bands> envelope_l_port{}, envelope_r_port{};
+  std::array<uint, n_bands> curve_l_port{}, curve_r_port{};
+  std::array<uint, n_bands> reduction_l_port{}, reduction_r_port{};
+
   uint latency_n_frames = 0U;
 
   std::vector<pw_proxy*> list_proxies;
@@ -29,10 +29,14 @@
 #include <spa/utils/json.h>
 #include <sys/types.h>
 #include <array>
+#include <chrono>
+#include <condition_variable>
 #include <cstddef>
 #include <cstdint>
 #include <map>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include "pipe_objects.hpp"
 
@@ -68,6 +72,30 @@ class PipeManager {
 
   std::vector<DeviceInfo> list_devices;
 
+  /*
+    Hash indexes over the lists above. They are kept up to date by the registry callbacks so that looking an object up
+    by id, serial or owning node does not require walking the whole list. Removing from a list moves its last element
+    into the freed position, so the lists are not kept in registration order.
+  */
+
+  std::unordered_map<uint, uint64_t> node_serial_by_id;
+
+  std::unordered_map<uint64_t, size_t> link_index_by_serial, port_index_by_serial, module_index_by_serial,
+      client_index_by_serial, device_index_by_serial;
+
+  std::unordered_map<uint, std::vector<uint64_t>> link_serials_by_node, port_serials_by_node;
+
+  /*
+    Guards list_ports and its indexes. The registry callbacks notify ports_cv every time a port is added so threads
+    waiting for the ports of a node to show up do not have to poll.
+  */
+
+  std::mutex ports_mutex;
+
+  std::condition_variable ports_cv;
+
+  constexpr static auto wait_timeout = std::chrono::seconds(10);
+
   std::string default_output_device_name, default_input_device_name;
 
   NodeInfo ee_sink_node, ee_source_node;
@@ -104,6 +132,22 @@ class PipeManager {
 
   auto count_node_ports(const uint& node_id) -> uint;
 
+  /*
+    Blocks until the node node_id has at least n_ports ports. Returns false if it did not happen before the timeout
+  */
+
+  auto wait_node_ports(const uint& node_id,
+                       const uint& n_ports,
+                       const std::chrono::milliseconds& timeout = wait_timeout) -> bool;
+
+  auto get_node_ports(const uint& node_id) -> std::vector<PortInfo>;
+
+  /*
+    Links having the node node_id as their input or output
+  */
+
+  auto get_node_links(const uint& node_id) -> std::vector<LinkInfo>;
+
   /*
     Links the output ports of the node output_node_id to the input ports of the node input_node_id
   */
@@ -20,13 +20,13 @@
 #pragma once
 
 #include <STTypes.h>
-#include <deque>
 #include <span>
 #include <string>
 #include <vector>
 #include "SoundTouch.h"
 #include "pipe_manager.hpp"
 #include "plugin_base.hpp"
+#include "ring_buffer.hpp"
 
 class Pitch : public PluginBase {
  public:
@@ -64,7 +64,7 @@ class Pitch : public PluginBase {
 
   std::vector<float> data_L, data_R, data;
 
-  std::deque<float> deque_out_L, deque_out_R;
+  RingBuffer<float> out_L, out_R;
 
   soundtouch::SoundTouch* snd_touch = nullptr;
 
@@ -88,4 +88,5 @@ class Pitch : public PluginBase {
   void set_tempo_difference();
   void set_rate_difference();
   void init_soundtouch();
+  void prime_output();
 };
@@ -26,7 +26,10 @@
 #include <sigc++/signal.h>
 #include <spa/utils/hook.h>
 #include <sys/types.h>
+#include <array>
 #include <chrono>
+#include <condition_variable>
+#include <cstdint>
 #include <memory>
 #include <mutex>
 #include <span>
@@ -35,6 +38,8 @@
 #include "lv2_wrapper.hpp"
 #include "pipe_manager.hpp"
 #include "pipeline_type.hpp"
+#include "resampler.hpp"
+#include "ring_buffer.hpp"
 #include "util.hpp"
 
 class PluginBase {
@@ -95,6 +100,18 @@ class PluginBase {
   std::atomic<bool> bypass = {false};
   static_assert(std::atomic<bool>::is_always_lock_free);
 
+  /*
+    setup() is deferred while the plugin is bypassed, so the stages of a preset that are never enabled do not pay for
+    instances, threads and plans. Turning the bypass off warms the plugin up in the main thread and the realtime thread
+    passes the audio through until it is done. setting_up is held by whichever thread is running setup().
+  */
+
+  std::atomic<bool> initialized = {false};
+
+  std::atomic<bool> setting_up = {false};
+
+  uint setup_rate = 0U, setup_n_samples = 0U;  // what the last setup() call was done for
+
   bool connected_to_pw = false;
 
   bool send_notifications = false;
@@ -105,6 +122,10 @@ class PluginBase {
 
   float latency_value = 0.0F;  // seconds
 
+  float native_latency_value = 0.0F;  // seconds added by process_native() alone
+
+  float island_latency_value = 0.0F;  // seconds added by the resamplers of the island this plugin leads
+
   std::chrono::time_point<std::chrono::system_clock> clock_start;
 
   std::vector<float> dummy_left, dummy_right;
@@ -115,8 +136,21 @@ class PluginBase {
 
   void set_post_messages(const bool& state);
 
+  void set_export_metrics(const bool& state);
+
+  void update_metrics(const uint64_t& clock_position, const uint64_t& process_time_ns);
+
   auto connect_to_pw() -> bool;
 
+  /*
+    connect_to_pw() split in two halves. The pipelines request the connection of all their filters first and only then
+    wait for each of them, so PipeWire can bring the nodes up concurrently.
+  */
+
+  auto request_pw_connection() -> bool;
+
+  auto wait_pw_connection() -> bool;
+
   void disconnect_from_pw();
 
   void reset_settings();
@@ -143,15 +177,84 @@ class PluginBase {
 
   virtual void update_probe_links();
 
+  /*
+    Plugins that only work at one sampling rate resample the audio in and out on their own. When several of them are
+    adjacent in the pipeline EffectsBase joins them in an island. Its first plugin resamples once to the native rate,
+    runs itself and the other members through process_native() and resamples back, while the other members pass the
+    audio through in their own PipeWire nodes.
+  */
+
+  std::atomic<bool> island_leader = {false}, island_member = {false};
+
+  [[nodiscard]] virtual auto get_native_rate() const -> uint;  // 0 when any rate works
+
+  // Same as process() but the audio is already at get_native_rate() and the buffers may be of any size
+  virtual void process_native(std::span<float>& left_in,
+                              std::span<float>& right_in,
+                              std::span<float>& left_out,
+                              std::span<float>& right_out);
+
+  // Makes this plugin the leader of an island with the members that follow it. An empty list dissolves the island.
+  void set_island(const std::vector<std::shared_ptr<PluginBase>>& members);
+
+  // Called by the realtime thread at the start of every cycle to take the state queued by set_island()
+  void receive_island();
+
+  void process_island(std::span<float>& left_in,
+                      std::span<float>& right_in,
+                      std::span<float>& left_out,
+                      std::span<float>& right_out);
+
+  void follow_island(std::span<float>& left_in,
+                     std::span<float>& right_in,
+                     std::span<float>& left_out,
+                     std::span<float>& right_out);
+
   virtual auto get_latency_seconds() -> float;
 
-  sigc::signal<void(const float, const float)> input_level;
-  sigc::signal<void(const float, const float)> output_level;
+  /*
+    What a plugin inside an island adds to the pipeline latency. A member only adds its native path, while the leader
+    also accounts for the resampling around the whole island.
+  */
+
+  [[nodiscard]] auto get_island_latency_seconds() const -> float;
+
+  // Sends the value of get_latency_seconds() to the PipeWire node
+  void update_filter_params();
+
   sigc::signal<void()> latency;
 
+  /*
+    Meter table. The realtime thread publishes the peaks here in notify() and the user interface pulls them once per
+    frame clock tick. A new serial tells the reader that the values changed since its last visit.
+  */
+
+  std::atomic<float> input_level_left_db = util::minimum_db_level, input_level_right_db = util::minimum_db_level;
+  std::atomic<float> output_level_left_db = util::minimum_db_level, output_level_right_db = util::minimum_db_level;
+  static_assert(std::atomic<float>::is_always_lock_free);
+
+  std::atomic<uint> meters_serial = {0U};
+
+  /*
+    Statistics for the metrics exporter. They are aggregated by the realtime thread and only read by the exporter, so
+    scraping them does not add any work to the audio thread.
+  */
+
+  std::atomic<bool> collect_metrics = {false};
+
+  std::atomic<uint64_t> dsp_time_ns = {0U};  // total time spent in process()
+
+  std::atomic<float> dsp_load = 0.0F;  // fraction of the quantum duration spent in process() in the last window
+
+  std::atomic<uint64_t> xruns = {0U};  // discontinuities in the driver clock position
+
  protected:
   std::mutex data_mutex;
 
+  std::mutex state_mutex;  // guards state and can_get_node_id
+
+  std::condition_variable state_cv;
+
   GSettings *settings = nullptr, *global_settings = nullptr;
 
   PipeManager* pm = nullptr;
@@ -162,6 +265,8 @@ class PluginBase {
 
   bool post_messages = false;
 
+  bool ui_post_messages = false;
+
   uint n_ports = 4U;
 
   float input_gain = 1.0F;
@@ -175,6 +280,8 @@ class PluginBase {
 
   void initialize_listener();
 
+  void warm_up();
+
   void notify();
 
   void get_peaks(const std::span<float>& left_in,
@@ -184,11 +291,45 @@ class PluginBase {
 
   static void apply_gain(std::span<float>& left, std::span<float>& right, const float& gain);
 
-  void update_filter_params();
-
  private:
   uint node_id = 0U;
 
+  uint64_t expected_clock_position = 0U;
+
+  uint64_t window_dsp_time_ns = 0U, window_audio_time_ns = 0U;
+
   float input_peak_left = util::minimum_linear_level, input_peak_right = util::minimum_linear_level;
   float output_peak_left = util::minimum_linear_level, output_peak_right = util::minimum_linear_level;
+
+  /*
+    Everything the island leader uses on the realtime thread. It is built on the main thread for one rate and quantum
+    and handed over through island_pending. The one it replaces comes back through island_retired and is freed on the
+    main thread, so the realtime thread never allocates, frees or locks anything for the island.
+  */
+
+  struct Island {
+    std::vector<std::shared_ptr<PluginBase>> members;
+
+    uint rate = 0U, n_samples = 0U;
+
+    std::unique_ptr<Resampler> resampler_inL, resampler_inR;
+    std::unique_ptr<Resampler> resampler_outL, resampler_outR;
+
+    std::array<std::vector<float>, 2U> buffer_L, buffer_R;  // ping pong between the members
+
+    std::vector<float> out_L, out_R;
+
+    RingBuffer<float> fifo_L, fifo_R;  // frames resampled back but not sent yet
+  };
+
+  std::vector<std::shared_ptr<PluginBase>> island;  // main thread only
+
+  std::atomic<Island*> island_pending = {nullptr}, island_retired = {nullptr};
+
+  Island* island_state = nullptr;  // realtime thread only
+
+  std::atomic<bool> island_rebuild_requested = {false};
+
+  // Builds the island state for the current rate and quantum and queues it for the realtime thread
+  void publish_island();
 };
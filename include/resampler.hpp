@@ -20,43 +20,49 @@
 #pragma once
 
 #include <samplerate.h>
+#include <sys/types.h>
 #include <cmath>
+#include <cstddef>
+#include <span>
 #include <vector>
 
+enum class ResamplerQuality { fastest, medium, best };
+
 class Resampler {
  public:
-  Resampler(const int& input_rate, const int& output_rate);
+  Resampler(const int& input_rate,
+            const int& output_rate,
+            const ResamplerQuality& quality = ResamplerQuality::fastest);
   Resampler(const Resampler&) = delete;
   auto operator=(const Resampler&) -> Resampler& = delete;
   Resampler(const Resampler&&) = delete;
   auto operator=(const Resampler&&) -> Resampler& = delete;
   ~Resampler();
 
-  template <typename T>
-  auto process(const T& input, const bool& end_of_input) -> const std::vector<float>& {
-    output.resize(std::ceil(1.5 * resample_ratio * input.size()));
-
-    // The number of frames of data pointed to by data_in
-    src_data.input_frames = input.size();
-
-    // A pointer to the input data samples
-    src_data.data_in = input.data();
+  /*
+    Streaming interface meant for the realtime thread. The output is written to memory owned by the caller and the
+    number of frames written is returned, so nothing is allocated. All the input is consumed as long as output has
+    room for get_max_output_frames(input.size()) frames.
+  */
 
-    // Maximum number of frames pointed to by data_out
-    src_data.output_frames = static_cast<long>(output.size());
+  auto process(const std::span<const float>& input, const std::span<float>& out, const bool& end_of_input = false)
+      -> size_t;
 
-    // A pointer to the output data samples
-    src_data.data_out = output.data();
+  [[nodiscard]] auto get_max_output_frames(const size_t& n_input_frames) const -> size_t;
 
-    // Equal to output_sample_rate / input_sample_rate
-    src_data.src_ratio = resample_ratio;
+  // Delay added by the interpolation filter, in frames at the output rate
+  [[nodiscard]] auto get_latency_frames() const -> uint;
 
-    // Equal to 0 if more input data is available and 1 otherwise
-    src_data.end_of_input = static_cast<int>(end_of_input);
+  /*
+    Convenience version for code outside of the realtime thread, like the convolver impulse loading. The returned
+    vector is owned by the resampler and is reused by the next call.
+  */
 
-    src_process(src_state, &src_data);
+  template <typename T>
+  auto process(const T& input, const bool& end_of_input) -> const std::vector<float>& {
+    output.resize(get_max_output_frames(input.size()));
 
-    output.resize(src_data.output_frames_gen);
+    output.resize(process(std::span<const float>(input.data(), input.size()), output, end_of_input));
 
     return output;
   }
@@ -64,9 +70,15 @@ class Resampler {
  private:
   double resample_ratio = 1.0;
 
+  int converter_type = SRC_SINC_FASTEST;
+
+  uint latency_frames = 0U;
+
   SRC_STATE* src_state = nullptr;
 
   SRC_DATA src_data{};
 
   std::vector<float> output;
+
+  void measure_latency();
 };
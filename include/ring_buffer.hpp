@@ -0,0 +1,173 @@
+/*
+ *  Copyright © 2017-2024 Wellington Wallace
+ *
+ *  This file is part of Easy Effects.
+ *
+ *  Easy Effects is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Easy Effects is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+/*
+  Fixed capacity FIFO for the realtime thread. resize() is the only method that allocates, so it has to be called in
+  setup(). Pushing more than the free space drops the frames that do not fit.
+*/
+
+template <typename T>
+class RingBuffer {
+ public:
+  void resize(const size_t& capacity) {
+    data.assign(capacity, T{});
+
+    clear();
+  }
+
+  void clear() {
+    head = 0U;
+    count = 0U;
+  }
+
+  [[nodiscard]] auto size() const -> size_t { return count; }
+
+  [[nodiscard]] auto capacity() const -> size_t { return data.size(); }
+
+  [[nodiscard]] auto empty() const -> bool { return count == 0U; }
+
+  auto push(const std::span<const T>& values) -> size_t {
+    const auto n = std::min(values.size(), data.size() - count);
+
+    auto tail = (head + count) % std::max<size_t>(data.size(), 1U);
+
+    const auto first = std::min(n, data.size() - tail);
+
+    std::copy_n(values.begin(), first, data.begin() + tail);
+    std::copy_n(values.begin() + first, n - first, data.begin());
+
+    count += n;
+
+    return n;
+  }
+
+  auto push_silence(const size_t& n_values) -> size_t {
+    const auto n = std::min(n_values, data.size() - count);
+
+    for (size_t i = 0U, tail = head + count; i < n; i++, tail++) {
+      data[tail % data.size()] = T{};
+    }
+
+    count += n;
+
+    return n;
+  }
+
+  auto pop(const std::span<T>& values) -> size_t {
+    const auto n = std::min(values.size(), count);
+
+    const auto first = std::min(n, data.size() - head);
+
+    std::copy_n(data.begin() + head, first, values.begin());
+    std::copy_n(data.begin(), n - first, values.begin() + first);
+
+    head = (n == 0U) ? head : (head + n) % data.size();
+
+    count -= n;
+
+    return n;
+  }
+
+  // Drops the oldest values, like pop() without copying them anywhere
+  auto discard(const size_t& n_values) -> size_t {
+    const auto n = std::min(n_values, count);
+
+    head = (n == 0U) ? head : (head + n) % data.size();
+
+    count -= n;
+
+    return n;
+  }
+
+ private:
+  std::vector<T> data;
+
+  size_t head = 0U, count = 0U;
+};
+
+/*
+  Lock free version for one producer thread and one consumer thread. Only the producer may call push() and only the
+  consumer may call pop(). resize() and clear() require both of them to be idle.
+*/
+
+template <typename T>
+class SpscRingBuffer {
+ public:
+  void resize(const size_t& capacity) {
+    data.assign(capacity, T{});
+
+    clear();
+  }
+
+  void clear() {
+    read_index.store(0U, std::memory_order_relaxed);
+    write_index.store(0U, std::memory_order_relaxed);
+  }
+
+  [[nodiscard]] auto size() const -> size_t {
+    return write_index.load(std::memory_order_acquire) - read_index.load(std::memory_order_acquire);
+  }
+
+  [[nodiscard]] auto capacity() const -> size_t { return data.size(); }
+
+  auto push(const std::span<const T>& values) -> size_t {
+    const auto write = write_index.load(std::memory_order_relaxed);
+    const auto read = read_index.load(std::memory_order_acquire);
+
+    const auto n = std::min(values.size(), data.size() - (write - read));
+
+    for (size_t i = 0U; i < n; i++) {
+      data[(write + i) % data.size()] = values[i];
+    }
+
+    write_index.store(write + n, std::memory_order_release);
+
+    return n;
+  }
+
+  auto pop(const std::span<T>& values) -> size_t {
+    const auto read = read_index.load(std::memory_order_relaxed);
+    const auto write = write_index.load(std::memory_order_acquire);
+
+    const auto n = std::min(values.size(), write - read);
+
+    for (size_t i = 0U; i < n; i++) {
+      values[i] = data[(read + i) % data.size()];
+    }
+
+    read_index.store(read + n, std::memory_order_release);
+
+    return n;
+  }
+
+ private:
+  std::vector<T> data;
+
+  // Running counts of the values written and read. Their difference is the number of values stored.
+
+  std::atomic<size_t> read_index = {0U}, write_index = {0U};
+};
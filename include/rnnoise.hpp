@@ -22,20 +22,24 @@
 #include <sigc++/signal.h>
 #include <sys/types.h>
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <climits>
 #include <cstddef>
 #include <memory>
 #include <span>
 #include <string>
+#include <thread>
+#include <utility>
 #include <vector>
 #include "pipe_manager.hpp"
 #ifdef ENABLE_RNNOISE
 #include <rnnoise.h>
 #endif
 
-#include <deque>
 #include "plugin_base.hpp"
 #include "resampler.hpp"
+#include "ring_buffer.hpp"
 
 class RNNoise : public PluginBase {
  public:
@@ -57,6 +61,13 @@ class RNNoise : public PluginBase {
                std::span<float>& left_out,
                std::span<float>& right_out) override;
 
+  void process_native(std::span<float>& left_in,
+                      std::span<float>& right_in,
+                      std::span<float>& left_out,
+                      std::span<float>& right_out) override;
+
+  [[nodiscard]] auto get_native_rate() const -> uint override;
+
   auto get_latency_seconds() -> float override;
 
   void init_release();
@@ -82,6 +93,8 @@ class RNNoise : public PluginBase {
   bool rnnoise_ready = false;
   bool resampler_ready = false;
   bool enable_vad = false;
+  std::atomic<bool> linked_mono = {false};  // written by the settings handler, read by the realtime thread
+  bool block_linked = false;  // linked_mono latched at the start of each block
 
   uint blocksize = 480U;
   uint rnnoise_rate = 48000U;
@@ -93,9 +106,9 @@ class RNNoise : public PluginBase {
 
   const float inv_short_max = 1.0F / (SHRT_MAX + 1.0F);
 
-  std::deque<float> deque_out_L, deque_out_R;
+  RingBuffer<float> out_L, out_R;  // denoised frames waiting to be sent, sized in setup()
 
-  std::vector<float> data_L, data_R, data_tmp;
+  std::vector<float> data_L, data_R, data_tmp_L, data_tmp_R;
   std::vector<float> resampled_data_L, resampled_data_R;
 
   std::unique_ptr<Resampler> resampler_inL, resampler_outL;
@@ -103,105 +116,107 @@ class RNNoise : public PluginBase {
 
 #ifdef ENABLE_RNNOISE
 
-  RNNModel* model = nullptr;
+  std::shared_ptr<RNNModel> model;  // nullptr for the standard model
 
   DenoiseState *state_left = nullptr, *state_right = nullptr;
 
   float vad_prob_left, vad_prob_right;
   int vad_grace_left, vad_grace_right;
 
-  auto get_model_from_name() -> RNNModel*;
+  /*
+    Helper thread that denoises a copy of the right channel while the realtime thread does the left one. A job the
+    worker did not pick up within max_worker_wait is taken back and done inline. A job it already started is waited
+    for, so the right channel is always denoised. The thread only runs while linked mono is off.
+  */
 
-  void free_rnnoise();
+  static constexpr uint job_idle = 0U, job_pending = 1U, job_busy = 2U;
 
-  template <typename T1, typename T2>
-  void remove_noise(const T1& left_in, const T1& right_in, T2& out_L, T2& out_R) {
-    for (const auto& v : left_in) {
-      data_L.push_back(v);
+  static constexpr auto max_worker_wait = std::chrono::microseconds(1000);
 
-      if (data_L.size() == blocksize) {
-        if (state_left != nullptr) {
-          std::ranges::for_each(data_L, [](auto& v) { v *= static_cast<float>(SHRT_MAX + 1); });
+  std::atomic<uint> worker_job = {job_idle};
 
-          data_tmp = data_L;
+  std::atomic<uint> worker_serial = {0U};
 
-          vad_prob_left = rnnoise_process_frame(state_left, data_L.data(), data_L.data());
+  std::atomic<bool> worker_quit = {false}, worker_running = {false};
 
-          if (enable_vad) {
-            if (vad_prob_left >= vad_thres) {
-              vad_grace_left = release;
-            }
+  std::vector<float> worker_data_R;
 
-            if (vad_grace_left >= 0) {
-              --vad_grace_left;
+  std::thread worker;
 
-              for (size_t i = 0U; i < data_L.size(); i++) {
-                data_L[i] = data_L[i] * wet_ratio + data_tmp[i] * (1.0F - wet_ratio);
+  std::atomic<uint> model_generation = {0U};  // the last model requested, so a slower load can not win
 
-                data_L[i] *= inv_short_max;
-              }
-            } else {
-              std::ranges::for_each(data_L, [&](auto& v) { v = 0.0F; });
-            }
-          } else {
-            for (size_t i = 0U; i < data_L.size(); i++) {
-              data_L[i] = data_L[i] * wet_ratio + data_tmp[i] * (1.0F - wet_ratio);
+  std::vector<std::thread> mythreads;
 
-              data_L[i] *= inv_short_max;
-            }
-          }
-        }
+  /*
+    Returns the selected model, nullptr for the standard one, and whether a custom model failed to load. It runs on
+    the loading threads, so it leaves standard_model and model_changed to load_model().
+  */
 
-        for (const auto& v : data_L) {
-          out_L.push_back(v);
-        }
+  auto get_model_from_name() -> std::pair<std::shared_ptr<RNNModel>, bool>;
 
-        data_L.resize(0U);
-      }
-    }
+  // Builds the states for the selected model outside of the lock and swaps them in
+  void load_model(const uint& generation);
 
-    for (const auto& v : right_in) {
-      data_R.push_back(v);
+  void free_rnnoise();
 
-      if (data_R.size() == blocksize) {
-        if (state_right != nullptr) {
-          std::ranges::for_each(data_R, [](auto& v) { v *= static_cast<float>(SHRT_MAX + 1); });
+  // Moves the denoised frames to the output, zero padding its start while RNNoise is still filling the first block
+  void pop_output(std::span<float>& left_out, std::span<float>& right_out, const uint& output_rate);
 
-          data_tmp = data_R;
+  void denoise_block(DenoiseState* state,
+                     std::vector<float>& data,
+                     std::vector<float>& data_tmp,
+                     float& vad_prob,
+                     int& vad_grace);
 
-          vad_prob_right = rnnoise_process_frame(state_right, data_R.data(), data_R.data());
+  void worker_loop();
 
-          if (enable_vad) {
-            if (vad_prob_right >= vad_thres) {
-              vad_grace_right = release;
-            }
+  // remove_noise() writes either to the output fifos or to the vectors going to the output resamplers
 
-            if (vad_grace_right >= 0) {
-              --vad_grace_right;
+  static void append(RingBuffer<float>& out, const std::vector<float>& block) { out.push(block); }
 
-              for (size_t i = 0U; i < data_R.size(); i++) {
-                data_R[i] = data_R[i] * wet_ratio + data_tmp[i] * (1.0F - wet_ratio);
+  static void append(std::vector<float>& out, const std::vector<float>& block) {
+    out.insert(out.end(), block.begin(), block.end());
+  }
 
-                data_R[i] *= inv_short_max;
-              }
-            } else {
-              std::ranges::for_each(data_R, [&](auto& v) { v = 0.0F; });
-            }
-          } else {
-            for (size_t i = 0U; i < data_R.size(); i++) {
-              data_R[i] = data_R[i] * wet_ratio + data_tmp[i] * (1.0F - wet_ratio);
+  // Both are called from the main thread only
+  void start_worker();
+  void stop_worker();
 
-              data_R[i] *= inv_short_max;
-            }
-          }
-        }
+  // Denoises data_L and data_R, the right channel on the worker when it can
+  void denoise_stereo_block();
 
-        for (const auto& v : data_R) {
-          out_R.push_back(v);
-        }
+  template <typename T1, typename T2>
+  void remove_noise(const T1& left_in, const T1& right_in, T2& out_L, T2& out_R) {
+    for (size_t n = 0U; n < left_in.size(); n++) {
+      if (data_L.empty()) {
+        block_linked = linked_mono.load(std::memory_order_acquire);
+      }
 
-        data_R.resize(0U);
+      if (block_linked) {
+        data_L.push_back(0.5F * (left_in[n] + right_in[n]));
+      } else {
+        data_L.push_back(left_in[n]);
+        data_R.push_back(right_in[n]);
       }
+
+      if (data_L.size() != blocksize) {
+        continue;
+      }
+
+      if (block_linked) {
+        denoise_block(state_left, data_L, data_tmp_L, vad_prob_left, vad_grace_left);
+
+        append(out_L, data_L);
+        append(out_R, data_L);
+      } else {
+        denoise_stereo_block();
+
+        append(out_L, data_L);
+        append(out_R, data_R);
+      }
+
+      data_L.resize(0U);
+      data_R.resize(0U);
     }
   }
 
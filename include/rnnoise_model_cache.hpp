@@ -0,0 +1,65 @@
+/*
+ *  Copyright © 2017-2024 Wellington Wallace
+ *
+ *  This file is part of Easy Effects.
+ *
+ *  Easy Effects is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Easy Effects is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#ifdef ENABLE_RNNOISE
+
+#include <rnnoise.h>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+/*
+  Process wide cache of the custom RNNoise models. A model is only read-only weights after it is parsed, so every
+  RNNoise instance using the same file, in both pipelines, shares one copy. The cache holds weak references: a model
+  is freed as soon as the last instance stops using it.
+*/
+
+class RNNoiseModelCache {
+ public:
+  RNNoiseModelCache(const RNNoiseModelCache&) = delete;
+  auto operator=(const RNNoiseModelCache&) -> RNNoiseModelCache& = delete;
+  RNNoiseModelCache(const RNNoiseModelCache&&) = delete;
+  auto operator=(const RNNoiseModelCache&&) -> RNNoiseModelCache& = delete;
+
+  static auto get() -> RNNoiseModelCache&;
+
+  // Returns nullptr when the file can not be parsed. A file modified since it was cached is parsed again.
+  auto load(const std::string& path) -> std::shared_ptr<RNNModel>;
+
+ private:
+  RNNoiseModelCache() = default;
+
+  ~RNNoiseModelCache() = default;
+
+  struct Entry {
+    std::filesystem::file_time_type mtime;
+
+    std::weak_ptr<RNNModel> model;
+  };
+
+  std::mutex mutex;
+
+  std::unordered_map<std::string, Entry> models;
+};
+
+#endif
@@ -28,6 +28,7 @@
 #include <vector>
 #include "pipe_manager.hpp"
 #include "plugin_base.hpp"
+#include "ring_buffer.hpp"
 
 class Speex : public PluginBase {
  public:
@@ -53,17 +54,36 @@ class Speex : public PluginBase {
 
  private:
   bool speex_ready = false;
+  bool notify_latency = false;
 
   int enable_denoise = 0, noise_suppression = -15, enable_agc = 0, enable_vad = 0, vad_probability_start = 95,
       vad_probability_continue = 90, enable_dereverb = 0;
 
   uint latency_n_frames = 0U;
 
+  /*
+    The preprocessor always runs on frames of this duration, whatever the quantum is. This way its states only have to
+    be recreated when the sampling rate changes and the noise estimate survives quantum changes.
+  */
+
+  static constexpr float frame_duration = 0.02F;
+
+  uint frame_size = 0U;
+  uint state_rate = 0U;
+
   const float inv_short_max = 1.0F / (SHRT_MAX + 1);
 
+  std::vector<float> frame_L, frame_R;
+
   std::vector<spx_int16_t> data_L, data_R;
 
+  RingBuffer<float> input_L, input_R, output_L, output_R;
+
   SpeexPreprocessState *state_left = nullptr, *state_right = nullptr;
 
+  void init_speex();
+
   void free_speex();
+
+  void preprocess_frame(SpeexPreprocessState* state, std::vector<spx_int16_t>& data, std::vector<float>& frame);
 };
@@ -31,4 +31,6 @@ inline constexpr auto path_stream_inputs = "/com/github/wwmm/easyeffects/streami
 
 inline constexpr auto path_stream_outputs = "/com/github/wwmm/easyeffects/streamoutputs/";
 
+inline constexpr auto metrics_socket_name = "easyeffects-metrics.sock";
+
 }  // namespace tags::app
@@ -39,6 +39,8 @@ inline constexpr auto ee = "Easy Effects";
 
 inline constexpr auto lsp = "Linux Studio Plugins";
 
+inline constexpr auto lv2 = "LV2";
+
 inline constexpr auto mda = "MDA";
 
 inline constexpr auto rnnoise = "RNNoise";
@@ -87,6 +89,8 @@ inline constexpr auto filter = "filter";
 
 inline constexpr auto gate = "gate";
 
+inline constexpr auto generic_lv2 = "generic_lv2";
+
 inline constexpr auto level_meter = "level_meter";
 
 inline constexpr auto limiter = "limiter";
@@ -110,10 +114,10 @@ inline constexpr auto rnnoise = "rnnoise";
 inline constexpr auto stereo_tools = "stereo_tools";
 
 inline constexpr auto list = std::to_array(
-    {autogain,       bass_enhancer, bass_loudness, compressor,     convolver, crossfeed,   crystalizer,
-     deesser,        delay,         deepfilternet, echo_canceller, equalizer, exciter,     expander,
-     filter,         gate,          level_meter,   limiter,        loudness,  maximizer,   multiband_compressor,
-     multiband_gate, pitch,         reverb,        rnnoise,        speex,     stereo_tools});
+    {autogain,    bass_enhancer, bass_loudness,  compressor,   convolver, crossfeed,            crystalizer,    deesser,
+     delay,       deepfilternet, echo_canceller, equalizer,    exciter,   expander,             filter,         gate,
+     generic_lv2, level_meter,   limiter,        loudness,     maximizer, multiband_compressor, multiband_gate, pitch,
+     reverb,      rnnoise,       speex,          stereo_tools});
 
 auto get_translated() -> std::map<std::string, std::string>;
 
@@ -189,6 +189,16 @@ inline constexpr auto output_path = "/com/github/wwmm/easyeffects/streamoutputs/
 
 }  // namespace tags::schema::gate
 
+namespace tags::schema::generic_lv2 {
+
+inline constexpr auto id = "com.github.wwmm.easyeffects.genericlv2";
+
+inline constexpr auto input_path = "/com/github/wwmm/easyeffects/streaminputs/genericlv2/";
+
+inline constexpr auto output_path = "/com/github/wwmm/easyeffects/streamoutputs/genericlv2/";
+
+}  // namespace tags::schema::generic_lv2
+
 namespace tags::schema::level_meter {
 
 inline constexpr auto id = "com.github.wwmm.easyeffects.levelmeter";
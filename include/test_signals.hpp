@@ -24,6 +24,8 @@
 #include <pipewire/proxy.h>
 #include <spa/utils/hook.h>
 #include <sys/types.h>
+#include <condition_variable>
+#include <mutex>
 #include <random>
 #include <vector>
 #include "pipe_manager.hpp"
@@ -66,6 +68,10 @@ class TestSignals {
 
   bool can_get_node_id = false;
 
+  std::mutex state_mutex;  // guards state and can_get_node_id
+
+  std::condition_variable state_cv;
+
   float sine_phase = 0.0F;
 
   float sine_frequency = 1000.0F;
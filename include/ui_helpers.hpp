@@ -37,6 +37,7 @@
 #include <gtk/gtkswitch.h>
 #include <gtk/gtktogglebutton.h>
 #include <sys/types.h>
+#include <functional>
 #include <locale>
 #define FMT_HEADER_ONLY
 #include <fmt/core.h>
@@ -46,6 +47,8 @@
 #include "string_literal_wrapper.hpp"
 #include "util.hpp"
 
+class PluginBase;
+
 namespace ui {
 
 void show_fixed_toast(AdwToastOverlay* toast_overlay,
@@ -84,6 +87,13 @@ void update_level(GtkLevelBar* w_left,
                   const float& left,
                   const float& right);
 
+/*
+  Calls the callback once per frame clock tick while the widget is mapped and the plugin has published new meter
+  values. Hidden pages are unmapped, so they do not have a tick callback at all.
+*/
+
+void add_meters_tick_callback(GtkWidget* widget, PluginBase* plugin, std::function<void()> callback);
+
 void append_to_string_list(GtkStringList* string_list, const std::string& name);
 
 void remove_from_string_list(GtkStringList* string_list, const std::string& name);
@@ -35,6 +35,7 @@
 #include <thread>
 #include "application_ui.hpp"
 #include "config.h"
+#include "metrics_exporter.hpp"
 #include "pipe_manager.hpp"
 #include "pipe_objects.hpp"
 #include "preferences_window.hpp"
@@ -90,6 +91,7 @@ void on_startup(GApplication* gapp) {
   self->pm = new PipeManager();
   self->soe = new StreamOutputEffects(self->pm);
   self->sie = new StreamInputEffects(self->pm);
+  self->metrics_exporter = new MetricsExporter(self->pm, self->soe, self->sie);
 
   if (self->settings == nullptr) {
     self->settings = g_settings_new(tags::app::id);
@@ -448,12 +450,14 @@ void application_class_init(ApplicationClass* klass) {
 
     delete self->data;
     delete self->presets_manager;
+    delete self->metrics_exporter;
     delete self->sie;
     delete self->soe;
     delete self->pm;
 
     self->data = nullptr;
     self->presets_manager = nullptr;
+    self->metrics_exporter = nullptr;
     self->sie = nullptr;
     self->soe = nullptr;
     self->pm = nullptr;
@@ -105,54 +105,19 @@ void setup(BassEnhancerBox* self, std::shared_ptr<BassEnhancer> bass_enhancer, c
 
   bass_enhancer->set_post_messages(true);
 
-  self->data->connections.push_back(bass_enhancer->input_level.connect([=](const float left, const float right) {
-    g_object_ref(self);
-
-    util::idle_add(
-        [=]() {
-          if (get_ignore_filter_idle_add(serial)) {
-            return;
-          }
-
-          update_level(self->input_level_left, self->input_level_left_label, self->input_level_right,
-                       self->input_level_right_label, left, right);
-        },
-        [=]() { g_object_unref(self); });
-  }));
-
-  self->data->connections.push_back(bass_enhancer->output_level.connect([=](const float left, const float right) {
-    g_object_ref(self);
-
-    util::idle_add(
-        [=]() {
-          if (get_ignore_filter_idle_add(serial)) {
-            return;
-          }
-
-          update_level(self->output_level_left, self->output_level_left_label, self->output_level_right,
-                       self->output_level_right_label, left, right);
-        },
-        [=]() { g_object_unref(self); });
-  }));
-
-  self->data->connections.push_back(bass_enhancer->harmonics.connect([=](const double value) {
-    g_object_ref(self);
-
-    util::idle_add(
-        [=]() {
-          if (get_ignore_filter_idle_add(serial)) {
-            return;
-          }
-
-          if (!GTK_IS_LEVEL_BAR(self->harmonics_levelbar) || !GTK_IS_LABEL(self->harmonics_levelbar_label)) {
-            return;
-          }
-
-          gtk_level_bar_set_value(self->harmonics_levelbar, value);
-          gtk_label_set_text(self->harmonics_levelbar_label, fmt::format("{0:.0f}", util::linear_to_db(value)).c_str());
-        },
-        [=]() { g_object_unref(self); });
-  }));
+  add_meters_tick_callback(GTK_WIDGET(self), bass_enhancer.get(), [=]() {
+    update_level(self->input_level_left, self->input_level_left_label, self->input_level_right,
+                 self->input_level_right_label, bass_enhancer->input_level_left_db,
+                 bass_enhancer->input_level_right_db);
+
+    update_level(self->output_level_left, self->output_level_left_label, self->output_level_right,
+                 self->output_level_right_label, bass_enhancer->output_level_left_db,
+                 bass_enhancer->output_level_right_db);
+
+    gtk_level_bar_set_value(self->harmonics_levelbar, bass_enhancer->harmonics_port_value);
+    gtk_label_set_text(self->harmonics_levelbar_label,
+                       fmt::format("{0:.0f}", util::linear_to_db(bass_enhancer->harmonics_port_value)).c_str());
+  });
 
   gtk_label_set_text(self->plugin_credit, ui::get_plugin_credit_translated(self->data->bass_enhancer->package).c_str());
 
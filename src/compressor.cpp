@@ -54,6 +54,16 @@ Compressor::Compressor(const std::string& tag,
     util::debug(log_tag + "http://lsp-plug.in/plugins/lv2/sc_compressor_stereo is not installed");
   }
 
+  latency_port = lv2_wrapper->port_ref<"out_latency">();
+  reduction_l_port = lv2_wrapper->port_ref<"rlm_l">();
+  reduction_r_port = lv2_wrapper->port_ref<"rlm_r">();
+  sidechain_l_port = lv2_wrapper->port_ref<"slm_l">();
+  sidechain_r_port = lv2_wrapper->port_ref<"slm_r">();
+  curve_l_port = lv2_wrapper->port_ref<"clm_l">();
+  curve_r_port = lv2_wrapper->port_ref<"clm_r">();
+  envelope_l_port = lv2_wrapper->port_ref<"elm_l">();
+  envelope_r_port = lv2_wrapper->port_ref<"elm_r">();
+
   gconnections.push_back(g_signal_connect(settings, "changed::sidechain-type",
                                           G_CALLBACK(+[](GSettings* settings, const char* key, gpointer user_data) {
                                             auto* self = static_cast<Compressor*>(user_data);
@@ -172,7 +182,7 @@ void Compressor::process(std::span<float>& left_in,
    This plugin gives the latency in number of samples
  */
 
-  const auto lv = static_cast<uint>(lv2_wrapper->get_control_port_value("out_latency"));
+  const auto lv = static_cast<uint>(lv2_wrapper->get_control_port_value(latency_port));
 
   if (latency_n_frames != lv) {
     latency_n_frames = lv;
@@ -196,22 +206,17 @@ void Compressor::process(std::span<float>& left_in,
     get_peaks(left_in, right_in, left_out, right_out);
 
     if (send_notifications) {
-      reduction_port_value =
-          0.5F * (lv2_wrapper->get_control_port_value("rlm_l") + lv2_wrapper->get_control_port_value("rlm_r"));
-
-      sidechain_port_value =
-          0.5F * (lv2_wrapper->get_control_port_value("slm_l") + lv2_wrapper->get_control_port_value("slm_r"));
+      reduction_port_value = 0.5F * (lv2_wrapper->get_control_port_value(reduction_l_port) +
+                                     lv2_wrapper->get_control_port_value(reduction_r_port));
 
-      curve_port_value =
-          0.5F * (lv2_wrapper->get_control_port_value("clm_l") + lv2_wrapper->get_control_port_value("clm_r"));
+      sidechain_port_value = 0.5F * (lv2_wrapper->get_control_port_value(sidechain_l_port) +
+                                     lv2_wrapper->get_control_port_value(sidechain_r_port));
 
-      envelope_port_value =
-          0.5F * (lv2_wrapper->get_control_port_value("elm_l") + lv2_wrapper->get_control_port_value("elm_r"));
+      curve_port_value = 0.5F * (lv2_wrapper->get_control_port_value(curve_l_port) +
+                                 lv2_wrapper->get_control_port_value(curve_r_port));
 
-      reduction.emit(reduction_port_value);
-      sidechain.emit(sidechain_port_value);
-      curve.emit(curve_port_value);
-      envelope.emit(envelope_port_value);
+      envelope_port_value = 0.5F * (lv2_wrapper->get_control_port_value(envelope_l_port) +
+                                    lv2_wrapper->get_control_port_value(envelope_r_port));
 
       notify();
     }
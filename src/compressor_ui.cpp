@@ -187,107 +187,25 @@ void setup(CompressorBox* self,
     }
   }
 
-  self->data->connections.push_back(compressor->input_level.connect([=](const float left, const float right) {
-    g_object_ref(self);
-
-    util::idle_add(
-        [=]() {
-          if (get_ignore_filter_idle_add(serial)) {
-            return;
-          }
-
-          update_level(self->input_level_left, self->input_level_left_label, self->input_level_right,
-                       self->input_level_right_label, left, right);
-        },
-        [=]() { g_object_unref(self); });
-  }));
-
-  self->data->connections.push_back(compressor->output_level.connect([=](const float left, const float right) {
-    g_object_ref(self);
-
-    util::idle_add(
-        [=]() {
-          if (get_ignore_filter_idle_add(serial)) {
-            return;
-          }
-
-          update_level(self->output_level_left, self->output_level_left_label, self->output_level_right,
-                       self->output_level_right_label, left, right);
-        },
-        [=]() { g_object_unref(self); });
-  }));
-
-  self->data->connections.push_back(compressor->reduction.connect([=](const float value) {
-    g_object_ref(self);
-
-    util::idle_add(
-        [=]() {
-          if (get_ignore_filter_idle_add(serial)) {
-            return;
-          }
-
-          if (!GTK_IS_LABEL(self->gain_label)) {
-            return;
-          }
-
-          gtk_label_set_text(self->gain_label, fmt::format("{0:.0f}", util::linear_to_db(value)).c_str());
-        },
-        [=]() { g_object_unref(self); });
-  }));
+  add_meters_tick_callback(GTK_WIDGET(self), compressor.get(), [=]() {
+    update_level(self->input_level_left, self->input_level_left_label, self->input_level_right,
+                 self->input_level_right_label, compressor->input_level_left_db, compressor->input_level_right_db);
 
-  self->data->connections.push_back(compressor->envelope.connect([=](const float value) {
-    g_object_ref(self);
+    update_level(self->output_level_left, self->output_level_left_label, self->output_level_right,
+                 self->output_level_right_label, compressor->output_level_left_db, compressor->output_level_right_db);
 
-    util::idle_add(
-        [=]() {
-          if (get_ignore_filter_idle_add(serial)) {
-            return;
-          }
+    gtk_label_set_text(self->gain_label,
+                       fmt::format("{0:.0f}", util::linear_to_db(compressor->reduction_port_value)).c_str());
 
-          if (!GTK_IS_LABEL(self->envelope_label)) {
-            return;
-          }
+    gtk_label_set_text(self->envelope_label,
+                       fmt::format("{0:.0f}", util::linear_to_db(compressor->envelope_port_value)).c_str());
 
-          gtk_label_set_text(self->envelope_label, fmt::format("{0:.0f}", util::linear_to_db(value)).c_str());
-        },
-        [=]() { g_object_unref(self); });
-  }));
-
-  self->data->connections.push_back(compressor->sidechain.connect([=](const float value) {
-    g_object_ref(self);
-
-    util::idle_add(
-        [=]() {
-          if (get_ignore_filter_idle_add(serial)) {
-            return;
-          }
-
-          if (!GTK_IS_LABEL(self->sidechain_label)) {
-            return;
-          }
-
-          gtk_label_set_text(self->sidechain_label, fmt::format("{0:.0f}", util::linear_to_db(value)).c_str());
-        },
-        [=]() { g_object_unref(self); });
-  }));
-
-  self->data->connections.push_back(compressor->curve.connect([=](const float value) {
-    g_object_ref(self);
-
-    util::idle_add(
-        [=]() {
-          if (get_ignore_filter_idle_add(serial)) {
-            return;
-          }
+    gtk_label_set_text(self->sidechain_label,
+                       fmt::format("{0:.0f}", util::linear_to_db(compressor->sidechain_port_value)).c_str());
 
-          if (!GTK_IS_LABEL(self->curve_label)) {
-            return;
-          }
-
-          gtk_label_set_text(self->curve_label, fmt::format("{0:.0f}", util::linear_to_db(value)).c_str());
-        },
-        [=]() { g_object_unref(self); });
-  }));
+    gtk_label_set_text(self->curve_label,
+                       fmt::format("{0:.0f}", util::linear_to_db(compressor->curve_port_value)).c_str());
+  });
 
   self->data->connections.push_back(pm->source_added.connect([=](const NodeInfo info) {
     for (guint n = 0U; n < g_list_model_get_n_items(G_LIST_MODEL(self->input_devices_model)); n++) {
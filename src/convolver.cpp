@@ -394,11 +394,11 @@ void Convolver::read_kernel_file() {
   if (file.samplerate() != static_cast<int>(rate)) {
     util::debug(log_tag + name + " resampling the kernel to " + util::to_string(rate));
 
-    auto resampler = std::make_unique<Resampler>(file.samplerate(), rate);
+    auto resampler = std::make_unique<Resampler>(file.samplerate(), rate, ResamplerQuality::best);
 
     original_kernel_L = resampler->process(buffer_L, true);
 
-    resampler = std::make_unique<Resampler>(file.samplerate(), rate);
+    resampler = std::make_unique<Resampler>(file.samplerate(), rate, ResamplerQuality::best);
 
     original_kernel_R = resampler->process(buffer_R, true);
   } else {
@@ -139,21 +139,21 @@ void combine_kernels(ConvolverMenuCombine* self,
   if (rate1 > rate2) {
     util::debug("resampling the kernel " + kernel_2_name + " to " + util::to_string(rate1) + " Hz");
 
-    auto resampler = std::make_unique<Resampler>(rate2, rate1);
+    auto resampler = std::make_unique<Resampler>(rate2, rate1, ResamplerQuality::best);
 
     kernel_2_L = resampler->process(kernel_2_L, true);
 
-    resampler = std::make_unique<Resampler>(rate2, rate1);
+    resampler = std::make_unique<Resampler>(rate2, rate1, ResamplerQuality::best);
 
     kernel_2_R = resampler->process(kernel_2_R, true);
   } else if (rate2 > rate1) {
     util::debug("resampling the kernel " + kernel_1_name + " to " + util::to_string(rate2) + " Hz");
 
-    auto resampler = std::make_unique<Resampler>(rate1, rate2);
+    auto resampler = std::make_unique<Resampler>(rate1, rate2, ResamplerQuality::best);
 
     kernel_1_L = resampler->process(kernel_1_L, true);
 
-    resampler = std::make_unique<Resampler>(rate1, rate2);
+    resampler = std::make_unique<Resampler>(rate1, rate2, ResamplerQuality::best);
 
     kernel_1_R = resampler->process(kernel_1_R, true);
   }
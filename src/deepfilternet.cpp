@@ -18,16 +18,23 @@
  */
 
 #include "deepfilternet.hpp"
+#include <gio/gio.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/types.h>
 #include <algorithm>
+#include <atomic>
 #include <memory>
 #include <mutex>
 #include <span>
 #include <string>
+#include <thread>
 #include <vector>
 #include "ladspa_wrapper.hpp"
 #include "pipe_manager.hpp"
 #include "plugin_base.hpp"
 #include "resampler.hpp"
+#include "ring_buffer.hpp"
 #include "tags_plugin_name.hpp"
 #include "util.hpp"
 
@@ -68,7 +75,23 @@ DeepFilterNet::DeepFilterNet(const std::string& tag,
 
   ladspa_wrapper->bind_key_double<"Post Filter Beta", "post-filter-beta">(settings);
 
+  worker_hops = static_cast<uint>(g_settings_get_int(settings, "worker-hops"));
+
+  gconnections.push_back(g_signal_connect(settings, "changed::worker-hops",
+                                          G_CALLBACK(+[](GSettings* settings, char* key, gpointer user_data) {
+                                            auto* self = static_cast<DeepFilterNet*>(user_data);
+
+                                            self->worker_hops = static_cast<uint>(g_settings_get_int(settings, key));
+
+                                            if (self->initialized) {
+                                              self->setup();
+                                            }
+                                          }),
+                                          this));
+
   setup_input_output_gain();
+
+  worker = std::thread([this]() { worker_loop(); });
 }
 
 DeepFilterNet::~DeepFilterNet() {
@@ -76,6 +99,15 @@ DeepFilterNet::~DeepFilterNet() {
     disconnect_from_pw();
   }
 
+  worker_quit = true;
+
+  worker_serial.fetch_add(1U, std::memory_order_release);
+  worker_serial.notify_one();
+
+  if (worker.joinable()) {
+    worker.join();
+  }
+
   util::debug(log_tag + name + " destroyed");
 }
 
@@ -86,44 +118,124 @@ void DeepFilterNet::setup() {
     return;
   }
 
-  resample = rate != 48000;
-  resampler_ready = !resample;
+  resample = rate != native_rate;
+  buffered = resample || worker_hops != 0U;
+
+  /*
+    When worker-hops goes to 0 the worker may still be running queued hops on the same instance. The direct path waits
+    for the callback below, which switches the worker off while holding worker_mutex.
+  */
+
+  buffers_ready = !buffered && !use_worker;
 
   util::idle_add([&, this] {
     ladspa_wrapper->n_samples = n_samples;
-    std::scoped_lock<std::mutex> lock(data_mutex);
+    std::scoped_lock<std::mutex> lock(data_mutex, worker_mutex);
 
-    if (ladspa_wrapper->get_rate() != 48000) {
-      ladspa_wrapper->create_instance(48000);
+    if (ladspa_wrapper->get_rate() != native_rate) {
+      ladspa_wrapper->create_instance(native_rate);
       ladspa_wrapper->activate();
     }
 
-    if (resample && !resampler_ready) {
-      resampler_inL = std::make_unique<Resampler>(rate, 48000);
-      resampler_inR = std::make_unique<Resampler>(rate, 48000);
-      resampler_outL = std::make_unique<Resampler>(48000, rate);
-      resampler_outR = std::make_unique<Resampler>(48000, rate);
+    use_worker = worker_hops != 0U;
+
+    if (!buffered) {
+      buffers_ready = true;
+    }
+
+    uint latency_frames = 0U;
+
+    // Inside an island there are no resamplers around the model, so only the worker delay has to be covered
+
+    const auto native_prime_frames = use_worker ? hop_size * (worker_hops + 1U) : 0U;
+
+    if (buffered && !buffers_ready) {
+      auto max_native_frames = static_cast<size_t>(n_samples);
+      auto max_hop_out_frames = static_cast<size_t>(hop_size);
+
+      if (resample) {
+        resampler_inL = std::make_unique<Resampler>(rate, native_rate);
+        resampler_inR = std::make_unique<Resampler>(rate, native_rate);
+        resampler_outL = std::make_unique<Resampler>(native_rate, rate);
+        resampler_outR = std::make_unique<Resampler>(native_rate, rate);
+
+        max_native_frames = resampler_inL->get_max_output_frames(n_samples);
+        max_hop_out_frames = resampler_outL->get_max_output_frames(hop_size);
 
-      std::vector<float> dummy(n_samples);
+        latency_frames += resampler_outL->get_latency_frames() +
+                          resampler_inL->get_latency_frames() * rate / native_rate;
+      }
 
-      const auto resampled_inL = resampler_inL->process(dummy, false);
-      const auto resampled_inR = resampler_inR->process(dummy, false);
+      resampled_l.resize(max_native_frames);
+      resampled_r.resize(max_native_frames);
 
-      resampled_outL.resize(resampled_inL.size());
-      resampled_outR.resize(resampled_inR.size());
+      hop_l.resize(hop_size);
+      hop_r.resize(hop_size);
 
-      resampler_outL->process(resampled_inL, false);
-      resampler_outR->process(resampled_inR, false);
+      hop_out_l.resize(max_hop_out_frames);
+      hop_out_r.resize(max_hop_out_frames);
 
-      carryover_l.clear();
-      carryover_r.clear();
-      carryover_l.reserve(4);  // chosen by fair dice roll.
-      carryover_r.reserve(4);  // guaranteed to be random.
-      carryover_l.push_back(0.0F);
-      carryover_r.push_back(0.0F);
+      ladspa_wrapper->set_max_block_size(hop_size);
 
-      resampler_ready = true;
+      native_in_l.resize(hop_size + max_native_frames);
+      native_in_r.resize(hop_size + max_native_frames);
+
+      const auto worker_capacity = (worker_hops + 2U) * hop_size + max_native_frames;
+
+      worker_flush = false;
+      flush_pending = false;
+
+      worker_in_l.resize(use_worker ? worker_capacity : 0U);
+      worker_in_r.resize(use_worker ? worker_capacity : 0U);
+      worker_out_l.resize(use_worker ? worker_capacity : 0U);
+      worker_out_r.resize(use_worker ? worker_capacity : 0U);
+
+      worker_hop_l.resize(hop_size);
+      worker_hop_r.resize(hop_size);
+
+      /*
+        The model output comes back in whole hops. Starting the output fifo with one hop worth of silence, plus a few
+        frames for the jitter of the resamplers, keeps it from running dry between two hops. The worker needs one
+        more hop of silence for each hop it is allowed to be late.
+      */
+
+      const auto hop_out_frames = (hop_size * rate + native_rate - 1U) / native_rate;
+
+      const auto prime_frames = hop_out_frames * (use_worker ? worker_hops + 1U : 1U) + 8U;
+
+      const auto max_hops = max_native_frames / hop_size + worker_hops + 2U;
+
+      out_l.resize(prime_frames + n_samples + max_hops * max_hop_out_frames);
+      out_r.resize(prime_frames + n_samples + max_hops * max_hop_out_frames);
+
+      out_l.push_silence(prime_frames);
+      out_r.push_silence(prime_frames);
+
+      out_prime_frames = prime_frames;
+      native_out_prime_frames = native_prime_frames;
+
+      native_out_l.resize(use_worker ? native_prime_frames + max_native_frames + max_hops * hop_size : 0U);
+      native_out_r.resize(use_worker ? native_prime_frames + max_native_frames + max_hops * hop_size : 0U);
+
+      native_out_l.push_silence(native_prime_frames);
+      native_out_r.push_silence(native_prime_frames);
+
+      latency_frames += prime_frames;
+
+      buffers_ready = true;
     }
+
+    latency_value = model_latency + static_cast<float>(latency_frames) / static_cast<float>(rate);
+
+    native_latency_value = model_latency + static_cast<float>(native_prime_frames) / static_cast<float>(native_rate);
+
+    util::debug(log_tag + name + " latency: " + util::to_string(latency_value, "") + " s");
+
+    if (post_messages && !latency.empty()) {
+      latency.emit();
+    }
+
+    update_filter_params();
   });
 }
 
@@ -133,7 +245,7 @@ void DeepFilterNet::process(std::span<float>& left_in,
                             std::span<float>& right_out) {
   std::scoped_lock<std::mutex> lock(data_mutex);
 
-  if (!ladspa_wrapper->found_plugin() || !ladspa_wrapper->has_instance() || bypass) {
+  if (!ladspa_wrapper->found_plugin() || !ladspa_wrapper->has_instance() || bypass || !buffers_ready) {
     std::copy(left_in.begin(), left_in.end(), left_out.begin());
     std::copy(right_in.begin(), right_in.end(), right_out.begin());
 
@@ -144,53 +256,72 @@ void DeepFilterNet::process(std::span<float>& left_in,
     apply_gain(left_in, right_in, input_gain);
   }
 
-  if (resample) {
-    const auto& resampled_inL = resampler_inL->process(left_in, false);
-    const auto& resampled_inR = resampler_inR->process(right_in, false);
+  if (buffered) {
+    std::span<const float> native_l = left_in;
+    std::span<const float> native_r = right_in;
 
-    resampled_outL.resize(resampled_inL.size());
-    resampled_outR.resize(resampled_inR.size());
+    if (resample) {
+      const auto n_resampled = resampler_inL->process(left_in, resampled_l);
 
-    ladspa_wrapper->n_samples = resampled_inL.size();
-    ladspa_wrapper->connect_data_ports(resampled_inL, resampled_inR, resampled_outL, resampled_outR);
-  } else {
-    ladspa_wrapper->connect_data_ports(left_in, right_in, left_out, right_out);
-  }
+      resampler_inR->process(right_in, resampled_r);
+
+      native_l = std::span<const float>(resampled_l.data(), n_resampled);
+      native_r = std::span<const float>(resampled_r.data(), n_resampled);
+    }
+
+    if (use_worker && finish_worker_flush(out_l, out_r, out_prime_frames)) {
+      const auto pushed_l = worker_in_l.push(native_l);
+      const auto pushed_r = worker_in_r.push(native_r);
 
-  ladspa_wrapper->run();
+      if (pushed_l != native_l.size() || pushed_r != native_r.size()) {
+        request_worker_flush();
+      }
 
-  if (resample) {
-    const auto& outL = resampler_outL->process(resampled_outL, false);
-    const auto& outR = resampler_outR->process(resampled_outR, false);
+      worker_serial.fetch_add(1U, std::memory_order_release);
+      worker_serial.notify_one();
 
-    auto carryover_end_l = std::min(carryover_l.size(), left_out.size());
-    auto carryover_end_r = std::min(carryover_r.size(), right_out.size());
+      // Only what the worker already finished. A late hop is covered by the silence the output fifo started with.
 
-    auto left_offset =
-        carryover_end_l + outL.size() > left_out.size() ? carryover_end_l : left_out.size() - outL.size();
-    auto right_offset =
-        carryover_end_r + outR.size() > right_out.size() ? carryover_end_r : right_out.size() - outR.size();
+      while (!flush_pending && worker_out_l.size() >= hop_size && worker_out_r.size() >= hop_size) {
+        worker_out_l.pop(hop_l);
+        worker_out_r.pop(hop_r);
 
-    auto left_count = std::min(outL.size(), left_out.size() - left_offset);
-    auto right_count = std::min(outR.size(), right_out.size() - right_offset);
+        queue_hop(hop_l, hop_r);
+      }
+    } else if (!use_worker) {
+      native_in_l.push(native_l);
+      native_in_r.push(native_r);
 
-    std::copy(carryover_l.begin(), carryover_l.begin() + carryover_end_l, left_out.begin());
-    std::copy(carryover_r.begin(), carryover_r.begin() + carryover_end_r, right_out.begin());
+      // The model is only fed whole hops, whatever the quantum is
 
-    carryover_l.erase(carryover_l.begin(), carryover_l.begin() + carryover_end_l);
-    carryover_r.erase(carryover_r.begin(), carryover_r.begin() + carryover_end_r);
+      while (native_in_l.size() >= hop_size) {
+        native_in_l.pop(hop_l);
+        native_in_r.pop(hop_r);
 
-    std::fill(left_out.begin() + carryover_end_l, left_out.begin() + left_offset, 0);
-    std::fill(right_out.begin() + carryover_end_r, right_out.begin() + right_offset, 0);
+        std::span<const float> processed_l;
+        std::span<const float> processed_r;
 
-    std::copy(outL.begin(), outL.begin() + left_count, left_out.begin() + left_offset);
-    std::copy(outR.begin(), outR.begin() + right_count, right_out.begin() + right_offset);
+        ladspa_wrapper->run_buffered(hop_l, hop_r, processed_l, processed_r);
 
-    carryover_l.insert(carryover_l.end(), outL.begin() + left_count, outL.end());
-    carryover_r.insert(carryover_r.end(), outR.begin() + right_count, outR.end());
+        queue_hop(processed_l, processed_r);
+      }
+    }
+
+    // Should never be needed. It keeps the channels aligned if the fifo ever runs dry.
+
+    const auto missing = left_out.size() - std::min(out_l.size(), left_out.size());
 
-    std::fill(left_out.begin() + left_offset + left_count, left_out.end(), 0);
-    std::fill(right_out.begin() + right_offset + right_count, right_out.end(), 0);
+    std::fill_n(left_out.begin(), missing, 0.0F);
+    std::fill_n(right_out.begin(), missing, 0.0F);
+
+    out_l.pop(left_out.subspan(missing));
+    out_r.pop(right_out.subspan(missing));
+  } else {
+    ladspa_wrapper->connect_data_ports(left_in, right_in, left_out, right_out);
+
+    ladspa_wrapper->n_samples = left_in.size();
+
+    ladspa_wrapper->run();
   }
 
   if (output_gain != 1.0F) {
@@ -206,6 +337,203 @@ void DeepFilterNet::process(std::span<float>& left_in,
   }
 }
 
+void DeepFilterNet::queue_hop(const std::span<const float>& left, const std::span<const float>& right) {
+  if (!resample) {
+    out_l.push(left);
+    out_r.push(right);
+
+    return;
+  }
+
+  const auto n_out = resampler_outL->process(left, hop_out_l);
+
+  resampler_outR->process(right, hop_out_r);
+
+  out_l.push(std::span<const float>(hop_out_l.data(), n_out));
+  out_r.push(std::span<const float>(hop_out_r.data(), n_out));
+}
+
+void DeepFilterNet::request_worker_flush() {
+  /*
+    The input that did not fit is lost, so what the worker has queued no longer lines up with the output. Nothing is
+    pushed until the worker has emptied its input rings and cleared worker_flush. See finish_worker_flush().
+  */
+
+  worker_flush.store(true, std::memory_order_release);
+
+  flush_pending = true;
+
+  worker_overruns++;
+
+  util::idle_add([this, count = worker_overruns]() {
+    util::warning(log_tag + name + " the worker fell more than worker-hops behind. Overruns so far: " +
+                  util::to_string(count));
+  });
+}
+
+auto DeepFilterNet::finish_worker_flush(RingBuffer<float>& fifo_l,
+                                        RingBuffer<float>& fifo_r,
+                                        const size_t& prime_frames) -> bool {
+  if (!flush_pending) {
+    return true;
+  }
+
+  if (worker_flush.load(std::memory_order_acquire)) {
+    return false;
+  }
+
+  // The worker acknowledged, so whatever is left in its output rings was finished before the flush
+
+  while (worker_out_l.pop(hop_l) != 0U) {
+  }
+
+  while (worker_out_r.pop(hop_r) != 0U) {
+  }
+
+  fifo_l.clear();
+  fifo_r.clear();
+
+  fifo_l.push_silence(prime_frames);
+  fifo_r.push_silence(prime_frames);
+
+  flush_pending = false;
+
+  return true;
+}
+
+void DeepFilterNet::worker_loop() {
+  sched_param param{};
+
+  param.sched_priority = 1;
+
+  if (pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) != 0) {
+    util::debug(log_tag + name + " could not give realtime priority to the worker");
+  }
+
+  while (!worker_quit) {
+    const auto serial = worker_serial.load(std::memory_order_acquire);
+
+    {
+      std::scoped_lock<std::mutex> lock(worker_mutex);
+
+      while (use_worker) {
+        if (worker_flush.load(std::memory_order_acquire)) {
+          // The realtime thread does not push while the flag is set, so both rings end up empty
+
+          while (worker_in_l.pop(worker_hop_l) != 0U) {
+          }
+
+          while (worker_in_r.pop(worker_hop_r) != 0U) {
+          }
+
+          worker_flush.store(false, std::memory_order_release);
+        }
+
+        if (worker_in_l.size() < hop_size || worker_in_r.size() < hop_size) {
+          break;
+        }
+
+        worker_in_l.pop(worker_hop_l);
+        worker_in_r.pop(worker_hop_r);
+
+        std::span<const float> processed_l;
+        std::span<const float> processed_r;
+
+        ladspa_wrapper->run_buffered(worker_hop_l, worker_hop_r, processed_l, processed_r);
+
+        if (worker_flush.load(std::memory_order_acquire)) {
+          continue;  // the realtime thread already gave up on this hop
+        }
+
+        worker_out_l.push(processed_l);
+        worker_out_r.push(processed_r);
+      }
+    }
+
+    worker_serial.wait(serial, std::memory_order_acquire);
+  }
+}
+
+void DeepFilterNet::process_native(std::span<float>& left_in,
+                                   std::span<float>& right_in,
+                                   std::span<float>& left_out,
+                                   std::span<float>& right_out) {
+  std::scoped_lock<std::mutex> lock(data_mutex);
+
+  /*
+    Without the worker the model runs right here on the island buffers. The worker may still be finishing hops queued
+    before worker-hops was set to 0, and it is never waited for.
+  */
+
+  std::unique_lock<std::mutex> worker_lock(worker_mutex, std::defer_lock);
+
+  if (!use_worker) {
+    worker_lock.try_lock();
+  }
+
+  if (!ladspa_wrapper->found_plugin() || !ladspa_wrapper->has_instance() || ladspa_wrapper->get_rate() != native_rate ||
+      (use_worker ? !buffers_ready : !worker_lock.owns_lock())) {
+    std::copy(left_in.begin(), left_in.end(), left_out.begin());
+    std::copy(right_in.begin(), right_in.end(), right_out.begin());
+
+    return;
+  }
+
+  if (input_gain != 1.0F) {
+    apply_gain(left_in, right_in, input_gain);
+  }
+
+  if (use_worker) {
+    // The same hand off as in process(), minus the resamplers
+
+    if (finish_worker_flush(native_out_l, native_out_r, native_out_prime_frames)) {
+      const auto pushed_l = worker_in_l.push(left_in);
+      const auto pushed_r = worker_in_r.push(right_in);
+
+      if (pushed_l != left_in.size() || pushed_r != right_in.size()) {
+        request_worker_flush();
+      }
+
+      worker_serial.fetch_add(1U, std::memory_order_release);
+      worker_serial.notify_one();
+    }
+
+    while (!flush_pending && worker_out_l.size() >= hop_size && worker_out_r.size() >= hop_size) {
+      worker_out_l.pop(hop_l);
+      worker_out_r.pop(hop_r);
+
+      native_out_l.push(hop_l);
+      native_out_r.push(hop_r);
+    }
+
+    const auto missing = left_out.size() - std::min(native_out_l.size(), left_out.size());
+
+    std::fill_n(left_out.begin(), missing, 0.0F);
+    std::fill_n(right_out.begin(), missing, 0.0F);
+
+    native_out_l.pop(left_out.subspan(missing));
+    native_out_r.pop(right_out.subspan(missing));
+  } else {
+    ladspa_wrapper->connect_data_ports(left_in, right_in, left_out, right_out);
+
+    ladspa_wrapper->n_samples = left_in.size();
+
+    ladspa_wrapper->run();
+  }
+
+  if (output_gain != 1.0F) {
+    apply_gain(left_out, right_out, output_gain);
+  }
+
+  if (post_messages) {
+    get_peaks(left_in, right_in, left_out, right_out);
+  }
+}
+
+auto DeepFilterNet::get_native_rate() const -> uint {
+  return native_rate;
+}
+
 auto DeepFilterNet::get_latency_seconds() -> float {
-  return 0.02F + 1.0F / rate;
+  return (island_leader || island_member) ? get_island_latency_seconds() : latency_value;
 }
@@ -45,6 +45,7 @@ void DeepFilterNetPreset::save(nlohmann::json& json) {
       g_settings_get_double(settings, "max-df-processing-threshold");
   json[section][instance_name]["min-processing-buffer"] = g_settings_get_int(settings, "min-processing-buffer");
   json[section][instance_name]["post-filter-beta"] = g_settings_get_double(settings, "post-filter-beta");
+  json[section][instance_name]["worker-hops"] = g_settings_get_int(settings, "worker-hops");
 }
 
 void DeepFilterNetPreset::load(const nlohmann::json& json) {
@@ -57,4 +58,5 @@ void DeepFilterNetPreset::load(const nlohmann::json& json) {
                      "max-df-processing-threshold");
   update_key<int>(json.at(section).at(instance_name), settings, "min-processing-buffer", "min-processing-buffer");
   update_key<double>(json.at(section).at(instance_name), settings, "post-filter-beta", "post-filter-beta");
+  update_key<int>(json.at(section).at(instance_name), settings, "worker-hops", "worker-hops");
 }
@@ -66,7 +66,7 @@ struct _DeepFilterNetBox {
       *max_df_processing_thresh_label, *min_processing_buffer_label, *post_filter_beta_label;
 
   GtkSpinButton *min_processing_thresh, *max_erb_processing_thresh, *max_df_processing_thresh, *min_processing_buffer,
-      *post_filter_beta;
+      *post_filter_beta, *worker_hops;
 
   GSettings* settings;
 
@@ -95,44 +95,24 @@ void setup(DeepFilterNetBox* self, std::shared_ptr<DeepFilterNet> deepfilternet,
 
   deepfilternet->set_post_messages(true);
 
-  self->data->connections.push_back(deepfilternet->input_level.connect([=](const float left, const float right) {
-    g_object_ref(self);
+  add_meters_tick_callback(GTK_WIDGET(self), deepfilternet.get(), [=]() {
+    update_level(self->input_level_left, self->input_level_left_label, self->input_level_right,
+                 self->input_level_right_label, deepfilternet->input_level_left_db,
+                 deepfilternet->input_level_right_db);
 
-    util::idle_add(
-        [=]() {
-          if (get_ignore_filter_idle_add(serial)) {
-            return;
-          }
-
-          update_level(self->input_level_left, self->input_level_left_label, self->input_level_right,
-                       self->input_level_right_label, left, right);
-        },
-        [=]() { g_object_unref(self); });
-  }));
-
-  self->data->connections.push_back(deepfilternet->output_level.connect([=](const float left, const float right) {
-    g_object_ref(self);
-
-    util::idle_add(
-        [=]() {
-          if (get_ignore_filter_idle_add(serial)) {
-            return;
-          }
-
-          update_level(self->output_level_left, self->output_level_left_label, self->output_level_right,
-                       self->output_level_right_label, left, right);
-        },
-        [=]() { g_object_unref(self); });
-  }));
+    update_level(self->output_level_left, self->output_level_left_label, self->output_level_right,
+                 self->output_level_right_label, deepfilternet->output_level_left_db,
+                 deepfilternet->output_level_right_db);
+  });
 
   gtk_label_set_text(self->plugin_credit, ui::get_plugin_credit_translated(self->data->deepfilternet->package).c_str());
 
   gsettings_bind_widgets<"input-gain", "output-gain">(self->settings, self->input_gain, self->output_gain);
 
   gsettings_bind_widgets<"attenuation-limit", "min-processing-threshold", "max-erb-processing-threshold",
-                         "max-df-processing-threshold", "min-processing-buffer", "post-filter-beta">(
+                         "max-df-processing-threshold", "min-processing-buffer", "post-filter-beta", "worker-hops">(
       self->settings, self->att_limit, self->min_processing_thresh, self->max_erb_processing_thresh,
-      self->max_df_processing_thresh, self->min_processing_buffer, self->post_filter_beta);
+      self->max_df_processing_thresh, self->min_processing_buffer, self->post_filter_beta, self->worker_hops);
 }
 
 void dispose(GObject* object) {
@@ -195,6 +175,7 @@ void deepfilternet_box_class_init(DeepFilterNetBoxClass* klass) {
   gtk_widget_class_bind_template_child(widget_class, DeepFilterNetBox, max_df_processing_thresh);
   gtk_widget_class_bind_template_child(widget_class, DeepFilterNetBox, min_processing_buffer);
   gtk_widget_class_bind_template_child(widget_class, DeepFilterNetBox, post_filter_beta);
+  gtk_widget_class_bind_template_child(widget_class, DeepFilterNetBox, worker_hops);
 
   gtk_widget_class_bind_template_callback(widget_class, on_reset);
 }
@@ -209,6 +190,7 @@ void deepfilternet_box_init(DeepFilterNetBox* self) {
   prepare_spinbuttons<"dB">(self->max_df_processing_thresh);
   prepare_spinbuttons<"frames">(self->min_processing_buffer);
   prepare_spinbuttons<"dB">(self->post_filter_beta);
+  prepare_spinbuttons<"hops">(self->worker_hops);
 
   prepare_scales<"dB">(self->att_limit);
 
@@ -48,6 +48,9 @@ Deesser::Deesser(const std::string& tag,
     util::debug(log_tag + "http://calf.sourceforge.net/plugins/Deesser is not installed");
   }
 
+  detected_port = lv2_wrapper->port_ref<"detected">();
+  compression_port = lv2_wrapper->port_ref<"compression">();
+
   lv2_wrapper->bind_key_enum<"mode", "mode">(settings);
 
   lv2_wrapper->bind_key_enum<"detection", "detection">(settings);
@@ -123,11 +126,8 @@ void Deesser::process(std::span<float>& left_in,
     if (send_notifications) {
       // values needed as double for levelbars widget ui, so we convert them here
 
-      detected_port_value = static_cast<double>(lv2_wrapper->get_control_port_value("detected"));
-      compression_port_value = static_cast<double>(lv2_wrapper->get_control_port_value("compression"));
-
-      detected.emit(detected_port_value);
-      compression.emit(compression_port_value);
+      detected_port_value = static_cast<double>(lv2_wrapper->get_control_port_value(detected_port));
+      compression_port_value = static_cast<double>(lv2_wrapper->get_control_port_value(compression_port));
 
       notify();
     }
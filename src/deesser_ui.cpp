@@ -99,73 +99,21 @@ void setup(DeesserBox* self, std::shared_ptr<Deesser> deesser, const std::string
 
   deesser->set_post_messages(true);
 
-  self->data->connections.push_back(deesser->input_level.connect([=](const float left, const float right) {
-    g_object_ref(self);
-
-    util::idle_add(
-        [=]() {
-          if (get_ignore_filter_idle_add(serial)) {
-            return;
-          }
-
-          update_level(self->input_level_left, self->input_level_left_label, self->input_level_right,
-                       self->input_level_right_label, left, right);
-        },
-        [=]() { g_object_unref(self); });
-  }));
-
-  self->data->connections.push_back(deesser->output_level.connect([=](const float left, const float right) {
-    g_object_ref(self);
-
-    util::idle_add(
-        [=]() {
-          if (get_ignore_filter_idle_add(serial)) {
-            return;
-          }
-
-          update_level(self->output_level_left, self->output_level_left_label, self->output_level_right,
-                       self->output_level_right_label, left, right);
-        },
-        [=]() { g_object_unref(self); });
-  }));
-
-  self->data->connections.push_back(deesser->detected.connect([=](const double value) {
-    g_object_ref(self);
-
-    util::idle_add(
-        [=]() {
-          if (get_ignore_filter_idle_add(serial)) {
-            return;
-          }
-
-          if (!GTK_IS_LEVEL_BAR(self->compression) || !GTK_IS_LABEL(self->compression_label)) {
-            return;
-          }
-
-          gtk_level_bar_set_value(self->compression, 1.0 - value);
-          gtk_label_set_text(self->compression_label, fmt::format("{0:.0f}", util::linear_to_db(value)).c_str());
-        },
-        [=]() { g_object_unref(self); });
-  }));
-
-  self->data->connections.push_back(deesser->compression.connect([=](const double value) {
-    g_object_ref(self);
-
-    util::idle_add(
-        [=]() {
-          if (get_ignore_filter_idle_add(serial)) {
-            return;
-          }
-
-          if (!GTK_IS_LEVEL_BAR(self->detected) || !GTK_IS_LABEL(self->detected_label)) {
-            return;
-          }
-
-          gtk_level_bar_set_value(self->detected, value);
-          gtk_label_set_text(self->detected_label, fmt::format("{0:.0f}", util::linear_to_db(value)).c_str());
-        },
-        [=]() { g_object_unref(self); });
-  }));
+  add_meters_tick_callback(GTK_WIDGET(self), deesser.get(), [=]() {
+    update_level(self->input_level_left, self->input_level_left_label, self->input_level_right,
+                 self->input_level_right_label, deesser->input_level_left_db, deesser->input_level_right_db);
+
+    update_level(self->output_level_left, self->output_level_left_label, self->output_level_right,
+                 self->output_level_right_label, deesser->output_level_left_db, deesser->output_level_right_db);
+
+    gtk_level_bar_set_value(self->compression, 1.0 - deesser->detected_port_value);
+    gtk_label_set_text(self->compression_label,
+                       fmt::format("{0:.0f}", util::linear_to_db(deesser->detected_port_value)).c_str());
+
+    gtk_level_bar_set_value(self->detected, deesser->compression_port_value);
+    gtk_label_set_text(self->detected_label,
+                       fmt::format("{0:.0f}", util::linear_to_db(deesser->compression_port_value)).c_str());
+  });
 
   gtk_label_set_text(self->plugin_credit, ui::get_plugin_credit_translated(self->data->deesser->package).c_str());
 
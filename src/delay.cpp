@@ -49,6 +49,8 @@ Delay::Delay(const std::string& tag,
     util::debug(log_tag + "http://lsp-plug.in/plugins/lv2/comp_delay_x2_stereo is not installed");
   }
 
+  latency_port = lv2_wrapper->port_ref<"out_latency">();
+
   lv2_wrapper->set_control_port_value("mode_l", 2);
   lv2_wrapper->set_control_port_value("mode_r", 2);
 
@@ -114,7 +116,7 @@ void Delay::process(std::span<float>& left_in,
     This plugin gives the latency in number of samples
   */
 
-  const auto lv = static_cast<uint>(lv2_wrapper->get_control_port_value("out_latency"));
+  const auto lv = static_cast<uint>(lv2_wrapper->get_control_port_value(latency_port));
 
   if (latency_n_frames != lv) {
     latency_n_frames = lv;
@@ -18,6 +18,7 @@
  */
 
 #include "echo_canceller.hpp"
+#include <fftw3.h>
 #include <gio/gio.h>
 #include <glib-object.h>
 #include <glib.h>
@@ -27,10 +28,13 @@
 #include <sys/types.h>
 #include <algorithm>
 #include <climits>
+#include <cmath>
 #include <cstddef>
+#include <cstdlib>
 #include <mutex>
 #include <span>
 #include <string>
+#include <thread>
 #include "pipe_manager.hpp"
 #include "plugin_base.hpp"
 #include "tags_plugin_name.hpp"
@@ -50,7 +54,73 @@ EchoCanceller::EchoCanceller(const std::string& tag,
                  pipe_type,
                  true),
       residual_echo_suppression(g_settings_get_int(settings, "residual-echo-suppression")),
-      near_end_suppression(g_settings_get_int(settings, "near-end-suppression")) {
+      near_end_suppression(g_settings_get_int(settings, "near-end-suppression")),
+      mic_window(analysis_size, 0.0F),
+      probe_window(analysis_size, 0.0F),
+      correlation(analysis_size, 0.0F) {
+  delay_estimation = g_settings_get_boolean(settings, "delay-estimation") != 0;
+  linked_mono = g_settings_get_boolean(settings, "linked-mono") != 0;
+  enable_preprocess = g_settings_get_boolean(settings, "enable-preprocess") != 0;
+
+  /*
+    The plans are created here because the fftw planner is not thread safe. Executing them from the estimator thread
+    is fine.
+  */
+
+  mic_spectrum = fftwf_alloc_complex(analysis_size / 2U + 1U);
+  probe_spectrum = fftwf_alloc_complex(analysis_size / 2U + 1U);
+
+  mic_plan = fftwf_plan_dft_r2c_1d(static_cast<int>(analysis_size), mic_window.data(), mic_spectrum, FFTW_ESTIMATE);
+
+  probe_plan =
+      fftwf_plan_dft_r2c_1d(static_cast<int>(analysis_size), probe_window.data(), probe_spectrum, FFTW_ESTIMATE);
+
+  correlation_plan =
+      fftwf_plan_dft_c2r_1d(static_cast<int>(analysis_size), mic_spectrum, correlation.data(), FFTW_ESTIMATE);
+
+  estimator_mic.resize(analysis_size);
+  estimator_probe.resize(analysis_size);
+
+  gconnections.push_back(g_signal_connect(settings, "changed::delay-estimation",
+                                          G_CALLBACK(+[](GSettings* settings, char* key, gpointer user_data) {
+                                            auto* self = static_cast<EchoCanceller*>(user_data);
+
+                                            std::scoped_lock<std::mutex> lock(self->data_mutex);
+
+                                            self->delay_estimation = g_settings_get_boolean(settings, key) != 0;
+                                          }),
+                                          this));
+
+  gconnections.push_back(g_signal_connect(settings, "changed::linked-mono",
+                                          G_CALLBACK(+[](GSettings* settings, char* key, gpointer user_data) {
+                                            auto* self = static_cast<EchoCanceller*>(user_data);
+
+                                            std::scoped_lock<std::mutex> lock(self->data_mutex);
+
+                                            self->linked_mono = g_settings_get_boolean(settings, key) != 0;
+
+                                            // The filters adapted to a different signal
+
+                                            if (self->echo_state_L != nullptr) {
+                                              speex_echo_state_reset(self->echo_state_L);
+                                            }
+
+                                            if (self->echo_state_R != nullptr) {
+                                              speex_echo_state_reset(self->echo_state_R);
+                                            }
+                                          }),
+                                          this));
+
+  gconnections.push_back(g_signal_connect(settings, "changed::enable-preprocess",
+                                          G_CALLBACK(+[](GSettings* settings, char* key, gpointer user_data) {
+                                            auto* self = static_cast<EchoCanceller*>(user_data);
+
+                                            std::scoped_lock<std::mutex> lock(self->data_mutex);
+
+                                            self->enable_preprocess = g_settings_get_boolean(settings, key) != 0;
+                                          }),
+                                          this));
+
   gconnections.push_back(g_signal_connect(settings, "changed::filter-length",
                                           G_CALLBACK(+[](GSettings* settings, char* key, gpointer user_data) {
                                             auto* self = static_cast<EchoCanceller*>(user_data);
@@ -99,6 +169,8 @@ EchoCanceller::EchoCanceller(const std::string& tag,
       this));
 
   setup_input_output_gain();
+
+  estimator = std::thread([this]() { estimator_loop(); });
 }
 
 EchoCanceller::~EchoCanceller() {
@@ -106,6 +178,22 @@ EchoCanceller::~EchoCanceller() {
     disconnect_from_pw();
   }
 
+  estimator_quit = true;
+
+  estimator_serial.fetch_add(1U, std::memory_order_release);
+  estimator_serial.notify_one();
+
+  if (estimator.joinable()) {
+    estimator.join();
+  }
+
+  fftwf_destroy_plan(mic_plan);
+  fftwf_destroy_plan(probe_plan);
+  fftwf_destroy_plan(correlation_plan);
+
+  fftwf_free(mic_spectrum);
+  fftwf_free(probe_spectrum);
+
   data_mutex.lock();
 
   ready = false;
@@ -156,28 +244,118 @@ void EchoCanceller::process(std::span<float>& left_in,
     apply_gain(left_in, right_in, input_gain);
   }
 
+  /*
+    Part of the estimated delay is left for the echo canceller filter. Delaying the probe by more than the real echo
+    path would make the echo impossible to cancel.
+  */
+
+  uint target_delay = 0U;
+
+  if (const auto estimate = estimated_delay.load(); delay_estimation && estimate >= 0) {
+    const auto margin = static_cast<int>(delay_margin * static_cast<float>(rate));
+
+    target_delay = static_cast<uint>(std::max(estimate * static_cast<int>(decimation) - margin, 0));
+
+    target_delay = std::min(target_delay, static_cast<uint>(delay_line.size() - n_samples));
+  }
+
+  /*
+    Consecutive estimates differ by a decimated frame or two. Resetting the echo states for that would throw away what
+    the filter learned every few hundred milliseconds, so only changes larger than delay_hysteresis are applied.
+  */
+
+  const auto hysteresis = static_cast<uint>(delay_hysteresis * static_cast<float>(rate));
+
+  const auto change = (target_delay > applied_delay) ? target_delay - applied_delay : applied_delay - target_delay;
+
+  if (change != 0U && (change > hysteresis || !delay_estimation)) {
+    applied_delay = target_delay;
+
+    speex_echo_state_reset(echo_state_L);
+    speex_echo_state_reset(echo_state_R);
+  }
+
+  size_t n_decimated = 0U;
+
   for (size_t j = 0U; j < left_in.size(); j++) {
-    data_L[j] = static_cast<spx_int16_t>(left_in[j] * (SHRT_MAX + 1));
-    data_R[j] = static_cast<spx_int16_t>(right_in[j] * (SHRT_MAX + 1));
+    if (linked_mono) {
+      data_L[j] = static_cast<spx_int16_t>(0.5F * (left_in[j] + right_in[j]) * (SHRT_MAX + 1));
+    } else {
+      data_L[j] = static_cast<spx_int16_t>(left_in[j] * (SHRT_MAX + 1));
+      data_R[j] = static_cast<spx_int16_t>(right_in[j] * (SHRT_MAX + 1));
+    }
 
     /*
       This is a very naive and not corect attempt to mitigate the shortcomes discussed at
       https://github.com/wwmm/easyeffects/issues/1566.
     */
 
-    probe_mono[j] = static_cast<spx_int16_t>(0.5F * (probe_left[j] + probe_right[j]) * (SHRT_MAX + 1));
+    const float probe = 0.5F * (probe_left[j] + probe_right[j]);
+
+    delay_line[delay_line_pos] = probe;
+
+    const auto delayed = delay_line[(delay_line_pos + delay_line.size() - applied_delay) % delay_line.size()];
+
+    delay_line_pos = (delay_line_pos + 1U) % delay_line.size();
+
+    probe_mono[j] = static_cast<spx_int16_t>(delayed * (SHRT_MAX + 1));
+
+    if (!delay_estimation) {
+      continue;
+    }
+
+    // A box filter is enough to keep the speech band before decimating
+
+    mic_sum += 0.5F * (left_in[j] + right_in[j]);
+    probe_sum += probe;
+
+    if (++decimation_count == decimation) {
+      mic_decimated[n_decimated] = mic_sum / static_cast<float>(decimation);
+      probe_decimated[n_decimated] = probe_sum / static_cast<float>(decimation);
+
+      n_decimated++;
+
+      decimation_count = 0U;
+      mic_sum = 0.0F;
+      probe_sum = 0.0F;
+    }
   }
 
+  // Nothing is pushed until the estimator has emptied both rings, otherwise mic and probe would end up offset
+
+  if (n_decimated > 0U && !estimator_reset.load(std::memory_order_acquire)) {
+    estimator_mic.push(std::span<const float>(mic_decimated.data(), n_decimated));
+    estimator_probe.push(std::span<const float>(probe_decimated.data(), n_decimated));
+
+    estimator_serial.fetch_add(1U, std::memory_order_release);
+    estimator_serial.notify_one();
+  }
+
+  /*
+    In linked mode the mid signal goes through a single echo canceller and preprocessor and both outputs get the
+    result. The right channel states are left untouched.
+  */
+
   speex_echo_cancellation(echo_state_L, data_L.data(), probe_mono.data(), filtered_L.data());
-  speex_echo_cancellation(echo_state_R, data_R.data(), probe_mono.data(), filtered_R.data());
 
-  speex_preprocess_run(state_left, filtered_L.data());
-  speex_preprocess_run(state_right, filtered_R.data());
+  if (!linked_mono) {
+    speex_echo_cancellation(echo_state_R, data_R.data(), probe_mono.data(), filtered_R.data());
+  }
+
+  if (enable_preprocess) {
+    speex_preprocess_run(state_left, filtered_L.data());
+
+    if (!linked_mono) {
+      speex_preprocess_run(state_right, filtered_R.data());
+    }
+  }
+
+  const auto& filtered_right = (linked_mono) ? filtered_L : filtered_R;
 
   for (size_t j = 0U; j < filtered_L.size(); j++) {
     left_out[j] = static_cast<float>(filtered_L[j]) * inv_short_max;
 
-    right_out[j] = static_cast<float>(filtered_R[j]) * inv_short_max;
+    right_out[j] = static_cast<float>(filtered_right[j]) * inv_short_max;
   }
 
   if (output_gain != 1.0F) {
@@ -222,6 +400,27 @@ void EchoCanceller::init_speex() {
   filtered_L.resize(n_samples);
   filtered_R.resize(n_samples);
 
+  decimation = std::max(rate / analysis_rate, 1U);
+  decimation_count = 0U;
+  mic_sum = 0.0F;
+  probe_sum = 0.0F;
+
+  mic_decimated.resize(n_samples / decimation + 1U);
+  probe_decimated.resize(n_samples / decimation + 1U);
+
+  delay_line.assign(static_cast<size_t>(max_lag * decimation) + n_samples, 0.0F);
+  delay_line_pos = 0U;
+  applied_delay = 0U;
+
+  // The previous estimate was made at another decimation factor. The estimator drops its windows too.
+
+  estimated_delay = -1;
+
+  estimator_reset.store(true, std::memory_order_release);
+
+  estimator_serial.fetch_add(1U, std::memory_order_release);
+  estimator_serial.notify_one();
+
   const uint filter_length = static_cast<uint>(0.001F * static_cast<float>(filter_length_ms * rate));
 
   util::debug(log_tag + name + " filter length: " + util::to_string(filter_length));
@@ -289,6 +488,104 @@ void EchoCanceller::free_speex() {
   state_right = nullptr;
 }
 
+void EchoCanceller::estimator_loop() {
+  while (!estimator_quit) {
+    const auto serial = estimator_serial.load(std::memory_order_acquire);
+
+    if (estimator_reset.load(std::memory_order_acquire)) {
+      while (estimator_mic.pop(mic_window) != 0U) {
+      }
+
+      while (estimator_probe.pop(probe_window) != 0U) {
+      }
+
+      std::ranges::fill(mic_window, 0.0F);
+      std::ranges::fill(probe_window, 0.0F);
+
+      last_lag = -1;
+
+      estimator_reset.store(false, std::memory_order_release);  // lets process() push again
+    }
+
+    while (estimator_mic.size() >= analysis_hop && estimator_probe.size() >= analysis_hop) {
+      std::copy(mic_window.begin() + analysis_hop, mic_window.end(), mic_window.begin());
+      std::copy(probe_window.begin() + analysis_hop, probe_window.end(), probe_window.begin());
+
+      estimator_mic.pop(std::span<float>(mic_window.end() - analysis_hop, mic_window.end()));
+      estimator_probe.pop(std::span<float>(probe_window.end() - analysis_hop, probe_window.end()));
+
+      estimate_delay();
+    }
+
+    estimator_serial.wait(serial, std::memory_order_acquire);
+  }
+}
+
+void EchoCanceller::estimate_delay() {
+  // There is nothing to correlate while nothing is being played or captured
+
+  float mic_energy = 0.0F;
+  float probe_energy = 0.0F;
+
+  for (uint n = 0U; n < analysis_size; n++) {
+    mic_energy += mic_window[n] * mic_window[n];
+    probe_energy += probe_window[n] * probe_window[n];
+  }
+
+  if (mic_energy < 1e-6F || probe_energy < 1e-6F) {
+    return;
+  }
+
+  fftwf_execute(mic_plan);
+  fftwf_execute(probe_plan);
+
+  /*
+    GCC-PHAT: the cross spectrum is whitened so that the correlation peak does not depend on the spectral content of
+    the signals. The result is written over the microphone spectrum that is the input of the inverse transform.
+  */
+
+  for (uint k = 0U; k < analysis_size / 2U + 1U; k++) {
+    const float re = mic_spectrum[k][0] * probe_spectrum[k][0] + mic_spectrum[k][1] * probe_spectrum[k][1];
+    const float im = mic_spectrum[k][1] * probe_spectrum[k][0] - mic_spectrum[k][0] * probe_spectrum[k][1];
+
+    const float magnitude = std::sqrt(re * re + im * im);
+
+    mic_spectrum[k][0] = (magnitude > 1e-12F) ? re / magnitude : 0.0F;
+    mic_spectrum[k][1] = (magnitude > 1e-12F) ? im / magnitude : 0.0F;
+  }
+
+  fftwf_execute(correlation_plan);
+
+  // The echo can only arrive after the probe, so only the positive lags are searched
+
+  int lag = 0;
+  float peak = 0.0F;
+  float mean = 0.0F;
+
+  for (uint n = 0U; n < max_lag; n++) {
+    mean += std::fabs(correlation[n]);
+
+    if (correlation[n] > peak) {
+      peak = correlation[n];
+      lag = static_cast<int>(n);
+    }
+  }
+
+  mean /= static_cast<float>(max_lag);
+
+  if (peak < 10.0F * mean) {
+    return;
+  }
+
+  // Only estimates that are confirmed by the next analysis window are used. Nothing is published across a rate change.
+
+  if (last_lag >= 0 && std::abs(lag - last_lag) <= 2 && !estimator_reset.load(std::memory_order_acquire)) {
+    estimated_delay = std::min(lag, last_lag);
+  }
+
+  last_lag = lag;
+}
+
 auto EchoCanceller::get_latency_seconds() -> float {
   return latency_value;
 }
@@ -44,6 +44,12 @@ void EchoCancellerPreset::save(nlohmann::json& json) {
 
   json[section][instance_name]["filter-length"] = g_settings_get_int(settings, "filter-length");
 
+  json[section][instance_name]["delay-estimation"] = g_settings_get_boolean(settings, "delay-estimation") != 0;
+
+  json[section][instance_name]["linked-mono"] = g_settings_get_boolean(settings, "linked-mono") != 0;
+
+  json[section][instance_name]["enable-preprocess"] = g_settings_get_boolean(settings, "enable-preprocess") != 0;
+
   json[section][instance_name]["residual-echo-suppression"] = g_settings_get_int(settings, "residual-echo-suppression");
 
   json[section][instance_name]["near-end-suppression"] = g_settings_get_int(settings, "near-end-suppression");
@@ -58,6 +64,12 @@ void EchoCancellerPreset::load(const nlohmann::json& json) {
 
   update_key<int>(json.at(section).at(instance_name), settings, "filter-length", "filter-length");
 
+  update_key<bool>(json.at(section).at(instance_name), settings, "delay-estimation", "delay-estimation");
+
+  update_key<bool>(json.at(section).at(instance_name), settings, "linked-mono", "linked-mono");
+
+  update_key<bool>(json.at(section).at(instance_name), settings, "enable-preprocess", "enable-preprocess");
+
   update_key<int>(json.at(section).at(instance_name), settings, "residual-echo-suppression",
                   "residual-echo-suppression");
 
@@ -62,6 +62,8 @@ struct _EchoCancellerBox {
 
   GtkSpinButton *filter_length, *residual_echo_suppression, *near_end_suppression;
 
+  GtkSwitch *delay_estimation, *linked_mono, *enable_preprocess;
+
   GSettings* settings;
 
   Data* data;
@@ -89,43 +91,23 @@ void setup(EchoCancellerBox* self, std::shared_ptr<EchoCanceller> echo_canceller
 
   echo_canceller->set_post_messages(true);
 
-  self->data->connections.push_back(echo_canceller->input_level.connect([=](const float left, const float right) {
-    g_object_ref(self);
-
-    util::idle_add(
-        [=]() {
-          if (get_ignore_filter_idle_add(serial)) {
-            return;
-          }
-
-          update_level(self->input_level_left, self->input_level_left_label, self->input_level_right,
-                       self->input_level_right_label, left, right);
-        },
-        [=]() { g_object_unref(self); });
-  }));
-
-  self->data->connections.push_back(echo_canceller->output_level.connect([=](const float left, const float right) {
-    g_object_ref(self);
-
-    util::idle_add(
-        [=]() {
-          if (get_ignore_filter_idle_add(serial)) {
-            return;
-          }
+  add_meters_tick_callback(GTK_WIDGET(self), echo_canceller.get(), [=]() {
+    update_level(self->input_level_left, self->input_level_left_label, self->input_level_right,
+                 self->input_level_right_label, echo_canceller->input_level_left_db,
+                 echo_canceller->input_level_right_db);
 
-          update_level(self->output_level_left, self->output_level_left_label, self->output_level_right,
-                       self->output_level_right_label, left, right);
-        },
-        [=]() { g_object_unref(self); });
-  }));
+    update_level(self->output_level_left, self->output_level_left_label, self->output_level_right,
+                 self->output_level_right_label, echo_canceller->output_level_left_db,
+                 echo_canceller->output_level_right_db);
+  });
 
   gtk_label_set_text(self->plugin_credit,
                      ui::get_plugin_credit_translated(self->data->echo_canceller->package).c_str());
 
-  gsettings_bind_widgets<"input-gain", "output-gain", "filter-length", "residual-echo-suppression",
-                         "near-end-suppression">(self->settings, self->input_gain, self->output_gain,
-                                                 self->filter_length, self->residual_echo_suppression,
-                                                 self->near_end_suppression);
+  gsettings_bind_widgets<"input-gain", "output-gain", "filter-length", "delay-estimation", "linked-mono",
+                         "enable-preprocess", "residual-echo-suppression", "near-end-suppression">(
+      self->settings, self->input_gain, self->output_gain, self->filter_length, self->delay_estimation,
+      self->linked_mono, self->enable_preprocess, self->residual_echo_suppression, self->near_end_suppression);
 }
 
 void dispose(GObject* object) {
@@ -183,6 +165,9 @@ void echo_canceller_box_class_init(EchoCancellerBoxClass* klass) {
   gtk_widget_class_bind_template_child(widget_class, EchoCancellerBox, plugin_credit);
 
   gtk_widget_class_bind_template_child(widget_class, EchoCancellerBox, filter_length);
+  gtk_widget_class_bind_template_child(widget_class, EchoCancellerBox, delay_estimation);
+  gtk_widget_class_bind_template_child(widget_class, EchoCancellerBox, linked_mono);
+  gtk_widget_class_bind_template_child(widget_class, EchoCancellerBox, enable_preprocess);
   gtk_widget_class_bind_template_child(widget_class, EchoCancellerBox, residual_echo_suppression);
   gtk_widget_class_bind_template_child(widget_class, EchoCancellerBox, near_end_suppression);
 
@@ -22,11 +22,13 @@
 #include <glib-object.h>
 #include <glib.h>
 #include <algorithm>
+#include <deque>
 #include <map>
 #include <memory>
 #include <ranges>
 #include <string>
 #include <utility>
+#include <vector>
 #include "autogain.hpp"
 #include "bass_enhancer.hpp"
 #include "bass_loudness.hpp"
@@ -43,6 +45,7 @@
 #include "expander.hpp"
 #include "filter.hpp"
 #include "gate.hpp"
+#include "generic_lv2.hpp"
 #include "level_meter.hpp"
 #include "limiter.hpp"
 #include "loudness.hpp"
@@ -165,6 +168,16 @@ void EffectsBase::reset_settings() {
   }
 }
 
+void EffectsBase::set_export_metrics(const bool& state) {
+  export_metrics = state;
+
+  output_level->set_export_metrics(state);
+
+  for (auto& plugin : plugins | std::views::values) {
+    plugin->set_export_metrics(state);
+  }
+}
+
 void EffectsBase::create_filters_if_necessary() {
   const auto list = util::gchar_array_to_vector(g_settings_get_strv(settings, "plugins"));
 
@@ -177,6 +190,24 @@ void EffectsBase::create_filters_if_necessary() {
       continue;
     }
 
+    if (auto it = std::ranges::find(plugins_pool, name, &PooledPlugin::first); it != plugins_pool.end()) {
+      auto filter = it->second;
+
+      plugins_pool.erase(it);
+
+      util::debug(log_tag + "reusing the pooled " + name + " filter");
+
+      connections.push_back(filter->latency.connect([this]() { broadcast_pipeline_latency(); }));
+
+      if (export_metrics) {
+        filter->set_export_metrics(true);
+      }
+
+      plugins.insert(std::make_pair(name, filter));
+
+      continue;
+    }
+
     auto instance_id = util::to_string(tags::plugin_name::get_id(name));
 
     auto path = schema_base_path + tags::plugin_name::get_base_name(name) + "/" + instance_id + "/";
@@ -220,6 +251,8 @@ void EffectsBase::create_filters_if_necessary() {
       filter = std::make_shared<Filter>(log_tag, tags::schema::filter::id, path, pm, pipeline_type);
     } else if (name.starts_with(tags::plugin_name::gate)) {
       filter = std::make_shared<Gate>(log_tag, tags::schema::gate::id, path, pm, pipeline_type);
+    } else if (name.starts_with(tags::plugin_name::generic_lv2)) {
+      filter = std::make_shared<GenericLv2>(log_tag, tags::schema::generic_lv2::id, path, pm, pipeline_type);
     } else if (name.starts_with(tags::plugin_name::level_meter)) {
       filter = std::make_shared<LevelMeter>(log_tag, tags::schema::level_meter::id, path, pm, pipeline_type);
     } else if (name.starts_with(tags::plugin_name::limiter)) {
@@ -247,38 +280,209 @@ void EffectsBase::create_filters_if_necessary() {
 
     connections.push_back(filter->latency.connect([this]() { broadcast_pipeline_latency(); }));
 
+    if (export_metrics) {
+      filter->set_export_metrics(true);
+    }
+
     plugins.insert(std::make_pair(name, filter));
   }
 }
 
-void EffectsBase::remove_unused_filters() {
-  const auto list = util::gchar_array_to_vector(g_settings_get_strv(settings, "plugins"));
+void EffectsBase::connect_plugins_to_pw(const std::vector<std::string>& list) {
+  std::vector<std::shared_ptr<PluginBase>> pending;
 
-  if (list.empty()) {
-    plugins.clear();
+  for (const auto& name : list) {
+    if (!plugins.contains(name) || plugins[name]->connected_to_pw) {
+      continue;
+    }
+
+    if (plugins[name]->request_pw_connection()) {
+      pending.push_back(plugins[name]);
+    }
+  }
+
+  for (auto& plugin : pending) {
+    plugin->wait_pw_connection();
+  }
+}
+
+void EffectsBase::disconnect_unused_plugins(const std::vector<std::string>& list) {
+  for (const auto& [name, plugin] : plugins) {
+    if (plugin->connected_to_pw && std::ranges::find(list, name) == list.end()) {
+      util::debug(log_tag + "disconnecting the " + name + " filter from PipeWire");
+
+      plugin->disconnect_from_pw();
+    }
+  }
+}
+
+void EffectsBase::link_chain(const std::vector<uint>& chain, const bool& allow_mono_source) {
+  std::map<std::pair<uint, uint>, std::vector<pw_proxy*>> new_links;
+
+  if (chain.empty()) {
+    unlink_chain();
 
     return;
   }
 
+  auto prev_node_id = chain.front();
+
+  for (const auto& next_node_id : chain | std::views::drop(1)) {
+    const auto edge = std::make_pair(prev_node_id, next_node_id);
+
+    /*
+      Links from the previous chain are reused as long as PipeWire still has them. A node that went away and came back
+      with the same id has to be linked again.
+    */
+
+    if (auto it = chain_links.find(edge); it != chain_links.end()) {
+      const auto alive = std::ranges::any_of(pm->get_node_links(prev_node_id), [&](const auto& link) {
+        return link.output_node_id == prev_node_id && link.input_node_id == next_node_id;
+      });
+
+      if (alive) {
+        new_links.insert(chain_links.extract(it));
+
+        prev_node_id = next_node_id;
+
+        continue;
+      }
+    }
+
+    auto links = pm->link_nodes(prev_node_id, next_node_id);
+
+    const auto min_links = (allow_mono_source && prev_node_id == chain.front()) ? 1U : 2U;
+
+    if (links.size() >= min_links) {
+      new_links[edge] = std::move(links);
+
+      prev_node_id = next_node_id;
+    } else {
+      pm->destroy_links(links);
+
+      util::warning(log_tag + "link from node " + util::to_string(prev_node_id) + " to node " +
+                    util::to_string(next_node_id) + " failed");
+    }
+  }
+
+  // Everything left in chain_links is not part of the new chain
+
+  unlink_chain();
+
+  chain_links = std::move(new_links);
+}
+
+void EffectsBase::unlink_chain() {
+  for (const auto& links : chain_links | std::views::values) {
+    pm->destroy_links(links);
+  }
+
+  chain_links.clear();
+}
+
+void EffectsBase::update_islands(const std::vector<std::string>& list) {
+  for (auto& plugin : plugins | std::views::values) {
+    plugin->island_member = false;
+  }
+
+  std::vector<std::shared_ptr<PluginBase>> run;
+
+  const auto close_run = [&]() {
+    if (run.empty()) {
+      return;
+    }
+
+    auto leader = run.front();
+
+    const std::vector<std::shared_ptr<PluginBase>> members(run.begin() + 1, run.end());
+
+    for (auto& member : members) {
+      member->set_island({});
+
+      member->island_member = true;
+    }
+
+    leader->set_island(members);
+
+    if (!members.empty()) {
+      util::debug(log_tag + leader->name + " leads an island of " + util::to_string(run.size()) + " plugins at " +
+                  util::to_string(leader->get_native_rate()) + " Hz");
+    }
+
+    run.clear();
+  };
+
+  for (const auto& name : list) {
+    if (!plugins.contains(name) || !plugins[name]->connected_to_pw) {
+      continue;
+    }
+
+    auto plugin = plugins[name];
+
+    const auto native_rate = plugin->get_native_rate();
+
+    if (native_rate == 0U || (!run.empty() && run.front()->get_native_rate() != native_rate)) {
+      close_run();
+    }
+
+    if (native_rate == 0U) {
+      plugin->set_island({});
+    } else {
+      run.push_back(plugin);
+    }
+  }
+
+  close_run();
+
+  for (const auto& [name, plugin] : plugins) {
+    if (std::ranges::find(list, name) == list.end()) {
+      plugin->set_island({});
+    }
+  }
+
+  // The island resamplers moved, so the plugins that can join one report a different latency now
+
+  for (auto& plugin : plugins | std::views::values) {
+    if (plugin->connected_to_pw && plugin->get_native_rate() != 0U) {
+      plugin->update_filter_params();
+    }
+  }
+
+  broadcast_pipeline_latency();
+}
+
+void EffectsBase::remove_unused_filters() {
+  const auto list = util::gchar_array_to_vector(g_settings_get_strv(settings, "plugins"));
+
   for (auto it = plugins.begin(); it != plugins.end();) {
     auto key = it->first;
 
     if (std::ranges::find(list, key) == list.end()) {
       auto plugin = it->second;
 
-      plugin->bypass = true;
       plugin->set_post_messages(false);
+      plugin->set_export_metrics(false);
       plugin->latency.clear();
+      plugin->set_island({});
+      plugin->island_member = false;
 
       if (plugin->connected_to_pw) {
         plugin->disconnect_from_pw();
       }
 
+      plugins_pool.emplace_back(key, plugin);
+
       it = plugins.erase(it);
     } else {
       it++;
     }
   }
+
+  while (plugins_pool.size() > max_pooled_plugins) {
+    util::debug(log_tag + "destroying the pooled " + plugins_pool.front().first + " filter");
+
+    plugins_pool.pop_front();
+  }
 }
 
 void EffectsBase::activate_filters() {
@@ -68,7 +68,7 @@ struct Data {
 
   uint spectrum_rate, spectrum_n_bands;
 
-  float global_output_level_left, global_output_level_right, pipeline_latency_ms;
+  float pipeline_latency_ms;
 
   std::vector<double> spectrum_mag, spectrum_x_axis, spectrum_freqs;
 
@@ -413,37 +413,20 @@ void setup(EffectsBox* self, app::Application* application, PipelineType pipelin
 
   // output level
 
-  self->data->connections.push_back(
-      self->data->effects_base->output_level->output_level.connect([=](const float left, const float right) {
-        self->data->global_output_level_left = left;
-        self->data->global_output_level_right = right;
-
-        if (!schedule_signal_idle) {
-          return;
-        }
-
-        g_idle_add((GSourceFunc) +
-                       [](EffectsBox* self) {
-                         if (!schedule_signal_idle) {
-                           return G_SOURCE_REMOVE;
-                         }
+  ui::add_meters_tick_callback(GTK_WIDGET(self), self->data->effects_base->output_level.get(), [=]() {
+    if (!schedule_signal_idle) {
+      return;
+    }
 
-                         gtk_label_set_text(self->label_global_output_level_left,
-                                            fmt::format("{0:.0f}", self->data->global_output_level_left).c_str());
+    const float left = self->data->effects_base->output_level->output_level_left_db;
+    const float right = self->data->effects_base->output_level->output_level_right_db;
 
-                         gtk_label_set_text(self->label_global_output_level_right,
-                                            fmt::format("{0:.0f}", self->data->global_output_level_right).c_str());
+    gtk_label_set_text(self->label_global_output_level_left, fmt::format("{0:.0f}", left).c_str());
 
-                         gtk_widget_set_opacity(
-                             GTK_WIDGET(self->saturation_icon),
-                             (self->data->global_output_level_left > 0.0 || self->data->global_output_level_right > 0.0)
-                                 ? 1.0
-                                 : 0.0);
+    gtk_label_set_text(self->label_global_output_level_right, fmt::format("{0:.0f}", right).c_str());
 
-                         return G_SOURCE_REMOVE;
-                       },
-                   self);
-      }));
+    gtk_widget_set_opacity(GTK_WIDGET(self->saturation_icon), (left > 0.0F || right > 0.0F) ? 1.0 : 0.0);
+  });
 
   // spectrum array
 
@@ -63,6 +63,8 @@ Equalizer::Equalizer(const std::string& tag,
     util::debug(log_tag + "http://lsp-plug.in/plugins/lv2/para_equalizer_x32_lr is not installed");
   }
 
+  latency_port = lv2_wrapper->port_ref<"out_latency">();
+
   lv2_wrapper->bind_key_enum<"mode", "mode">(settings);
 
   lv2_wrapper->bind_key_double<"bal", "balance">(settings);
@@ -264,7 +266,7 @@ void Equalizer::process(std::span<float>& left_in,
     This plugin gives the latency in number of samples
   */
 
-  const auto lv = static_cast<uint>(lv2_wrapper->get_control_port_value("out_latency"));
+  const auto lv = static_cast<uint>(lv2_wrapper->get_control_port_value(latency_port));
 
   if (latency_n_frames != lv) {
     latency_n_frames = lv;
@@ -48,6 +48,8 @@ Exciter::Exciter(const std::string& tag,
     util::debug(log_tag + "http://calf.sourceforge.net/plugins/Exciter is not installed");
   }
 
+  harmonics_port = lv2_wrapper->port_ref<"meter_drive">();
+
   lv2_wrapper->bind_key_double_db<"amount", "amount">(settings);
 
   lv2_wrapper->bind_key_double<"drive", "harmonics">(settings);
@@ -113,14 +115,12 @@ void Exciter::process(std::span<float>& left_in,
     if (send_notifications) {
       /// harmonics needed as double for levelbar widget ui, so we convert it here
 
-      harmonics_port_value = static_cast<double>(lv2_wrapper->get_control_port_value("meter_drive"));
+      harmonics_port_value = static_cast<double>(lv2_wrapper->get_control_port_value(harmonics_port));
 
       if (!post_messages) {
         return;
       }
 
-      harmonics.emit(harmonics_port_value);
-
       notify();
     }
   }
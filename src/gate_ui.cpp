@@ -162,183 +162,40 @@ void setup(GateBox* self, std::shared_ptr<Gate> gate, const std::string& schema_
     }
   }
 
-  self->data->connections.push_back(gate->input_level.connect([=](const float left, const float right) {
-    g_object_ref(self);
-
-    util::idle_add(
-        [=]() {
-          if (get_ignore_filter_idle_add(serial)) {
-            return;
-          }
-
-          update_level(self->input_level_left, self->input_level_left_label, self->input_level_right,
-                       self->input_level_right_label, left, right);
-        },
-        [=]() { g_object_unref(self); });
-  }));
-
-  self->data->connections.push_back(gate->output_level.connect([=](const float left, const float right) {
-    g_object_ref(self);
-
-    util::idle_add(
-        [=]() {
-          if (get_ignore_filter_idle_add(serial)) {
-            return;
-          }
-
-          update_level(self->output_level_left, self->output_level_left_label, self->output_level_right,
-                       self->output_level_right_label, left, right);
-        },
-        [=]() { g_object_unref(self); });
-  }));
-
-  self->data->connections.push_back(gate->attack_zone_start.connect([=](const float value) {
-    g_object_ref(self);
-
-    util::idle_add(
-        [=]() {
-          if (get_ignore_filter_idle_add(serial)) {
-            return;
-          }
-
-          if (!GTK_IS_LABEL(self->attack_zone_start_label)) {
-            return;
-          }
-
-          gtk_label_set_text(self->attack_zone_start_label,
-                             fmt::format(ui::get_user_locale(), "{0:.1Lf}", util::linear_to_db(value)).c_str());
-        },
-        [=]() { g_object_unref(self); });
-  }));
-
-  self->data->connections.push_back(gate->attack_threshold.connect([=](const float value) {
-    g_object_ref(self);
-
-    util::idle_add(
-        [=]() {
-          if (get_ignore_filter_idle_add(serial)) {
-            return;
-          }
-
-          if (!GTK_IS_LABEL(self->attack_threshold_label)) {
-            return;
-          }
-
-          gtk_label_set_text(self->attack_threshold_label,
-                             fmt::format(ui::get_user_locale(), "{0:.1Lf}", util::linear_to_db(value)).c_str());
-        },
-        [=]() { g_object_unref(self); });
-  }));
-
-  self->data->connections.push_back(gate->release_zone_start.connect([=](const float value) {
-    g_object_ref(self);
-
-    util::idle_add(
-        [=]() {
-          if (get_ignore_filter_idle_add(serial)) {
-            return;
-          }
-
-          if (!GTK_IS_LABEL(self->release_zone_start_label)) {
-            return;
-          }
+  add_meters_tick_callback(GTK_WIDGET(self), gate.get(), [=]() {
+    update_level(self->input_level_left, self->input_level_left_label, self->input_level_right,
+                 self->input_level_right_label, gate->input_level_left_db, gate->input_level_right_db);
 
-          gtk_label_set_text(self->release_zone_start_label,
-                             fmt::format(ui::get_user_locale(), "{0:.1Lf}", util::linear_to_db(value)).c_str());
-        },
-        [=]() { g_object_unref(self); });
-  }));
-
-  self->data->connections.push_back(gate->release_threshold.connect([=](const float value) {
-    g_object_ref(self);
-
-    util::idle_add(
-        [=]() {
-          if (get_ignore_filter_idle_add(serial)) {
-            return;
-          }
-
-          if (!GTK_IS_LABEL(self->release_threshold_label)) {
-            return;
-          }
-
-          gtk_label_set_text(self->release_threshold_label,
-                             fmt::format(ui::get_user_locale(), "{0:.1Lf}", util::linear_to_db(value)).c_str());
-        },
-        [=]() { g_object_unref(self); });
-  }));
-
-  self->data->connections.push_back(gate->reduction.connect([=](const float value) {
-    g_object_ref(self);
-
-    util::idle_add(
-        [=]() {
-          if (get_ignore_filter_idle_add(serial)) {
-            return;
-          }
-
-          if (!GTK_IS_LABEL(self->gain_label)) {
-            return;
-          }
+    update_level(self->output_level_left, self->output_level_left_label, self->output_level_right,
+                 self->output_level_right_label, gate->output_level_left_db, gate->output_level_right_db);
 
-          gtk_label_set_text(self->gain_label, fmt::format("{0:.0Lf}", util::linear_to_db(value)).c_str());
-        },
-        [=]() { g_object_unref(self); });
-  }));
-
-  self->data->connections.push_back(gate->envelope.connect([=](const float value) {
-    g_object_ref(self);
+    gtk_label_set_text(self->attack_zone_start_label,
+                       fmt::format(ui::get_user_locale(), "{0:.1Lf}",
+                                   util::linear_to_db(gate->attack_zone_start_port_value)).c_str());
 
-    util::idle_add(
-        [=]() {
-          if (get_ignore_filter_idle_add(serial)) {
-            return;
-          }
+    gtk_label_set_text(self->attack_threshold_label,
+                       fmt::format(ui::get_user_locale(), "{0:.1Lf}",
+                                   util::linear_to_db(gate->attack_threshold_port_value)).c_str());
 
-          if (!GTK_IS_LABEL(self->envelope_label)) {
-            return;
-          }
+    gtk_label_set_text(self->release_zone_start_label,
+                       fmt::format(ui::get_user_locale(), "{0:.1Lf}",
+                                   util::linear_to_db(gate->release_zone_start_port_value)).c_str());
 
-          gtk_label_set_text(self->envelope_label, fmt::format("{0:.0f}", util::linear_to_db(value)).c_str());
-        },
-        [=]() { g_object_unref(self); });
-  }));
+    gtk_label_set_text(self->release_threshold_label,
+                       fmt::format(ui::get_user_locale(), "{0:.1Lf}",
+                                   util::linear_to_db(gate->release_threshold_port_value)).c_str());
 
-  self->data->connections.push_back(gate->sidechain.connect([=](const float value) {
-    g_object_ref(self);
+    gtk_label_set_text(self->gain_label,
+                       fmt::format("{0:.0Lf}", util::linear_to_db(gate->reduction_port_value)).c_str());
 
-    util::idle_add(
-        [=]() {
-          if (get_ignore_filter_idle_add(serial)) {
-            return;
-          }
+    gtk_label_set_text(self->envelope_label,
+                       fmt::format("{0:.0f}", util::linear_to_db(gate->envelope_port_value)).c_str());
 
-          if (!GTK_IS_LABEL(self->sidechain_label)) {
-            return;
-          }
-
-          gtk_label_set_text(self->sidechain_label, fmt::format("{0:.0f}", util::linear_to_db(value)).c_str());
-        },
-        [=]() { g_object_unref(self); });
-  }));
+    gtk_label_set_text(self->sidechain_label,
+                       fmt::format("{0:.0f}", util::linear_to_db(gate->sidechain_port_value)).c_str());
 
-  self->data->connections.push_back(gate->curve.connect([=](const float value) {
-    g_object_ref(self);
-
-    util::idle_add(
-        [=]() {
-          if (get_ignore_filter_idle_add(serial)) {
-            return;
-          }
-
-          if (!GTK_IS_LABEL(self->curve_label)) {
-            return;
-          }
-
-          gtk_label_set_text(self->curve_label, fmt::format("{0:.0f}", util::linear_to_db(value)).c_str());
-        },
-        [=]() { g_object_unref(self); });
-  }));
+    gtk_label_set_text(self->curve_label, fmt::format("{0:.0f}", util::linear_to_db(gate->curve_port_value)).c_str());
+  });
 
   self->data->connections.push_back(pm->source_added.connect([=](const NodeInfo info) {
     for (guint n = 0U; n < g_list_model_get_n_items(G_LIST_MODEL(self->input_devices_model)); n++) {
@@ -0,0 +1,274 @@
+/*
+ *  Copyright © 2017-2024 Wellington Wallace
+ *
+ *  This file is part of Easy Effects.
+ *
+ *  Easy Effects is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Easy Effects is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "generic_lv2.hpp"
+#include <gio/gio.h>
+#include <glib-object.h>
+#include <glib.h>
+#include <sys/types.h>
+#include <algorithm>
+#include <climits>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <vector>
+#include "lv2_wrapper.hpp"
+#include "pipe_manager.hpp"
+#include "plugin_base.hpp"
+#include "tags_plugin_name.hpp"
+#include "util.hpp"
+
+GenericLv2::GenericLv2(const std::string& tag,
+                       const std::string& schema,
+                       const std::string& schema_path,
+                       PipeManager* pipe_manager,
+                       PipelineType pipe_type)
+    : PluginBase(tag,
+                 tags::plugin_name::generic_lv2,
+                 tags::plugin_package::lv2,
+                 schema,
+                 schema_path,
+                 pipe_manager,
+                 pipe_type) {
+  load_plugin();
+
+  gconnections.push_back(g_signal_connect(settings, "changed::uri",
+                                          G_CALLBACK(+[](GSettings* settings, char* key, gpointer user_data) {
+                                            auto* self = static_cast<GenericLv2*>(user_data);
+
+                                            self->load_plugin();
+                                          }),
+                                          this));
+
+  setup_input_output_gain();
+}
+
+GenericLv2::~GenericLv2() {
+  if (connected_to_pw) {
+    disconnect_from_pw();
+  }
+
+  util::debug(log_tag + name + " destroyed");
+}
+
+auto GenericLv2::check_ports(const lv2::Lv2Wrapper& wrapper) -> bool {
+  /*
+    Running a plugin with a port left unconnected is undefined behavior. We connect the control ports and at most two
+    audio inputs and two audio outputs. Anything else has to be optional.
+  */
+
+  const auto n_in = wrapper.get_n_audio_in();
+  const auto n_out = wrapper.get_n_audio_out();
+
+  if (n_in == 0U || n_in > 2U || n_out == 0U || n_out > 2U) {
+    return false;
+  }
+
+  return std::ranges::all_of(wrapper.get_ports(), [](const lv2::Port& p) {
+    return p.optional || p.type == lv2::TYPE_CONTROL || p.type == lv2::TYPE_AUDIO;
+  });
+}
+
+void GenericLv2::load_plugin() {
+  const auto uri = util::gsettings_get_string(settings, "uri");
+
+  std::unique_ptr<lv2::Lv2Wrapper> wrapper;
+
+  bool unsupported = false;
+
+  if (!uri.empty()) {
+    wrapper = std::make_unique<lv2::Lv2Wrapper>(uri);
+
+    if (wrapper->found_plugin && !check_ports(*wrapper)) {
+      util::warning(log_tag + uri + " has audio, CV or atom ports we can not connect. It will not be loaded");
+
+      wrapper->found_plugin = false;
+
+      unsupported = true;
+    }
+
+    if (wrapper->found_plugin) {
+      wrapper->bind_key_controls(settings, "controls");
+    } else if (!unsupported) {
+      util::debug(log_tag + uri + " is not installed");
+    }
+  }
+
+  /*
+    Instantiating may take a while, so it is never done while holding the lock the realtime thread takes. If the rate
+    changed in the meantime we instantiate again before swapping.
+  */
+
+  const auto needs_instance = [&]() {
+    return wrapper != nullptr && wrapper->found_plugin && rate != 0U && wrapper->get_rate() != rate;
+  };
+
+  while (true) {
+    if (needs_instance()) {
+      wrapper->set_n_samples(n_samples);
+      wrapper->create_instance(rate);
+    }
+
+    std::scoped_lock<std::mutex> lock(data_mutex);
+
+    if (needs_instance()) {
+      continue;
+    }
+
+    if (wrapper != nullptr && wrapper->found_plugin) {
+      wrapper->set_n_samples(n_samples);
+    }
+
+    lv2_wrapper.swap(wrapper);
+
+    latency_port = (lv2_wrapper != nullptr) ? lv2_wrapper->get_latency_port() : UINT_MAX;
+
+    latency_n_frames = 0U;
+
+    mono_output = lv2_wrapper != nullptr && lv2_wrapper->get_n_audio_out() == 1U;
+
+    has_unsupported_ports = unsupported;
+
+    break;
+  }
+
+  wrapper.reset();  // the previous plugin, freed outside of the lock
+
+  if (latency_value != 0.0F) {
+    latency_value = 0.0F;
+
+    latency.emit();
+
+    update_filter_params();
+  }
+
+  plugin_changed.emit();
+}
+
+void GenericLv2::setup() {
+  std::scoped_lock<std::mutex> lock(data_mutex);
+
+  if (lv2_wrapper == nullptr || !lv2_wrapper->found_plugin) {
+    return;
+  }
+
+  lv2_wrapper->set_n_samples(n_samples);
+
+  if (lv2_wrapper->get_rate() != rate) {
+    lv2_wrapper->create_instance(rate);
+  }
+}
+
+void GenericLv2::process(std::span<float>& left_in,
+                         std::span<float>& right_in,
+                         std::span<float>& left_out,
+                         std::span<float>& right_out) {
+  std::scoped_lock<std::mutex> lock(data_mutex);
+
+  if (lv2_wrapper == nullptr || !lv2_wrapper->found_plugin || !lv2_wrapper->has_instance() || bypass) {
+    std::copy(left_in.begin(), left_in.end(), left_out.begin());
+    std::copy(right_in.begin(), right_in.end(), right_out.begin());
+
+    return;
+  }
+
+  if (input_gain != 1.0F) {
+    apply_gain(left_in, right_in, input_gain);
+  }
+
+  lv2_wrapper->connect_data_ports(left_in, right_in, left_out, right_out);
+  lv2_wrapper->run();
+
+  // Nothing is connected to right_out. It would keep whatever PipeWire left in the buffer.
+
+  if (mono_output) {
+    std::copy(left_out.begin(), left_out.end(), right_out.begin());
+  }
+
+  if (output_gain != 1.0F) {
+    apply_gain(left_out, right_out, output_gain);
+  }
+
+  if (latency_port != UINT_MAX) {
+    const auto lv = static_cast<uint>(lv2_wrapper->get_control_port_value(latency_port));
+
+    if (latency_n_frames != lv) {
+      latency_n_frames = lv;
+
+      latency_value = static_cast<float>(latency_n_frames) / static_cast<float>(rate);
+
+      util::debug(log_tag + name + " latency: " + util::to_string(latency_value, "") + " s");
+
+      util::idle_add([this]() {
+        if (!post_messages || latency.empty()) {
+          return;
+        }
+
+        latency.emit();
+      });
+
+      update_filter_params();
+    }
+  }
+
+  if (post_messages) {
+    get_peaks(left_in, right_in, left_out, right_out);
+
+    if (send_notifications) {
+      notify();
+    }
+  }
+}
+
+auto GenericLv2::get_latency_seconds() -> float {
+  return latency_value;
+}
+
+auto GenericLv2::plugin_found() const -> bool {
+  return lv2_wrapper != nullptr && lv2_wrapper->found_plugin;
+}
+
+auto GenericLv2::unsupported_ports() const -> bool {
+  return has_unsupported_ports;
+}
+
+auto GenericLv2::get_control_ports() const -> std::vector<lv2::Port> {
+  std::vector<lv2::Port> list;
+
+  if (!plugin_found()) {
+    return list;
+  }
+
+  for (const auto& p : lv2_wrapper->get_ports()) {
+    if (p.type == lv2::TYPE_CONTROL && p.is_input) {
+      list.push_back(p);
+    }
+  }
+
+  return list;
+}
+
+auto GenericLv2::get_control_value(const uint& index) const -> float {
+  return plugin_found() ? lv2_wrapper->get_control_port_value(index) : 0.0F;
+}
+
+auto GenericLv2::get_default_control_value(const uint& index) const -> float {
+  return plugin_found() ? lv2_wrapper->get_default_control_port_value(index) : 0.0F;
+}
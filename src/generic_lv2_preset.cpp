@@ -0,0 +1,95 @@
+/*
+ *  Copyright © 2017-2024 Wellington Wallace
+ *
+ *  This file is part of Easy Effects.
+ *
+ *  Easy Effects is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Easy Effects is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "generic_lv2_preset.hpp"
+#include <gio/gio.h>
+#include <glib.h>
+#include <nlohmann/json.hpp>
+#include <nlohmann/json_fwd.hpp>
+#include <string>
+#include "plugin_preset_base.hpp"
+#include "preset_type.hpp"
+#include "tags_plugin_name.hpp"
+#include "tags_schema.hpp"
+#include "util.hpp"
+
+GenericLv2Preset::GenericLv2Preset(PresetType preset_type, const int& index)
+    : PluginPresetBase(tags::schema::generic_lv2::id,
+                       tags::schema::generic_lv2::input_path,
+                       tags::schema::generic_lv2::output_path,
+                       preset_type,
+                       index) {
+  instance_name.assign(tags::plugin_name::generic_lv2).append("#").append(util::to_string(index));
+}
+
+void GenericLv2Preset::save(nlohmann::json& json) {
+  json[section][instance_name]["bypass"] = g_settings_get_boolean(settings, "bypass") != 0;
+
+  json[section][instance_name]["input-gain"] = g_settings_get_double(settings, "input-gain");
+
+  json[section][instance_name]["output-gain"] = g_settings_get_double(settings, "output-gain");
+
+  json[section][instance_name]["uri"] = util::gsettings_get_string(settings, "uri");
+
+  json[section][instance_name]["controls"] = nlohmann::json::object();
+
+  auto* controls = g_settings_get_value(settings, "controls");
+
+  GVariantIter iter;
+  const gchar* symbol = nullptr;
+  gdouble value = 0.0;
+
+  g_variant_iter_init(&iter, controls);
+
+  while (g_variant_iter_next(&iter, "{&sd}", &symbol, &value) != 0) {
+    json[section][instance_name]["controls"][symbol] = value;
+  }
+
+  g_variant_unref(controls);
+}
+
+void GenericLv2Preset::load(const nlohmann::json& json) {
+  update_key<bool>(json.at(section).at(instance_name), settings, "bypass", "bypass");
+
+  update_key<double>(json.at(section).at(instance_name), settings, "input-gain", "input-gain");
+
+  update_key<double>(json.at(section).at(instance_name), settings, "output-gain", "output-gain");
+
+  update_key<gchar*>(json.at(section).at(instance_name), settings, "uri", "uri");
+
+  GVariantBuilder builder;
+
+  g_variant_builder_init(&builder, G_VARIANT_TYPE("a{sd}"));
+
+  const auto json_controls = json.at(section).at(instance_name).value("controls", nlohmann::json::object());
+
+  for (const auto& [symbol, value] : json_controls.items()) {
+    g_variant_builder_add(&builder, "{sd}", symbol.c_str(), value.get<double>());
+  }
+
+  auto* new_controls = g_variant_ref_sink(g_variant_builder_end(&builder));
+  auto* controls = g_settings_get_value(settings, "controls");
+
+  if (g_variant_equal(controls, new_controls) == 0) {
+    g_settings_set_value(settings, "controls", new_controls);
+  }
+
+  g_variant_unref(controls);
+  g_variant_unref(new_controls);
+}
@@ -0,0 +1,346 @@
+/*
+ *  Copyright © 2017-2024 Wellington Wallace
+ *
+ *  This file is part of Easy Effects.
+ *
+ *  Easy Effects is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Easy Effects is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "generic_lv2_ui.hpp"
+#include <adwaita.h>
+#include <gio/gio.h>
+#include <glib-object.h>
+#include <glib.h>
+#include <glib/gi18n.h>
+#include <glibconfig.h>
+#include <gobject/gobject.h>
+#include <gtk/gtk.h>
+#include <sigc++/connection.h>
+#include <sys/types.h>
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+#include "generic_lv2.hpp"
+#include "tags_resources.hpp"
+#include "tags_schema.hpp"
+#include "ui_helpers.hpp"
+#include "util.hpp"
+
+namespace ui::generic_lv2_box {
+
+struct Data {
+ public:
+  ~Data() { util::debug("data struct destroyed"); }
+
+  uint serial = 0U;
+
+  bool updating_controls = false;
+
+  std::shared_ptr<GenericLv2> generic_lv2;
+
+  std::vector<GtkWidget*> control_rows;
+
+  std::vector<GtkSpinButton*> control_spinbuttons;
+
+  std::vector<sigc::connection> connections;
+
+  std::vector<gulong> gconnections;
+};
+
+struct _GenericLv2Box {
+  GtkBox parent_instance;
+
+  GtkScale *input_gain, *output_gain;
+
+  GtkLevelBar *input_level_left, *input_level_right, *output_level_left, *output_level_right;
+
+  GtkLabel *input_level_left_label, *input_level_right_label, *output_level_left_label, *output_level_right_label,
+      *plugin_credit;
+
+  GtkToggleButton* show_native_ui;
+
+  AdwEntryRow* uri;
+
+  AdwPreferencesGroup* controls_group;
+
+  GSettings* settings;
+
+  Data* data;
+};
+
+// NOLINTNEXTLINE
+G_DEFINE_TYPE(GenericLv2Box, generic_lv2_box, GTK_TYPE_BOX)
+
+void on_reset(GenericLv2Box* self, GtkButton* btn) {
+  util::reset_all_keys_except(self->settings, {"uri"});
+}
+
+void on_show_native_window(GenericLv2Box* self, GtkToggleButton* btn) {
+  if (gtk_toggle_button_get_active(btn) != 0) {
+    self->data->generic_lv2->show_native_ui();
+  } else {
+    self->data->generic_lv2->close_native_ui();
+  }
+}
+
+void on_uri_apply(GenericLv2Box* self, AdwEntryRow* row) {
+  g_settings_set_string(self->settings, "uri", gtk_editable_get_text(GTK_EDITABLE(row)));
+}
+
+void set_control_value(GenericLv2Box* self, const char* symbol, const double& value) {
+  GVariantBuilder builder;
+
+  g_variant_builder_init(&builder, G_VARIANT_TYPE("a{sd}"));
+
+  auto* controls = g_settings_get_value(self->settings, "controls");
+
+  GVariantIter iter;
+  const gchar* key = nullptr;
+  gdouble v = 0.0;
+
+  g_variant_iter_init(&iter, controls);
+
+  while (g_variant_iter_next(&iter, "{&sd}", &key, &v) != 0) {
+    if (g_strcmp0(key, symbol) != 0) {
+      g_variant_builder_add(&builder, "{sd}", key, v);
+    }
+  }
+
+  g_variant_builder_add(&builder, "{sd}", symbol, value);
+
+  g_settings_set_value(self->settings, "controls", g_variant_builder_end(&builder));
+
+  g_variant_unref(controls);
+}
+
+void update_controls(GenericLv2Box* self) {
+  // Like Lv2Wrapper::load_controls_from_gsettings(), a port missing from the dictionary is at its default value
+
+  auto* controls = g_settings_get_value(self->settings, "controls");
+
+  self->data->updating_controls = true;
+
+  for (auto* spinbutton : self->data->control_spinbuttons) {
+    const auto index = GPOINTER_TO_UINT(g_object_get_data(G_OBJECT(spinbutton), "port-index"));
+    const auto* symbol = static_cast<const char*>(g_object_get_data(G_OBJECT(spinbutton), "port-symbol"));
+
+    gdouble value = 0.0;
+
+    if (g_variant_lookup(controls, symbol, "d", &value) == 0) {
+      value = static_cast<gdouble>(self->data->generic_lv2->get_default_control_value(index));
+    }
+
+    gtk_spin_button_set_value(spinbutton, value);
+  }
+
+  self->data->updating_controls = false;
+
+  g_variant_unref(controls);
+}
+
+void build_controls(GenericLv2Box* self) {
+  for (auto* row : self->data->control_rows) {
+    adw_preferences_group_remove(self->controls_group, row);
+  }
+
+  self->data->control_rows.clear();
+  self->data->control_spinbuttons.clear();
+
+  const auto uri = util::gsettings_get_string(self->settings, "uri");
+
+  gtk_editable_set_text(GTK_EDITABLE(self->uri), uri.c_str());
+
+  gtk_toggle_button_set_active(self->show_native_ui, 0);
+
+  if (!self->data->generic_lv2->plugin_found()) {
+    if (uri.empty()) {
+      adw_preferences_group_set_description(self->controls_group, _("No plugin selected"));
+    } else if (self->data->generic_lv2->unsupported_ports()) {
+      adw_preferences_group_set_description(self->controls_group,
+                                            _("The plugin has audio, CV or event ports that are not supported"));
+    } else {
+      adw_preferences_group_set_description(self->controls_group, _("The plugin is not installed"));
+    }
+
+    return;
+  }
+
+  adw_preferences_group_set_description(self->controls_group, nullptr);
+
+  for (const auto& port : self->data->generic_lv2->get_control_ports()) {
+    // Unbounded controls get a finite range so the spinbutton remains usable
+
+    const auto lower = std::isinf(port.min) ? -1.0E6 : static_cast<double>(port.min);
+    const auto upper = std::isinf(port.max) ? 1.0E6 : static_cast<double>(port.max);
+
+    const auto step = port.is_discrete ? 1.0 : std::max((upper - lower) / 100.0, 0.001);
+
+    auto* row = adw_action_row_new();
+
+    adw_preferences_row_set_title(ADW_PREFERENCES_ROW(row), port.name.c_str());
+
+    auto* spinbutton = GTK_SPIN_BUTTON(gtk_spin_button_new_with_range(lower, upper, step));
+
+    gtk_spin_button_set_digits(spinbutton, port.is_discrete ? 0 : 3);
+
+    gtk_widget_set_valign(GTK_WIDGET(spinbutton), GTK_ALIGN_CENTER);
+
+    gtk_spin_button_set_value(spinbutton, self->data->generic_lv2->get_control_value(port.index));
+
+    g_object_set_data(G_OBJECT(spinbutton), "port-index", GUINT_TO_POINTER(port.index));
+
+    g_object_set_data_full(G_OBJECT(spinbutton), "port-symbol", g_strdup(port.symbol.c_str()), g_free);
+
+    g_signal_connect(spinbutton, "value-changed", G_CALLBACK(+[](GtkSpinButton* btn, GenericLv2Box* self) {
+                       if (self->data->updating_controls) {
+                         return;
+                       }
+
+                       const auto* symbol = static_cast<const char*>(g_object_get_data(G_OBJECT(btn), "port-symbol"));
+
+                       set_control_value(self, symbol, gtk_spin_button_get_value(btn));
+                     }),
+                     self);
+
+    adw_action_row_add_suffix(ADW_ACTION_ROW(row), GTK_WIDGET(spinbutton));
+
+    adw_preferences_group_add(self->controls_group, row);
+
+    self->data->control_rows.push_back(row);
+    self->data->control_spinbuttons.push_back(spinbutton);
+  }
+}
+
+void setup(GenericLv2Box* self, std::shared_ptr<GenericLv2> generic_lv2, const std::string& schema_path) {
+  auto serial = get_new_filter_serial();
+
+  self->data->serial = serial;
+
+  g_object_set_data(G_OBJECT(self), "serial", GUINT_TO_POINTER(serial));
+
+  set_ignore_filter_idle_add(serial, false);
+
+  self->data->generic_lv2 = generic_lv2;
+
+  self->settings = g_settings_new_with_path(tags::schema::generic_lv2::id, schema_path.c_str());
+
+  generic_lv2->set_post_messages(true);
+
+  add_meters_tick_callback(GTK_WIDGET(self), generic_lv2.get(), [=]() {
+    update_level(self->input_level_left, self->input_level_left_label, self->input_level_right,
+                 self->input_level_right_label, generic_lv2->input_level_left_db, generic_lv2->input_level_right_db);
+
+    update_level(self->output_level_left, self->output_level_left_label, self->output_level_right,
+                 self->output_level_right_label, generic_lv2->output_level_left_db,
+                 generic_lv2->output_level_right_db);
+  });
+
+  gtk_label_set_text(self->plugin_credit, ui::get_plugin_credit_translated(self->data->generic_lv2->package).c_str());
+
+  gsettings_bind_widgets<"input-gain", "output-gain">(self->settings, self->input_gain, self->output_gain);
+
+  build_controls(self);
+
+  self->data->connections.push_back(generic_lv2->plugin_changed.connect([=]() { build_controls(self); }));
+
+  // The order in which separate GSettings objects are notified is unspecified, so the values are read from the key
+
+  self->data->gconnections.push_back(g_signal_connect(
+      self->settings, "changed::controls",
+      G_CALLBACK(+[](GSettings* settings, char* key, GenericLv2Box* self) { update_controls(self); }), self));
+
+  g_settings_bind(ui::get_global_app_settings(), "show-native-plugin-ui", self->show_native_ui, "visible",
+                  G_SETTINGS_BIND_DEFAULT);
+}
+
+void dispose(GObject* object) {
+  auto* self = EE_GENERIC_LV2_BOX(object);
+
+  self->data->generic_lv2->close_native_ui();
+
+  set_ignore_filter_idle_add(self->data->serial, true);
+
+  for (auto& c : self->data->connections) {
+    c.disconnect();
+  }
+
+  for (auto& handler_id : self->data->gconnections) {
+    g_signal_handler_disconnect(self->settings, handler_id);
+  }
+
+  self->data->connections.clear();
+  self->data->gconnections.clear();
+
+  g_object_unref(self->settings);
+
+  util::debug("disposed");
+
+  G_OBJECT_CLASS(generic_lv2_box_parent_class)->dispose(object);
+}
+
+void finalize(GObject* object) {
+  auto* self = EE_GENERIC_LV2_BOX(object);
+
+  delete self->data;
+
+  util::debug("finalize");
+
+  G_OBJECT_CLASS(generic_lv2_box_parent_class)->finalize(object);
+}
+
+void generic_lv2_box_class_init(GenericLv2BoxClass* klass) {
+  auto* object_class = G_OBJECT_CLASS(klass);
+  auto* widget_class = GTK_WIDGET_CLASS(klass);
+
+  object_class->dispose = dispose;
+  object_class->finalize = finalize;
+
+  gtk_widget_class_set_template_from_resource(widget_class, tags::resources::generic_lv2_ui);
+
+  gtk_widget_class_bind_template_child(widget_class, GenericLv2Box, input_gain);
+  gtk_widget_class_bind_template_child(widget_class, GenericLv2Box, output_gain);
+  gtk_widget_class_bind_template_child(widget_class, GenericLv2Box, input_level_left);
+  gtk_widget_class_bind_template_child(widget_class, GenericLv2Box, input_level_right);
+  gtk_widget_class_bind_template_child(widget_class, GenericLv2Box, output_level_left);
+  gtk_widget_class_bind_template_child(widget_class, GenericLv2Box, output_level_right);
+  gtk_widget_class_bind_template_child(widget_class, GenericLv2Box, input_level_left_label);
+  gtk_widget_class_bind_template_child(widget_class, GenericLv2Box, input_level_right_label);
+  gtk_widget_class_bind_template_child(widget_class, GenericLv2Box, output_level_left_label);
+  gtk_widget_class_bind_template_child(widget_class, GenericLv2Box, output_level_right_label);
+  gtk_widget_class_bind_template_child(widget_class, GenericLv2Box, plugin_credit);
+
+  gtk_widget_class_bind_template_child(widget_class, GenericLv2Box, show_native_ui);
+  gtk_widget_class_bind_template_child(widget_class, GenericLv2Box, uri);
+  gtk_widget_class_bind_template_child(widget_class, GenericLv2Box, controls_group);
+
+  gtk_widget_class_bind_template_callback(widget_class, on_reset);
+  gtk_widget_class_bind_template_callback(widget_class, on_show_native_window);
+  gtk_widget_class_bind_template_callback(widget_class, on_uri_apply);
+}
+
+void generic_lv2_box_init(GenericLv2Box* self) {
+  gtk_widget_init_template(GTK_WIDGET(self));
+
+  self->data = new Data();
+
+  prepare_scales<"dB">(self->input_gain, self->output_gain);
+}
+
+auto create() -> GenericLv2Box* {
+  return static_cast<GenericLv2Box*>(g_object_new(EE_TYPE_GENERIC_LV2_BOX, nullptr));
+}
+
+}  // namespace ui::generic_lv2_box
@@ -21,6 +21,9 @@
 #include <dlfcn.h>
 #include <ladspa.h>
 #include <sys/types.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <cassert>
 #include <cmath>
 #include <cstdlib>
@@ -30,6 +33,7 @@
 #include <string>
 #include <tuple>
 #include <utility>
+#include <vector>
 #include "config.h"
 #include "util.hpp"
 
@@ -159,6 +163,7 @@ LadspaWrapper::LadspaWrapper(const std::string& plugin_filename, const std::stri
 
         auto* control_ports = new LADSPA_Data[count]();
         auto* control_ports_initialized = new bool[count]();
+        auto* staged_control_ports = new std::atomic<LADSPA_Data>[count]();
 
         h.disable();
 
@@ -167,6 +172,7 @@ LadspaWrapper::LadspaWrapper(const std::string& plugin_filename, const std::stri
         this->found = true;
         this->control_ports = control_ports;
         this->control_ports_initialized = control_ports_initialized;
+        this->staged_control_ports = staged_control_ports;
 
         for (unsigned long i = 0UL, j = 0UL; i < descriptor->PortCount; i++) {
           if (LADSPA_IS_PORT_CONTROL(descriptor->PortDescriptors[i])) {
@@ -198,6 +204,10 @@ LadspaWrapper::~LadspaWrapper() {
     delete[] std::exchange(control_ports, nullptr);
   }
 
+  if (staged_control_ports) {
+    delete[] std::exchange(staged_control_ports, nullptr);
+  }
+
   if (dl_handle != nullptr) {
     dlclose(std::exchange(dl_handle, nullptr));
   }
@@ -372,10 +382,15 @@ auto LadspaWrapper::create_instance(uint rate) -> bool {
 
   ladspahandle h(new_instance, descriptor->cleanup);
 
+  commit_control_ports();
+
   scale_control_ports(descriptor, control_ports, control_ports_initialized, this->rate, rate);
 
   for (unsigned long i = 0UL, j = 0UL; i < descriptor->PortCount; i++) {
     if (LADSPA_IS_PORT_CONTROL(descriptor->PortDescriptors[i])) {
+      // Defaults and rate scaling have to be seen by the main thread too
+      staged_control_ports[j].store(control_ports[j], std::memory_order_relaxed);
+
       descriptor->connect_port(new_instance, i, &control_ports[j++]);
     }
   }
@@ -393,6 +408,8 @@ auto LadspaWrapper::create_instance(uint rate) -> bool {
   this->instance = new_instance;
   this->rate = rate;
 
+  connected_buffers = {};
+
   activate();
 
   return true;
@@ -437,6 +454,15 @@ void LadspaWrapper::connect_data_ports(const std::span<const float>& left_in,
     return;
   }
 
+  const std::array<const LADSPA_Data*, 6U> buffers{left_in.data(), right_in.data(), nullptr, nullptr, left_out.data(),
+                                                   right_out.data()};
+
+  if (buffers == connected_buffers) {
+    return;
+  }
+
+  connected_buffers = buffers;
+
   unsigned long left_in_idx = -1L;
   unsigned long right_in_idx = -1L;
   unsigned long first_in_idx = -1L;
@@ -533,6 +559,15 @@ void LadspaWrapper::connect_data_ports(const std::span<const float>& left_in,
     return;
   }
 
+  const std::array<const LADSPA_Data*, 6U> buffers{left_in.data(),    right_in.data(),  probe_left.data(),
+                                                   probe_right.data(), left_out.data(), right_out.data()};
+
+  if (buffers == connected_buffers) {
+    return;
+  }
+
+  connected_buffers = buffers;
+
   unsigned long left_in_idx = -1L;
   unsigned long right_in_idx = -1L;
   unsigned long first_in_idx = -1L;
@@ -678,13 +713,77 @@ void LadspaWrapper::deactivate() {
   active = false;
 }
 
-void LadspaWrapper::run() const {
+void LadspaWrapper::run() {
   assert(active);
   assert(instance);
 
+  commit_control_ports();
+
   descriptor->run(instance, n_samples);
 }
 
+auto LadspaWrapper::supports_in_place() const -> bool {
+  return descriptor != nullptr && !LADSPA_IS_INPLACE_BROKEN(descriptor->Properties);
+}
+
+void LadspaWrapper::set_max_block_size(const uint& value) {
+  max_block_size = value;
+
+  buffer_l.resize(value);
+  buffer_r.resize(value);
+
+  if (supports_in_place()) {
+    buffer_out_l.clear();
+    buffer_out_r.clear();
+  } else {
+    buffer_out_l.resize(value);
+    buffer_out_r.resize(value);
+  }
+}
+
+void LadspaWrapper::run_buffered(const std::span<const float>& left_in,
+                                 const std::span<const float>& right_in,
+                                 std::span<const float>& left_out,
+                                 std::span<const float>& right_out) {
+  const auto n = std::min({left_in.size(), right_in.size(), static_cast<size_t>(max_block_size)});
+
+  std::copy_n(left_in.begin(), n, buffer_l.begin());
+  std::copy_n(right_in.begin(), n, buffer_r.begin());
+
+  const auto in_l = std::span<float>(buffer_l).first(n);
+  const auto in_r = std::span<float>(buffer_r).first(n);
+
+  const auto out_l = buffer_out_l.empty() ? in_l : std::span<float>(buffer_out_l).first(n);
+  const auto out_r = buffer_out_r.empty() ? in_r : std::span<float>(buffer_out_r).first(n);
+
+  // The buffers never move, so the ports are only connected again if the plugin was instantiated again
+
+  connect_data_ports(in_l, in_r, out_l, out_r);
+
+  n_samples = static_cast<uint>(n);
+
+  run();
+
+  left_out = out_l;
+  right_out = out_r;
+}
+
+void LadspaWrapper::commit_control_ports() {
+  if (!control_ports_dirty.exchange(false, std::memory_order_acquire)) {
+    return;
+  }
+
+  for (unsigned long i = 0UL, j = 0UL; i < descriptor->PortCount; i++) {
+    if (LADSPA_IS_PORT_CONTROL(descriptor->PortDescriptors[i])) {
+      if (LADSPA_IS_PORT_INPUT(descriptor->PortDescriptors[i])) {
+        control_ports[j] = staged_control_ports[j].load(std::memory_order_relaxed);
+      }
+
+      j++;
+    }
+  }
+}
+
 auto LadspaWrapper::get_control_port_count() const -> uint {
   uint count = 0U;
 
@@ -758,6 +857,10 @@ auto LadspaWrapper::get_control_port_value(uint index) const -> float {
   assert(cp_to_port_idx(descriptor, index) != null_ul);
   assert(control_ports_initialized[index]);
 
+  if (!is_control_port_output(index)) {
+    return staged_control_ports[index].load(std::memory_order_relaxed);
+  }
+
   return control_ports[index];
 }
 
@@ -781,9 +884,11 @@ auto LadspaWrapper::set_control_port_value_clamp(uint index, float value) -> flo
   // If the value is out of bounds, get a new clamped one in LADSPA_Data (float)
   value = clamp_port_value(descriptor, i, rate, value);
 
-  control_ports[index] = value;
+  staged_control_ports[index].store(value, std::memory_order_relaxed);
   control_ports_initialized[index] = true;
 
+  control_ports_dirty.store(true, std::memory_order_release);
+
   return value;
 }
 
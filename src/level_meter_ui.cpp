@@ -96,20 +96,10 @@ void setup(LevelMeterBox* self, std::shared_ptr<LevelMeter> level_meter, const s
 
   level_meter->set_post_messages(true);
 
-  self->data->connections.push_back(level_meter->input_level.connect([=](const float left, const float right) {
-    g_object_ref(self);
-
-    util::idle_add(
-        [=]() {
-          if (get_ignore_filter_idle_add(serial)) {
-            return;
-          }
-
-          update_level(self->input_level_left, self->input_level_left_label, self->input_level_right,
-                       self->input_level_right_label, left, right);
-        },
-        [=]() { g_object_unref(self); });
-  }));
+  add_meters_tick_callback(GTK_WIDGET(self), level_meter.get(), [=]() {
+    update_level(self->input_level_left, self->input_level_left_label, self->input_level_right,
+                 self->input_level_right_label, level_meter->input_level_left_db, level_meter->input_level_right_db);
+  });
 
   self->data->connections.push_back(level_meter->results.connect(
       [=](const double momentary, const double shortterm, const double integrated, const double relative,
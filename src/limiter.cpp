@@ -54,6 +54,12 @@ Limiter::Limiter(const std::string& tag,
     util::debug(log_tag + "http://lsp-plug.in/plugins/lv2/sc_limiter_stereo is not installed");
   }
 
+  latency_port = lv2_wrapper->port_ref<"out_latency">();
+  gain_l_port = lv2_wrapper->port_ref<"grlm_l">();
+  gain_r_port = lv2_wrapper->port_ref<"grlm_r">();
+  sidechain_l_port = lv2_wrapper->port_ref<"sclm_l">();
+  sidechain_r_port = lv2_wrapper->port_ref<"sclm_r">();
+
   gconnections.push_back(g_signal_connect(settings, "changed::external-sidechain",
                                           G_CALLBACK(+[](GSettings* settings, char* key, gpointer user_data) {
                                             auto* self = static_cast<Limiter*>(user_data);
@@ -151,7 +157,7 @@ void Limiter::process(std::span<float>& left_in,
    This plugin gives the latency in number of samples
  */
 
-  const auto lv = static_cast<uint>(lv2_wrapper->get_control_port_value("out_latency"));
+  const auto lv = static_cast<uint>(lv2_wrapper->get_control_port_value(latency_port));
 
   if (latency_n_frames != lv) {
     latency_n_frames = lv;
@@ -175,15 +181,10 @@ void Limiter::process(std::span<float>& left_in,
     get_peaks(left_in, right_in, left_out, right_out);
 
     if (send_notifications) {
-      gain_l_port_value = lv2_wrapper->get_control_port_value("grlm_l");
-      gain_r_port_value = lv2_wrapper->get_control_port_value("grlm_r");
-      sidechain_l_port_value = lv2_wrapper->get_control_port_value("sclm_l");
-      sidechain_r_port_value = lv2_wrapper->get_control_port_value("sclm_r");
-
-      gain_left.emit(gain_l_port_value);
-      gain_right.emit(gain_r_port_value);
-      sidechain_left.emit(sidechain_l_port_value);
-      sidechain_right.emit(sidechain_r_port_value);
+      gain_l_port_value = lv2_wrapper->get_control_port_value(gain_l_port);
+      gain_r_port_value = lv2_wrapper->get_control_port_value(gain_r_port);
+      sidechain_l_port_value = lv2_wrapper->get_control_port_value(sidechain_l_port);
+      sidechain_r_port_value = lv2_wrapper->get_control_port_value(sidechain_r_port);
 
       notify();
     }
@@ -0,0 +1,95 @@
+/*
+ *  Copyright © 2017-2024 Wellington Wallace
+ *
+ *  This file is part of Easy Effects.
+ *
+ *  Easy Effects is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Easy Effects is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "lv2_ui_scheduler.hpp"
+#include <sys/types.h>
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include "lv2_wrapper.hpp"
+#include "util.hpp"
+
+namespace lv2 {
+
+UiScheduler::UiScheduler() : thread([this]() { loop(); }) {
+  util::debug("lv2 ui scheduler: started");
+}
+
+UiScheduler::~UiScheduler() {
+  {
+    std::scoped_lock<std::mutex> lk(mutex);
+
+    running = false;
+  }
+
+  cv.notify_one();
+
+  thread.join();
+}
+
+auto UiScheduler::get() -> UiScheduler& {
+  static UiScheduler instance;
+
+  return instance;
+}
+
+void UiScheduler::add(Lv2Wrapper* client) {
+  {
+    std::scoped_lock<std::mutex> lk(mutex);
+
+    if (std::find(clients.begin(), clients.end(), client) == clients.end()) {
+      clients.push_back(client);
+    }
+  }
+
+  cv.notify_one();
+}
+
+void UiScheduler::remove(Lv2Wrapper* client) {
+  std::scoped_lock<std::mutex> lk(mutex);
+
+  std::erase(clients, client);
+}
+
+void UiScheduler::loop() {
+  std::unique_lock<std::mutex> lk(mutex);
+
+  while (running) {
+    if (clients.empty()) {
+      cv.wait(lk, [this]() { return !running || !clients.empty(); });
+
+      continue;
+    }
+
+    uint update_rate = 1U;
+
+    for (const auto* client : clients) {
+      update_rate = std::max(update_rate, client->ui_update_rate.load());
+    }
+
+    const auto next_tick = std::chrono::steady_clock::now() + std::chrono::milliseconds(1000U / update_rate);
+
+    std::erase_if(clients, [](Lv2Wrapper* client) { return !client->ui_tick(); });
+
+    cv.wait_until(lk, next_tick, [this]() { return !running; });
+  }
+}
+
+}  // namespace lv2
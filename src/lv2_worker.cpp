@@ -0,0 +1,146 @@
+/*
+ *  Copyright © 2017-2024 Wellington Wallace
+ *
+ *  This file is part of Easy Effects.
+ *
+ *  Easy Effects is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Easy Effects is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "lv2_worker.hpp"
+#include <sys/types.h>
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include "lv2_wrapper.hpp"
+#include "util.hpp"
+
+namespace lv2 {
+
+MessageRing::MessageRing(const size_t& capacity) : buffer(std::bit_ceil(capacity)), mask(buffer.size() - 1U) {}
+
+void MessageRing::copy_in(const size_t& pos, const void* data, const size_t& size) {
+  const auto start = pos & mask;
+  const auto first = std::min(size, buffer.size() - start);
+
+  std::memcpy(buffer.data() + start, data, first);
+  std::memcpy(buffer.data(), static_cast<const uint8_t*>(data) + first, size - first);
+}
+
+void MessageRing::copy_out(const size_t& pos, void* data, const size_t& size) const {
+  const auto start = pos & mask;
+  const auto first = std::min(size, buffer.size() - start);
+
+  std::memcpy(data, buffer.data() + start, first);
+  std::memcpy(static_cast<uint8_t*>(data) + first, buffer.data(), size - first);
+}
+
+auto MessageRing::write(const uint32_t& size, const void* data) -> bool {
+  const auto w = write_pos.load(std::memory_order_relaxed);
+  const auto r = read_pos.load(std::memory_order_acquire);
+
+  if (buffer.size() - (w - r) < sizeof(size) + size) {
+    return false;
+  }
+
+  copy_in(w, &size, sizeof(size));
+  copy_in(w + sizeof(size), data, size);
+
+  write_pos.store(w + sizeof(size) + size, std::memory_order_release);
+
+  return true;
+}
+
+auto MessageRing::read(void* data, const uint32_t& capacity, uint32_t& size) -> bool {
+  const auto r = read_pos.load(std::memory_order_relaxed);
+  const auto w = write_pos.load(std::memory_order_acquire);
+
+  if (w == r) {
+    return false;
+  }
+
+  copy_out(r, &size, sizeof(size));
+
+  if (size > capacity) {
+    return false;
+  }
+
+  copy_out(r + sizeof(size), data, size);
+
+  read_pos.store(r + sizeof(size) + size, std::memory_order_release);
+
+  return true;
+}
+
+void MessageRing::reset() {
+  read_pos.store(0U);
+  write_pos.store(0U);
+}
+
+Worker::Worker() : thread([this]() { loop(); }) {
+  util::debug("lv2 worker: started");
+}
+
+Worker::~Worker() {
+  running.store(false);
+
+  pending.release();
+
+  thread.join();
+}
+
+auto Worker::get() -> Worker& {
+  static Worker instance;
+
+  return instance;
+}
+
+void Worker::add(Lv2Wrapper* client) {
+  std::scoped_lock<std::mutex> lk(mutex);
+
+  if (std::find(clients.begin(), clients.end(), client) == clients.end()) {
+    clients.push_back(client);
+  }
+}
+
+void Worker::remove(Lv2Wrapper* client) {
+  std::scoped_lock<std::mutex> lk(mutex);
+
+  std::erase(clients, client);
+}
+
+void Worker::wake_up() {
+  pending.release();
+}
+
+void Worker::loop() {
+  while (true) {
+    pending.acquire();
+
+    if (!running.load()) {
+      break;
+    }
+
+    std::scoped_lock<std::mutex> lk(mutex);
+
+    for (auto* client : clients) {
+      client->process_work_requests();
+    }
+  }
+}
+
+}  // namespace lv2
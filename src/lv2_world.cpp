@@ -0,0 +1,420 @@
+/*
+ *  Copyright © 2017-2024 Wellington Wallace
+ *
+ *  This file is part of Easy Effects.
+ *
+ *  Easy Effects is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Easy Effects is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "lv2_world.hpp"
+#include <glib.h>
+#include <lilv/lilv.h>
+#include <lv2/atom/atom.h>
+#include <lv2/core/lv2.h>
+#include <sys/types.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <vector>
+#include "lv2_wrapper.hpp"
+#include "util.hpp"
+
+namespace lv2 {
+
+namespace {
+
+constexpr auto cache_version = 3;
+
+auto float_to_json(const float& value) -> nlohmann::json {
+  // json has no representation for infinity. Unbounded ranges are stored as null.
+
+  return std::isfinite(value) ? nlohmann::json(value) : nlohmann::json(nullptr);
+}
+
+auto json_to_float(const nlohmann::json& value, const float& fallback) -> float {
+  return value.is_number() ? value.get<float>() : fallback;
+}
+
+}  // namespace
+
+World::World()
+    : world(lilv_world_new()), cache_file(std::string(g_get_user_cache_dir()) + "/easyeffects/lv2_plugins.json") {
+  if (world == nullptr) {
+    util::warning("lv2 world: failed to initialized the world");
+  }
+
+  load_cache();
+}
+
+World::~World() {
+  if (world != nullptr) {
+    lilv_world_free(world);
+  }
+}
+
+auto World::get() -> World& {
+  static World instance;
+
+  return instance;
+}
+
+auto World::lock() -> std::unique_lock<std::mutex> {
+  return std::unique_lock<std::mutex>(mutex);
+}
+
+auto World::get_plugin_info(const std::string& uri) -> std::optional<PluginInfo> {
+  std::scoped_lock<std::mutex> lk(mutex);
+
+  if (const auto it = cache.find(uri); it != cache.end()) {
+    if (it->second.bundle_mtime == get_bundle_mtime(it->second.bundle_uri)) {
+      return it->second;
+    }
+
+    util::debug("lv2 world: the bundle of " + uri + " has changed. Its cached description will be updated");
+
+    cache.erase(it);
+  }
+
+  // Plugins that were not installed during the last scan are not worth another one
+
+  if (missing_plugins.contains(uri)) {
+    return std::nullopt;
+  }
+
+  scan_plugins();
+
+  if (const auto it = cache.find(uri); it != cache.end()) {
+    return it->second;
+  }
+
+  missing_plugins.insert(uri);
+
+  return std::nullopt;
+}
+
+void World::scan_plugins() {
+  /*
+    Scanning all the installed bundles is the expensive part, so every plugin found is described at once. The world
+    used for the scan is freed as soon as the cache is written.
+  */
+
+  util::debug("lv2 world: scanning the installed plugins");
+
+  discovery_world = lilv_world_new();
+
+  if (discovery_world == nullptr) {
+    return;
+  }
+
+  lilv_world_load_all(discovery_world);
+
+  const auto* plugins = lilv_world_get_all_plugins(discovery_world);
+
+  LILV_FOREACH(plugins, i, plugins) {
+    auto info = read_plugin_info(lilv_plugins_get(plugins, i));
+
+    cache[info.uri] = info;
+  }
+
+  missing_plugins.clear();
+
+  save_cache();
+
+  lilv_world_free(discovery_world);
+
+  discovery_world = nullptr;
+}
+
+auto World::get_plugin(const std::string& uri) -> const LilvPlugin* {
+  if (world == nullptr) {
+    return nullptr;
+  }
+
+  const auto it = cache.find(uri);
+
+  if (it == cache.end()) {
+    return nullptr;
+  }
+
+  // Only the bundle containing the plugin is parsed
+
+  if (!loaded_bundles.contains(it->second.bundle_uri)) {
+    auto* const bundle_node = lilv_new_uri(world, it->second.bundle_uri.c_str());
+
+    lilv_world_load_bundle(world, bundle_node);
+
+    lilv_node_free(bundle_node);
+
+    loaded_bundles.insert(it->second.bundle_uri);
+  }
+
+  auto* const uri_node = lilv_new_uri(world, uri.c_str());
+
+  if (uri_node == nullptr) {
+    return nullptr;
+  }
+
+  const auto* plugin = lilv_plugins_get_by_uri(lilv_world_get_all_plugins(world), uri_node);
+
+  lilv_node_free(uri_node);
+
+  return plugin;
+}
+
+auto World::read_plugin_info(const LilvPlugin* plugin) -> PluginInfo {
+  PluginInfo info;
+
+  info.uri = lilv_node_as_uri(lilv_plugin_get_uri(plugin));
+  info.bundle_uri = lilv_node_as_uri(lilv_plugin_get_bundle_uri(plugin));
+  info.bundle_mtime = get_bundle_mtime(info.bundle_uri);
+
+  if (LilvNodes* required_features = lilv_plugin_get_required_features(plugin); required_features != nullptr) {
+    LILV_FOREACH(nodes, i, required_features) {
+      info.required_features.emplace_back(lilv_node_as_uri(lilv_nodes_get(required_features, i)));
+    }
+
+    lilv_nodes_free(required_features);
+  }
+
+  const auto n_ports = lilv_plugin_get_num_ports(plugin);
+
+  info.ports.resize(n_ports);
+
+  // Get min, max and default values for all ports
+
+  std::vector<float> values(n_ports);
+  std::vector<float> minimum(n_ports);
+  std::vector<float> maximum(n_ports);
+
+  lilv_plugin_get_port_ranges_float(plugin, minimum.data(), maximum.data(), values.data());
+
+  LilvNode* lv2_InputPort = lilv_new_uri(discovery_world, LV2_CORE__InputPort);
+  LilvNode* lv2_OutputPort = lilv_new_uri(discovery_world, LV2_CORE__OutputPort);
+  LilvNode* lv2_AudioPort = lilv_new_uri(discovery_world, LV2_CORE__AudioPort);
+  LilvNode* lv2_ControlPort = lilv_new_uri(discovery_world, LV2_CORE__ControlPort);
+  LilvNode* lv2_AtomPort = lilv_new_uri(discovery_world, LV2_ATOM__AtomPort);
+  LilvNode* lv2_connectionOptional = lilv_new_uri(discovery_world, LV2_CORE__connectionOptional);
+  LilvNode* lv2_toggled = lilv_new_uri(discovery_world, LV2_CORE__toggled);
+  LilvNode* lv2_integer = lilv_new_uri(discovery_world, LV2_CORE__integer);
+  LilvNode* lv2_enumeration = lilv_new_uri(discovery_world, LV2_CORE__enumeration);
+  LilvNode* lv2_reportsLatency = lilv_new_uri(discovery_world, LV2_CORE__reportsLatency);
+
+  for (uint n = 0U; n < n_ports; n++) {
+    auto* port = &info.ports[n];
+
+    const auto* lilv_port = lilv_plugin_get_port_by_index(plugin, n);
+
+    auto* port_name = lilv_port_get_name(plugin, lilv_port);
+
+    port->index = n;
+    port->name = lilv_node_as_string(port_name);
+    port->symbol = lilv_node_as_string(lilv_port_get_symbol(plugin, lilv_port));
+    port->optional = lilv_port_has_property(plugin, lilv_port, lv2_connectionOptional);
+    port->is_discrete = lilv_port_has_property(plugin, lilv_port, lv2_toggled) ||
+                        lilv_port_has_property(plugin, lilv_port, lv2_integer) ||
+                        lilv_port_has_property(plugin, lilv_port, lv2_enumeration);
+    port->reports_latency = lilv_port_has_property(plugin, lilv_port, lv2_reportsLatency);
+    port->is_input = false;
+
+    // Save port default value
+    if (!std::isnan(values[n])) {
+      port->value = values[n];
+    }
+    // Save minimum and maximum values
+    if (!std::isnan(minimum[n])) {
+      port->min = minimum[n];
+    }
+    if (!std::isnan(maximum[n])) {
+      port->max = maximum[n];
+    }
+
+    if (lilv_port_is_a(plugin, lilv_port, lv2_InputPort)) {
+      port->is_input = true;
+    } else if (!lilv_port_is_a(plugin, lilv_port, lv2_OutputPort) && !port->optional) {
+      util::warning("Port " + port->name + " is neither input nor output!");
+    }
+
+    if (lilv_port_is_a(plugin, lilv_port, lv2_ControlPort)) {
+      port->type = TYPE_CONTROL;
+    } else if (lilv_port_is_a(plugin, lilv_port, lv2_AtomPort)) {
+      port->type = TYPE_ATOM;
+    } else if (lilv_port_is_a(plugin, lilv_port, lv2_AudioPort)) {
+      port->type = TYPE_AUDIO;
+    } else {
+      port->type = TYPE_UNSUPPORTED;
+
+      if (!port->optional) {
+        util::warning("Port " + port->name + " has un unsupported type!");
+      }
+    }
+
+    lilv_node_free(port_name);
+  }
+
+  lilv_node_free(lv2_reportsLatency);
+  lilv_node_free(lv2_enumeration);
+  lilv_node_free(lv2_integer);
+  lilv_node_free(lv2_toggled);
+  lilv_node_free(lv2_connectionOptional);
+  lilv_node_free(lv2_ControlPort);
+  lilv_node_free(lv2_AtomPort);
+  lilv_node_free(lv2_AudioPort);
+  lilv_node_free(lv2_OutputPort);
+  lilv_node_free(lv2_InputPort);
+
+  return info;
+}
+
+auto World::get_bundle_mtime(const std::string& bundle_uri) -> int64_t {
+  /*
+    Package updates replace the files inside the bundle, which changes the modification time of its directory. The
+    manifest is checked as well to catch in place edits.
+  */
+
+  auto* path = lilv_file_uri_parse(bundle_uri.c_str(), nullptr);
+
+  if (path == nullptr) {
+    return 0;
+  }
+
+  const std::filesystem::path bundle_path{path};
+
+  lilv_free(path);
+
+  int64_t mtime = 0;
+
+  for (const auto& file : {bundle_path, bundle_path / "manifest.ttl"}) {
+    std::error_code ec;
+
+    const auto t = std::filesystem::last_write_time(file, ec);
+
+    if (!ec) {
+      mtime = std::max(mtime, static_cast<int64_t>(t.time_since_epoch().count()));
+    }
+  }
+
+  return mtime;
+}
+
+void World::load_cache() {
+  if (!std::filesystem::is_regular_file(cache_file)) {
+    return;
+  }
+
+  try {
+    nlohmann::json json;
+
+    std::ifstream is(cache_file);
+
+    is >> json;
+
+    if (json.value("version", 0) != cache_version) {
+      return;
+    }
+
+    for (const auto& [uri, value] : json.at("plugins").items()) {
+      PluginInfo info;
+
+      info.uri = uri;
+      info.bundle_uri = value.at("bundle-uri").get<std::string>();
+      info.bundle_mtime = value.at("bundle-mtime").get<int64_t>();
+      info.required_features = value.at("required-features").get<std::vector<std::string>>();
+
+      for (const auto& p : value.at("ports")) {
+        Port port;
+
+        port.index = p.at("index").get<uint>();
+        port.type = static_cast<PortType>(p.at("type").get<int>());
+        port.name = p.at("name").get<std::string>();
+        port.symbol = p.at("symbol").get<std::string>();
+        port.value = json_to_float(p.at("default"), port.value);
+        port.min = json_to_float(p.at("min"), port.min);
+        port.max = json_to_float(p.at("max"), port.max);
+        port.is_input = p.at("input").get<bool>();
+        port.optional = p.at("optional").get<bool>();
+        port.is_discrete = p.at("discrete").get<bool>();
+        port.reports_latency = p.at("reports-latency").get<bool>();
+
+        info.ports.push_back(port);
+      }
+
+      cache[uri] = info;
+    }
+  } catch (const std::exception& e) {
+    util::warning("lv2 world: ignoring the plugins cache " + cache_file + ": " + e.what());
+
+    cache.clear();
+  }
+}
+
+void World::save_cache() const {
+  nlohmann::json json;
+
+  json["version"] = cache_version;
+  json["plugins"] = nlohmann::json::object();
+
+  for (const auto& [uri, info] : cache) {
+    auto& value = json["plugins"][uri];
+
+    value["bundle-uri"] = info.bundle_uri;
+    value["bundle-mtime"] = info.bundle_mtime;
+    value["required-features"] = info.required_features;
+    value["ports"] = nlohmann::json::array();
+
+    for (const auto& port : info.ports) {
+      value["ports"].push_back({{"index", port.index},
+                                {"type", static_cast<int>(port.type)},
+                                {"name", port.name},
+                                {"symbol", port.symbol},
+                                {"default", float_to_json(port.value)},
+                                {"min", float_to_json(port.min)},
+                                {"max", float_to_json(port.max)},
+                                {"input", port.is_input},
+                                {"optional", port.optional},
+                                {"discrete", port.is_discrete},
+                                {"reports-latency", port.reports_latency}});
+    }
+  }
+
+  std::error_code ec;
+
+  std::filesystem::create_directories(std::filesystem::path{cache_file}.parent_path(), ec);
+
+  // Writing to a temporary file first so a crash can not leave a truncated cache behind
+
+  const auto tmp_file = cache_file + ".tmp";
+
+  {
+    std::ofstream o(tmp_file);
+
+    o << std::setw(2) << json << '\n';
+  }
+
+  std::filesystem::rename(tmp_file, cache_file, ec);
+
+  if (ec) {
+    util::warning("lv2 world: could not save the plugins cache " + cache_file + ": " + ec.message());
+  }
+}
+
+}  // namespace lv2
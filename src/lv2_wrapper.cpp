@@ -28,21 +28,27 @@
 #include <lv2/lv2plug.in/ns/ext/log/log.h>
 #include <lv2/options/options.h>
 #include <lv2/parameters/parameters.h>
+#include <lv2/state/state.h>
 #include <lv2/ui/ui.h>
 #include <lv2/urid/urid.h>
+#include <lv2/worker/worker.h>
 #include <sys/types.h>
+#include <algorithm>
 #include <array>
-#include <chrono>
+#include <atomic>
 #include <cmath>
 #include <cstdarg>
 #include <cstdint>
 #include <cstdio>
 #include <functional>
+#include <limits>
 #include <mutex>
 #include <span>
 #include <string>
-#include <thread>
 #include <vector>
+#include "lv2_ui_scheduler.hpp"
+#include "lv2_worker.hpp"
+#include "lv2_world.hpp"
 #include "util.hpp"
 
 namespace lv2 {
@@ -62,185 +68,238 @@ auto lv2_printf(LV2_Log_Handle handle, LV2_URID type, const char* format, ...) -
   return r;
 }
 
-Lv2Wrapper::Lv2Wrapper(const std::string& plugin_uri) : plugin_uri(plugin_uri), world(lilv_world_new()) {
-  if (world == nullptr) {
-    util::warning("failed to initialized the world");
+Lv2Wrapper::Lv2Wrapper(const std::string& plugin_uri) : plugin_uri(plugin_uri) {
+  const auto info = World::get().get_plugin_info(plugin_uri);
+
+  if (!info.has_value()) {
+    util::warning("Could not find the plugin: " + plugin_uri);
 
     return;
   }
 
-  auto* const uri = lilv_new_uri(world, plugin_uri.c_str());
+  check_required_features(info->required_features);
 
-  if (uri == nullptr) {
-    util::warning("Invalid plugin URI: " + plugin_uri);
+  create_ports(info->ports);
 
-    return;
+  found_plugin = load_descriptor();
+}
+
+Lv2Wrapper::~Lv2Wrapper() {
+  if (controls_settings != nullptr) {
+    g_signal_handler_disconnect(controls_settings, controls_handler_id);
+
+    g_object_unref(controls_settings);
   }
 
-  lilv_world_load_all(world);
+  if (ui_scheduled) {
+    close_ui();
+  }
 
-  const LilvPlugins* plugins = lilv_world_get_all_plugins(world);
+  if (worker_iface != nullptr) {
+    Worker::get().remove(this);
+  }
 
-  plugin = lilv_plugins_get_by_uri(plugins, uri);
+  free_instance();
 
-  lilv_node_free(uri);
+  if (plugin_library != nullptr) {
+    dlclose(plugin_library);
+  }
+}
 
-  if (plugin == nullptr) {
-    util::warning("Could not find the plugin: " + plugin_uri);
+auto Lv2Wrapper::load_descriptor() -> bool {
+  /*
+    Everything lilv has to do for the instantiation is done here, on the main thread. create_instance() is called by
+    setup() in the realtime thread and it only talks to the plugin descriptor, so it never waits for the world lock.
+  */
 
-    return;
+  std::string library_path;
+
+  {
+    auto& world = World::get();
+
+    const auto world_lock = world.lock();
+
+    plugin = world.get_plugin(plugin_uri);
+
+    if (plugin == nullptr) {
+      util::warning("Could not load the plugin: " + plugin_uri);
+
+      return false;
+    }
+
+    for (auto [node, path] : {std::make_pair(lilv_plugin_get_bundle_uri(plugin), &bundle_path),
+                              std::make_pair(lilv_plugin_get_library_uri(plugin), &library_path)}) {
+      if (auto* file_path = lilv_file_uri_parse(lilv_node_as_uri(node), nullptr); file_path != nullptr) {
+        *path = file_path;
+
+        lilv_free(file_path);
+      }
+    }
   }
 
-  found_plugin = true;
+  plugin_library = dlopen(library_path.c_str(), RTLD_NOW);
 
-  check_required_features();
+  if (plugin_library == nullptr) {
+    util::warning("Could not open the library of " + plugin_uri + ": " + dlerror());
 
-  create_ports();
-}
+    return false;
+  }
 
-Lv2Wrapper::~Lv2Wrapper() {
-  if (instance != nullptr) {
-    lilv_instance_deactivate(instance);
-    lilv_instance_free(instance);
+  auto descriptor_function = reinterpret_cast<LV2_Descriptor_Function>(dlsym(plugin_library, "lv2_descriptor"));
+
+  if (descriptor_function == nullptr) {
+    util::warning(library_path + " has no lv2_descriptor function");
 
-    instance = nullptr;
+    return false;
   }
 
-  if (world != nullptr) {
-    lilv_world_free(world);
+  for (uint32_t n = 0U; (descriptor = descriptor_function(n)) != nullptr; n++) {
+    if (plugin_uri != descriptor->URI) {
+      continue;
+    }
+
+    /*
+      Extension data does not depend on the instance. Knowing now if the plugin needs the worker lets us register with
+      it here and unregister in the destructor, both on the main thread.
+    */
+
+    if (descriptor->extension_data != nullptr) {
+      worker_iface = static_cast<const LV2_Worker_Interface*>(descriptor->extension_data(LV2_WORKER__interface));
+    }
+
+    if (worker_iface != nullptr) {
+      Worker::get().add(this);
+    }
+
+    return true;
   }
+
+  util::warning(library_path + " does not provide " + plugin_uri);
+
+  return false;
 }
 
-void Lv2Wrapper::check_required_features() {
-  LilvNodes* required_features = lilv_plugin_get_required_features(plugin);
+void Lv2Wrapper::free_instance() {
+  if (instance == nullptr) {
+    return;
+  }
+
+  /*
+    This may run in the realtime thread, so it must not wait for the worker. The worker thread is told the instance is
+    going away. If a work() call may still be using it the handle is retired, and the worker releases it once that call
+    returns. Otherwise we take it back and release it here.
+  */
+
+  work_handle.store(nullptr);
+
+  auto* handle = instance->lv2_handle;
+
+  state_iface = nullptr;
+
+  instance = nullptr;
 
-  if (required_features != nullptr) {
-    for (auto* i = lilv_nodes_begin(required_features); !lilv_nodes_is_end(required_features, i);
-         i = lilv_nodes_next(required_features, i)) {
-      const LilvNode* required_feature = lilv_nodes_get(required_features, i);
+  data_buffers = {};  // a new instance has nothing connected
 
-      const char* required_feature_uri = lilv_node_as_uri(required_feature);
+  // A handle still retired means the worker is busy with that one and never saw this one, so it can go right away
 
-      util::debug(plugin_uri + " requires feature: " + required_feature_uri);
+  if (worker_iface != nullptr && retired_handle.load() == nullptr) {
+    retired_handle.store(handle);
+
+    if (work_running.load()) {
+      return;
     }
 
-    lilv_nodes_free(required_features);
+    handle = retired_handle.exchange(nullptr);
   }
+
+  release_handle(handle);
 }
 
-void Lv2Wrapper::create_ports() {
-  n_ports = lilv_plugin_get_num_ports(plugin);
+void Lv2Wrapper::release_handle(LV2_Handle handle) {
+  if (handle == nullptr) {
+    return;
+  }
 
-  ports.resize(n_ports);
+  // Only the handle is left at this point, and the instance was not created by lilv, so its functions can not be used
 
-  // Get min, max and default values for all ports
+  if (descriptor->deactivate != nullptr) {
+    descriptor->deactivate(handle);
+  }
 
-  std::vector<float> values(n_ports);
-  std::vector<float> minimum(n_ports);
-  std::vector<float> maximum(n_ports);
+  descriptor->cleanup(handle);
+}
 
-  lilv_plugin_get_port_ranges_float(plugin, minimum.data(), maximum.data(), values.data());
+void Lv2Wrapper::check_required_features(const std::vector<std::string>& required_features) {
+  for (const auto& required_feature_uri : required_features) {
+    util::debug(plugin_uri + " requires feature: " + required_feature_uri);
+  }
+}
 
-  LilvNode* lv2_InputPort = lilv_new_uri(world, LV2_CORE__InputPort);
-  LilvNode* lv2_OutputPort = lilv_new_uri(world, LV2_CORE__OutputPort);
-  LilvNode* lv2_AudioPort = lilv_new_uri(world, LV2_CORE__AudioPort);
-  LilvNode* lv2_ControlPort = lilv_new_uri(world, LV2_CORE__ControlPort);
-  LilvNode* lv2_AtomPort = lilv_new_uri(world, LV2_ATOM__AtomPort);
-  LilvNode* lv2_connectionOptional = lilv_new_uri(world, LV2_CORE__connectionOptional);
+void Lv2Wrapper::create_ports(const std::vector<Port>& plugin_ports) {
+  ports = plugin_ports;
 
-  data_ports.in.left = data_ports.in.right = UINT_MAX;
-  data_ports.probe.left = data_ports.probe.right = UINT_MAX;
-  data_ports.out.left = data_ports.out.right = UINT_MAX;
+  n_ports = static_cast<uint>(ports.size());
 
-  for (uint n = 0U; n < n_ports; n++) {
-    auto* port = &ports[n];
+  staged_values = std::vector<std::atomic<float>>(n_ports);
 
-    const auto* lilv_port = lilv_plugin_get_port_by_index(plugin, n);
+  ramp_ports.resize(n_ports);
+  ramp_start.resize(n_ports);
+  ramp_end.resize(n_ports);
 
-    auto* port_name = lilv_port_get_name(plugin, lilv_port);
+  ui_sent_values.resize(n_ports, std::numeric_limits<float>::quiet_NaN());
 
-    port->index = n;
-    port->name = lilv_node_as_string(port_name);
-    port->symbol = lilv_node_as_string(lilv_port_get_symbol(plugin, lilv_port));
-    port->optional = lilv_port_has_property(plugin, lilv_port, lv2_connectionOptional);
+  default_values.resize(n_ports);
 
-    // Save port default value
-    if (!std::isnan(values[n])) {
-      port->value = values[n];
-    }
-    // Save minimum and maximum values
-    if (!std::isnan(minimum[n])) {
-      port->min = minimum[n];
-    }
-    if (!std::isnan(maximum[n])) {
-      port->max = maximum[n];
-    }
+  for (const auto& port : ports) {
+    staged_values[port.index].store(port.value, std::memory_order_relaxed);
 
-    // util::warning("port name: " + port->name);
-    // util::warning("port symbol: " + port->symbol);
+    default_values[port.index] = port.value;
+  }
+
+  data_ports.in.left = data_ports.in.right = UINT_MAX;
+  data_ports.probe.left = data_ports.probe.right = UINT_MAX;
+  data_ports.out.left = data_ports.out.right = UINT_MAX;
 
-    if (lilv_port_is_a(plugin, lilv_port, lv2_InputPort)) {
-      port->is_input = true;
-    } else if (!lilv_port_is_a(plugin, lilv_port, lv2_OutputPort) && !port->optional) {
-      util::warning("Port " + port->name + " is neither input nor output!");
+  for (const auto& port : ports) {
+    if (port.type == TYPE_CONTROL) {
+      control_port_indices[port.symbol] = port.index;
     }
 
-    if (lilv_port_is_a(plugin, lilv_port, lv2_ControlPort)) {
-      port->type = TYPE_CONTROL;
-    } else if (lilv_port_is_a(plugin, lilv_port, lv2_AtomPort)) {
-      port->type = TYPE_ATOM;
-
-      // util::warning("port name: " + port->name);
-    } else if (lilv_port_is_a(plugin, lilv_port, lv2_AudioPort)) {
-      port->type = TYPE_AUDIO;
-
-      if (port->is_input) {
-        if (n_audio_in == 0)
-          data_ports.in.left = port->index;
-        else if (n_audio_in == 1)
-          data_ports.in.right = port->index;
-        else if (n_audio_in == 2)
-          data_ports.probe.left = port->index;
-        else if (n_audio_in == 3)
-          data_ports.probe.right = port->index;
-
-        n_audio_in++;
-      } else {
-        if (n_audio_out == 0)
-          data_ports.out.left = port->index;
-        else if (n_audio_out == 1)
-          data_ports.out.right = port->index;
-
-        n_audio_out++;
-      }
-    } else if (!port->optional) {
-      util::warning("Port " + port->name + " has un unsupported type!");
+    if (port.type != TYPE_AUDIO) {
+      continue;
     }
 
-    lilv_node_free(port_name);
+    if (port.is_input) {
+      if (n_audio_in == 0)
+        data_ports.in.left = port.index;
+      else if (n_audio_in == 1)
+        data_ports.in.right = port.index;
+      else if (n_audio_in == 2)
+        data_ports.probe.left = port.index;
+      else if (n_audio_in == 3)
+        data_ports.probe.right = port.index;
+
+      n_audio_in++;
+    } else {
+      if (n_audio_out == 0)
+        data_ports.out.left = port.index;
+      else if (n_audio_out == 1)
+        data_ports.out.right = port.index;
+
+      n_audio_out++;
+    }
   }
 
   // util::warning("n audio_in ports: " + util::to_string(n_audio_in));
   // util::warning("n audio_out ports: " + util::to_string(n_audio_out));
-
-  lilv_node_free(lv2_connectionOptional);
-  lilv_node_free(lv2_ControlPort);
-  lilv_node_free(lv2_AtomPort);
-  lilv_node_free(lv2_AudioPort);
-  lilv_node_free(lv2_OutputPort);
-  lilv_node_free(lv2_InputPort);
 }
 
 auto Lv2Wrapper::create_instance(const uint& rate) -> bool {
   this->rate = rate;
 
-  if (instance != nullptr) {
-    deactivate();
-
-    lilv_instance_free(instance);
+  const auto carry_state = save_state();
 
-    instance = nullptr;
-  }
+  free_instance();
 
   LV2_Log_Log lv2_log = {this, &lv2_printf, [](LV2_Log_Handle handle, LV2_URID type, const char* fmt, va_list ap) {
                            return std::vprintf(fmt, ap);
@@ -255,7 +314,7 @@ auto Lv2Wrapper::create_instance(const uint& rate) -> bool {
   LV2_URID_Unmap lv2_unmap = {this, [](LV2_URID_Unmap_Handle handle, LV2_URID urid) {
                                 auto* lw = static_cast<Lv2Wrapper*>(handle);
 
-                                return lw->map_urid_to_uri[urid].c_str();
+                                return lw->unmap_urid(urid);
                               }};
 
   const LV2_Feature lv2_log_feature = {LV2_LOG__log, &lv2_log};
@@ -264,6 +323,20 @@ auto Lv2Wrapper::create_instance(const uint& rate) -> bool {
 
   const LV2_Feature lv2_unmap_feature = {LV2_URID__unmap, &lv2_unmap};
 
+  worker_schedule = {this, [](LV2_Worker_Schedule_Handle handle, uint32_t size, const void* data) {
+                       auto* lw = static_cast<Lv2Wrapper*>(handle);
+
+                       if (!lw->work_requests.write(size, data)) {
+                         return LV2_WORKER_ERR_NO_SPACE;
+                       }
+
+                       Worker::get().wake_up();
+
+                       return LV2_WORKER_SUCCESS;
+                     }};
+
+  const LV2_Feature lv2_worker_feature = {LV2_WORKER__schedule, &worker_schedule};
+
   auto options = std::to_array<LV2_Options_Option>(
       {{LV2_OPTIONS_INSTANCE, 0, map_urid(LV2_PARAMETERS__sampleRate), sizeof(float), map_urid(LV2_ATOM__Float), &rate},
        {LV2_OPTIONS_INSTANCE, 0, map_urid(LV2_BUF_SIZE__minBlockLength), sizeof(int32_t), map_urid(LV2_ATOM__Int),
@@ -277,18 +350,49 @@ auto Lv2Wrapper::create_instance(const uint& rate) -> bool {
   LV2_Feature feature_options = {.URI = LV2_OPTIONS__options, .data = options.data()};
 
   const auto features = std::to_array<const LV2_Feature*>(
-      {&lv2_log_feature, &lv2_map_feature, &lv2_unmap_feature, &feature_options, static_features.data(), nullptr});
+      {&lv2_log_feature, &lv2_map_feature, &lv2_unmap_feature, &lv2_worker_feature, &feature_options,
+       static_features.data(), nullptr});
 
-  instance = lilv_plugin_instantiate(plugin, rate, features.data());
+  if (descriptor == nullptr) {
+    util::warning("Could not load the plugin: " + plugin_uri);
 
-  if (instance == nullptr) {
+    return false;
+  }
+
+  auto* handle = descriptor->instantiate(descriptor, rate, bundle_path.c_str(), features.data());
+
+  if (handle == nullptr) {
     util::warning("failed to instantiate " + plugin_uri);
 
     return false;
   }
 
+  instance_data = {.lv2_descriptor = descriptor, .lv2_handle = handle, .pimpl = nullptr};
+
+  instance = &instance_data;
+
+  // Like lilv does, nothing is connected until we say so
+
+  for (uint n = 0U; n < n_ports; n++) {
+    descriptor->connect_port(handle, n, nullptr);
+  }
+
+  if (worker_iface != nullptr) {
+    work_requests.reset();
+    work_responses.reset();
+
+    work_handle.store(handle);
+  }
+
+  state_iface =
+      static_cast<const LV2_State_Interface*>(lilv_instance_get_extension_data(instance, LV2_STATE__interface));
+
   connect_control_ports();
 
+  if (carry_state) {
+    restore_state();
+  }
+
   activate();
 
   return true;
@@ -297,6 +401,10 @@ auto Lv2Wrapper::create_instance(const uint& rate) -> bool {
 void Lv2Wrapper::connect_control_ports() {
   for (auto& p : ports) {
     if (p.type == PortType::TYPE_CONTROL) {
+      if (p.is_input) {
+        p.value = staged_values[p.index].load(std::memory_order_relaxed);
+      }
+
       lilv_instance_connect_port(instance, p.index, &p.value);
     }
   }
@@ -310,14 +418,16 @@ void Lv2Wrapper::connect_data_ports(std::span<float>& left_in,
     return;
   }
 
-  if (data_ports.in.left != UINT_MAX)
-    lilv_instance_connect_port(instance, data_ports.in.left, left_in.data());
-  if (data_ports.in.right != UINT_MAX)
-    lilv_instance_connect_port(instance, data_ports.in.right, right_in.data());
-  if (data_ports.out.left != UINT_MAX)
-    lilv_instance_connect_port(instance, data_ports.out.left, left_out.data());
-  if (data_ports.out.right != UINT_MAX)
-    lilv_instance_connect_port(instance, data_ports.out.right, right_out.data());
+  const std::array<float*, 6U> buffers{left_in.data(), right_in.data(), nullptr, nullptr, left_out.data(),
+                                       right_out.data()};
+
+  if (buffers == data_buffers) {
+    return;
+  }
+
+  data_buffers = buffers;
+
+  connect_data_buffers(0U);
 }
 
 void Lv2Wrapper::connect_data_ports(std::span<float>& left_in,
@@ -330,18 +440,31 @@ void Lv2Wrapper::connect_data_ports(std::span<float>& left_in,
     return;
   }
 
-  if (data_ports.in.left != UINT_MAX)
-    lilv_instance_connect_port(instance, data_ports.in.left, left_in.data());
-  if (data_ports.in.right != UINT_MAX)
-    lilv_instance_connect_port(instance, data_ports.in.right, right_in.data());
-  if (data_ports.probe.left != UINT_MAX)
-    lilv_instance_connect_port(instance, data_ports.probe.left, probe_left.data());
-  if (data_ports.probe.right != UINT_MAX)
-    lilv_instance_connect_port(instance, data_ports.probe.right, probe_right.data());
-  if (data_ports.out.left != UINT_MAX)
-    lilv_instance_connect_port(instance, data_ports.out.left, left_out.data());
-  if (data_ports.out.right != UINT_MAX)
-    lilv_instance_connect_port(instance, data_ports.out.right, right_out.data());
+  const std::array<float*, 6U> buffers{left_in.data(),    right_in.data(),  probe_left.data(),
+                                       probe_right.data(), left_out.data(), right_out.data()};
+
+  if (buffers == data_buffers) {
+    return;
+  }
+
+  data_buffers = buffers;
+
+  connect_data_buffers(0U);
+}
+
+void Lv2Wrapper::connect_data_buffers(const uint& offset) {
+  const auto connect = [&](const uint& port_index, float* buffer) {
+    if (port_index != UINT_MAX && buffer != nullptr) {
+      lilv_instance_connect_port(instance, port_index, buffer + offset);
+    }
+  };
+
+  connect(data_ports.in.left, data_buffers[0]);
+  connect(data_ports.in.right, data_buffers[1]);
+  connect(data_ports.probe.left, data_buffers[2]);
+  connect(data_ports.probe.right, data_buffers[3]);
+  connect(data_ports.out.left, data_buffers[4]);
+  connect(data_ports.out.right, data_buffers[5]);
 }
 
 void Lv2Wrapper::set_n_samples(const uint& value) {
@@ -360,98 +483,308 @@ void Lv2Wrapper::activate() {
   lilv_instance_activate(instance);
 }
 
-void Lv2Wrapper::run() const {
-  if (instance != nullptr) {
+void Lv2Wrapper::run() {
+  if (instance == nullptr) {
+    return;
+  }
+
+  commit_control_values();
+
+  if (n_ramps == 0U || n_samples < 2U * smoothing_block_size) {
+    for (uint n = 0U; n < n_ramps; n++) {
+      ports[ramp_ports[n]].value = ramp_end[n];
+    }
+
     lilv_instance_run(instance, n_samples);
+
+    deliver_work_responses();
+
+    return;
   }
-}
 
-void Lv2Wrapper::deactivate() {
-  lilv_instance_deactivate(instance);
+  const auto n_blocks = std::min(n_samples / smoothing_block_size, max_smoothing_blocks);
+  const auto block_size = n_samples / n_blocks;
+
+  for (uint b = 0U; b < n_blocks; b++) {
+    const auto offset = b * block_size;
+    const auto block_frames = (b + 1U == n_blocks) ? n_samples - offset : block_size;
+    const auto t = static_cast<float>(b + 1U) / static_cast<float>(n_blocks);
+
+    for (uint n = 0U; n < n_ramps; n++) {
+      ports[ramp_ports[n]].value = ramp_start[n] + t * (ramp_end[n] - ramp_start[n]);
+    }
+
+    if (b > 0U) {
+      connect_data_buffers(offset);
+    }
+
+    lilv_instance_run(instance, block_frames);
+  }
+
+  connect_data_buffers(0U);
+
+  deliver_work_responses();
 }
 
-void Lv2Wrapper::set_control_port_value(const std::string& symbol, const float& value) {
-  auto found = false;
+void Lv2Wrapper::process_work_requests() {
+  // See free_instance(). The order of these two atomic operations is what keeps the instance alive while we use it.
 
-  for (auto& p : ports) {
-    if (p.type == PortType::TYPE_CONTROL && p.symbol == symbol) {
-      if (!p.is_input) {
-        util::warning(plugin_uri + " port " + symbol + " is not an input!");
+  work_running.store(true);
 
-        return;
-      }
+  auto* plugin_handle = work_handle.load();
 
-      ui_port_event(p.index, value);
+  uint32_t size = 0U;
 
-      // Check port bounds
-      if (value < p.min) {
-        // util::warning(plugin_uri + ": value " + util::to_string(value) + " is out of minimum limit for port " +
-        //               p.symbol + " (" + p.name + ")");
+  while (plugin_handle != nullptr &&
+         work_requests.read(work_buffer.data(), static_cast<uint32_t>(work_buffer.size()), size)) {
+    worker_iface->work(
+        plugin_handle,
+        [](LV2_Worker_Respond_Handle handle, uint32_t size, const void* data) {
+          auto* lw = static_cast<Lv2Wrapper*>(handle);
 
-        p.value = p.min;
-      } else if (value > p.max) {
-        // util::warning(plugin_uri + ": value " + util::to_string(value) + " is out of maximum limit for port " +
-        //               p.symbol + " (" + p.name + ")");
+          return lw->work_responses.write(size, data) ? LV2_WORKER_SUCCESS : LV2_WORKER_ERR_NO_SPACE;
+        },
+        this, size, work_buffer.data());
+  }
 
-        p.value = p.max;
-      } else {
-        p.value = value;
-      }
+  work_running.store(false);
 
-      found = true;
+  // An instance replaced while work() was running is ours to release
 
-      break;
-    }
+  release_handle(retired_handle.exchange(nullptr));
+}
+
+void Lv2Wrapper::deliver_work_responses() {
+  if (worker_iface == nullptr) {
+    return;
   }
 
-  if (!found) {
-    util::warning(plugin_uri + " port symbol not found: " + symbol);
+  auto* handle = lilv_instance_get_handle(instance);
+
+  uint32_t size = 0U;
+
+  while (work_responses.read(response_buffer.data(), static_cast<uint32_t>(response_buffer.size()), size)) {
+    worker_iface->work_response(handle, size, response_buffer.data());
+  }
+
+  if (worker_iface->end_run != nullptr) {
+    worker_iface->end_run(handle);
   }
 }
-auto Lv2Wrapper::get_control_port_value(const std::string& symbol) -> float {
-  size_t hash = std::hash<std::string>{}(symbol);
 
-  for (const auto & slot : control_ports_cache) {
-    // We use hash == 0 to mean the cache slot and all following are empty.
-    // We might get collisions with hash == 0, which is fine.
-    if (slot.first == 0)
-      break;
+auto Lv2Wrapper::save_state() -> bool {
+  if (instance == nullptr || state_iface == nullptr || state_iface->save == nullptr) {
+    return false;
+  }
 
-    if (slot.first != hash)
-      continue;
+  saved_state.clear();
+
+  const std::array<const LV2_Feature*, 1U> state_features{nullptr};
+
+  const auto status = state_iface->save(
+      lilv_instance_get_handle(instance),
+      [](LV2_State_Handle handle, uint32_t key, const void* value, size_t size, uint32_t type, uint32_t flags) {
+        auto* lw = static_cast<Lv2Wrapper*>(handle);
+
+        // We only keep a copy of the bytes, so anything that is not plain old data can not be saved
+        if ((flags & LV2_STATE_IS_POD) == 0U) {
+          return LV2_STATE_ERR_BAD_FLAGS;
+        }
+
+        const auto* bytes = static_cast<const uint8_t*>(value);
 
-    // Ignore false positives.
-    const Port & p = ports[slot.second];
-    if (p.type == PortType::TYPE_CONTROL && p.symbol == symbol)
-      return p.value;
+        lw->saved_state.push_back(
+            {lw->unmap_urid(key), lw->unmap_urid(type), flags, std::vector<uint8_t>(bytes, bytes + size)});
+
+        return LV2_STATE_SUCCESS;
+      },
+      this, LV2_STATE_IS_POD, state_features.data());
+
+  if (status != LV2_STATE_SUCCESS) {
+    util::warning(plugin_uri + ": failed to save the plugin state");
+
+    saved_state.clear();
+
+    return false;
   }
 
-  for (const auto& p : ports) {
-    if (p.type == PortType::TYPE_CONTROL && p.symbol == symbol) {
-      // Add to cache.
-      for (size_t i = 0; i < control_ports_cache.size(); i++) {
-        if (control_ports_cache[i].first == 0) {
-          control_ports_cache[i] = std::pair<size_t, uint>(hash, p.index);
-          break;
+  return true;
+}
+
+auto Lv2Wrapper::restore_state() -> bool {
+  if (instance == nullptr || state_iface == nullptr || state_iface->restore == nullptr || saved_state.empty()) {
+    return false;
+  }
+
+  const std::array<const LV2_Feature*, 1U> state_features{nullptr};
+
+  const auto status = state_iface->restore(
+      lilv_instance_get_handle(instance),
+      [](LV2_State_Handle handle, uint32_t key, size_t* size, uint32_t* type, uint32_t* flags) -> const void* {
+        auto* lw = static_cast<Lv2Wrapper*>(handle);
+
+        for (const auto& property : lw->saved_state) {
+          if (lw->map_urid(property.key) == key) {
+            *size = property.value.size();
+            *type = lw->map_urid(property.type);
+            *flags = property.flags;
+
+            return property.value.data();
+          }
         }
-      }
 
-      return p.value;
+        return nullptr;
+      },
+      this, LV2_STATE_IS_POD, state_features.data());
+
+  if (status != LV2_STATE_SUCCESS) {
+    util::warning(plugin_uri + ": failed to restore the plugin state");
+
+    return false;
+  }
+
+  return true;
+}
+
+void Lv2Wrapper::commit_control_values() {
+  n_ramps = 0U;
+
+  if (!staged_values_dirty.exchange(false, std::memory_order_acquire)) {
+    return;
+  }
+
+  for (auto& p : ports) {
+    if (p.type != PortType::TYPE_CONTROL || !p.is_input) {
+      continue;
     }
+
+    const auto value = staged_values[p.index].load(std::memory_order_relaxed);
+
+    if (value == p.value) {
+      continue;
+    }
+
+    if (p.is_discrete || !std::isfinite(value) || !std::isfinite(p.value)) {
+      p.value = value;
+
+      continue;
+    }
+
+    ramp_ports[n_ramps] = p.index;
+    ramp_start[n_ramps] = p.value;
+    ramp_end[n_ramps] = value;
+
+    n_ramps++;
+  }
+}
+
+void Lv2Wrapper::deactivate() {
+  lilv_instance_deactivate(instance);
+}
+
+auto Lv2Wrapper::find_control_port(const std::string& symbol) const -> uint {
+  if (const auto it = control_port_indices.find(symbol); it != control_port_indices.end()) {
+    return it->second;
   }
 
   util::warning(plugin_uri + " port symbol not found: " + symbol);
 
-  return 0.0F;
+  return UINT_MAX;
+}
+
+void Lv2Wrapper::set_control_port_value(const uint& index, const float& value) {
+  if (index >= ports.size()) {
+    return;
+  }
+
+  const auto& p = ports[index];
+
+  if (!p.is_input) {
+    util::warning(plugin_uri + " port " + p.symbol + " is not an input!");
+
+    return;
+  }
+
+  ui_port_event(p.index, value);
+
+  // Check port bounds
+  if (value < p.min) {
+    // util::warning(plugin_uri + ": value " + util::to_string(value) + " is out of minimum limit for port " +
+    //               p.symbol + " (" + p.name + ")");
+
+    stage_control_value(index, p.min);
+  } else if (value > p.max) {
+    // util::warning(plugin_uri + ": value " + util::to_string(value) + " is out of maximum limit for port " +
+    //               p.symbol + " (" + p.name + ")");
+
+    stage_control_value(index, p.max);
+  } else {
+    stage_control_value(index, value);
+  }
+}
+
+void Lv2Wrapper::stage_control_value(const uint& index, const float& value) {
+  staged_values[index].store(value, std::memory_order_relaxed);
+
+  staged_values_dirty.store(true, std::memory_order_release);
+}
+
+auto Lv2Wrapper::get_control_port_value(const uint& index) const -> float {
+  if (index >= ports.size()) {
+    return 0.0F;
+  }
+
+  const auto& p = ports[index];
+
+  return (p.type == PortType::TYPE_CONTROL && p.is_input) ? staged_values[index].load(std::memory_order_relaxed)
+                                                          : p.value;
+}
+
+auto Lv2Wrapper::get_default_control_port_value(const uint& index) const -> float {
+  return (index < default_values.size()) ? default_values[index] : 0.0F;
+}
+
+void Lv2Wrapper::set_control_port_value(const std::string& symbol, const float& value) {
+  set_control_port_value(find_control_port(symbol), value);
+}
+
+auto Lv2Wrapper::get_control_port_value(const std::string& symbol) -> float {
+  return get_control_port_value(find_control_port(symbol));
 }
 
 auto Lv2Wrapper::has_instance() -> bool {
   return instance != nullptr;
 }
 
+auto Lv2Wrapper::get_n_audio_in() const -> uint {
+  return n_audio_in;
+}
+
+auto Lv2Wrapper::get_n_audio_out() const -> uint {
+  return n_audio_out;
+}
+
+auto Lv2Wrapper::get_ports() const -> const std::vector<Port>& {
+  return ports;
+}
+
+auto Lv2Wrapper::get_latency_port() const -> uint {
+  for (const auto& p : ports) {
+    if (p.type == PortType::TYPE_CONTROL && !p.is_input && p.reports_latency) {
+      return p.index;
+    }
+  }
+
+  return UINT_MAX;
+}
+
 auto Lv2Wrapper::map_urid(const std::string& uri) -> LV2_URID {
-  if (map_uri_to_urid.contains(uri)) {
-    return map_uri_to_urid[uri];
+  // Plugins may map uris from the worker thread, so the maps are shared by several threads
+
+  std::scoped_lock<std::mutex> lock(urid_mutex);
+
+  if (const auto it = map_uri_to_urid.find(uri); it != map_uri_to_urid.end()) {
+    return it->second;
   }
 
   const auto hash = std::hash<std::string>{}(uri);
@@ -463,200 +796,222 @@ auto Lv2Wrapper::map_urid(const std::string& uri) -> LV2_URID {
   return static_cast<LV2_URID>(hash);
 }
 
+auto Lv2Wrapper::unmap_urid(const LV2_URID& urid) -> const char* {
+  std::scoped_lock<std::mutex> lock(urid_mutex);
+
+  const auto it = map_urid_to_uri.find(urid);
+
+  // Elements of an unordered_map do not move, so the pointer stays valid after the lock is released
+
+  return (it != map_urid_to_uri.end()) ? it->second.c_str() : nullptr;
+}
+
 void Lv2Wrapper::load_ui() {
-  // preparing the thread that loads the native ui and updates it over time
+  // The native ui is created and then updated by the thread of the shared scheduler
 
-  std::thread ui_updater([this]() {
-    {
-      std::scoped_lock<std::mutex> lku(ui_mutex);
+  ui_scheduled = true;
 
-      if (instance == nullptr) {
-        return;
-      }
+  UiScheduler::get().add(this);
+}
 
-      LilvUIs* uis = lilv_plugin_get_uis(plugin);
+void Lv2Wrapper::instantiate_ui() {
+  if (instance == nullptr || plugin == nullptr) {
+    return;
+  }
 
-      if (uis == nullptr) {
-        return;
-      }
+  {
+    const auto world_lock = World::get().lock();
 
-      /*
-        Code based on:
+    LilvUIs* uis = lilv_plugin_get_uis(plugin);
 
-        https://github.com/moddevices/mod-host/blob/f36bce78eed80f4f7194c923afd4dcae2c80bc79/src/effects.c#L8203
-        https://github.com/zrythm/zrythm/blob/1bc89335ca42b83ce759fd4cd0fd518e43b7983d/src/plugins/lv2/lv2_ui.c#L394
-      */
+    if (uis == nullptr) {
+      return;
+    }
 
-      LILV_FOREACH(uis, u, uis) {
-        const LilvUI* ui = lilv_uis_get(uis, u);
+    /*
+      Code based on:
 
-        std::string ui_uri = lilv_node_as_uri(lilv_ui_get_uri(ui));
+      https://github.com/moddevices/mod-host/blob/f36bce78eed80f4f7194c923afd4dcae2c80bc79/src/effects.c#L8203
+      https://github.com/zrythm/zrythm/blob/1bc89335ca42b83ce759fd4cd0fd518e43b7983d/src/plugins/lv2/lv2_ui.c#L394
+    */
 
-        util::debug(plugin_uri + " ui uri: " + ui_uri);
+    LILV_FOREACH(uis, u, uis) {
+      const LilvUI* ui = lilv_uis_get(uis, u);
 
-        const LilvNode* binary_node = lilv_ui_get_binary_uri(ui);
-        const LilvNode* bundle_node = lilv_ui_get_bundle_uri(ui);
+      std::string ui_uri = lilv_node_as_uri(lilv_ui_get_uri(ui));
 
-        {
-          auto path = lilv_file_uri_parse(lilv_node_as_uri(binary_node), nullptr);
+      util::debug(plugin_uri + " ui uri: " + ui_uri);
 
-          libhandle = dlopen(path, RTLD_NOW);
+      const LilvNode* binary_node = lilv_ui_get_binary_uri(ui);
+      const LilvNode* bundle_node = lilv_ui_get_bundle_uri(ui);
 
-          lilv_free(path);
-        }
+      {
+        auto path = lilv_file_uri_parse(lilv_node_as_uri(binary_node), nullptr);
 
-        if (libhandle == nullptr) {
-          continue;
-        }
+        libhandle = dlopen(path, RTLD_NOW);
 
-        auto descfn = reinterpret_cast<LV2UI_DescriptorFunction>(dlsym(libhandle, "lv2ui_descriptor"));
+        lilv_free(path);
+      }
 
-        if (descfn == nullptr) {
-          dlclose(libhandle);
+      if (libhandle == nullptr) {
+        continue;
+      }
 
-          continue;
-        }
+      auto descfn = reinterpret_cast<LV2UI_DescriptorFunction>(dlsym(libhandle, "lv2ui_descriptor"));
 
-        const LV2UI_Show_Interface* show_iface = nullptr;
+      if (descfn == nullptr) {
+        dlclose(libhandle);
 
-        uint32_t index = 0U;
+        continue;
+      }
 
-        while ((ui_descriptor = descfn(index++)) != nullptr) {
-          if (ui_descriptor->extension_data == nullptr || ui_descriptor->URI != ui_uri) {
-            continue;
-          }
+      const LV2UI_Show_Interface* show_iface = nullptr;
 
-          idle_iface = static_cast<const LV2UI_Idle_Interface*>(ui_descriptor->extension_data(LV2_UI__idleInterface));
-          show_iface = static_cast<const LV2UI_Show_Interface*>(ui_descriptor->extension_data(LV2_UI__showInterface));
+      uint32_t index = 0U;
 
-          if (idle_iface == nullptr) {
-            continue;
-          }
+      while ((ui_descriptor = descfn(index++)) != nullptr) {
+        if (ui_descriptor->extension_data == nullptr || ui_descriptor->URI != ui_uri) {
+          continue;
+        }
+
+        idle_iface = static_cast<const LV2UI_Idle_Interface*>(ui_descriptor->extension_data(LV2_UI__idleInterface));
+        show_iface = static_cast<const LV2UI_Show_Interface*>(ui_descriptor->extension_data(LV2_UI__showInterface));
+
+        if (idle_iface == nullptr) {
+          continue;
+        }
 
-          // initializing features
+        // initializing features
 
-          LV2_Log_Log lv2_log = {
-              this, &lv2_printf,
-              [](LV2_Log_Handle handle, LV2_URID type, const char* fmt, va_list ap) { return std::vprintf(fmt, ap); }};
+        LV2_Log_Log lv2_log = {
+            this, &lv2_printf,
+            [](LV2_Log_Handle handle, LV2_URID type, const char* fmt, va_list ap) { return std::vprintf(fmt, ap); }};
 
-          LV2_URID_Map lv2_map = {this, [](LV2_URID_Map_Handle handle, const char* uri) {
-                                    auto* lw = static_cast<Lv2Wrapper*>(handle);
+        LV2_URID_Map lv2_map = {this, [](LV2_URID_Map_Handle handle, const char* uri) {
+                                  auto* lw = static_cast<Lv2Wrapper*>(handle);
 
-                                    return lw->map_urid(uri);
-                                  }};
+                                  return lw->map_urid(uri);
+                                }};
 
-          LV2_URID_Unmap lv2_unmap = {this, [](LV2_URID_Unmap_Handle handle, LV2_URID urid) {
-                                        auto* lw = static_cast<Lv2Wrapper*>(handle);
+        LV2_URID_Unmap lv2_unmap = {this, [](LV2_URID_Unmap_Handle handle, LV2_URID urid) {
+                                      auto* lw = static_cast<Lv2Wrapper*>(handle);
 
-                                        return lw->map_urid_to_uri[urid].c_str();
-                                      }};
+                                      return lw->unmap_urid(urid);
+                                    }};
 
-          const LV2_Feature lv2_log_feature = {LV2_LOG__log, &lv2_log};
+        const LV2_Feature lv2_log_feature = {LV2_LOG__log, &lv2_log};
 
-          const LV2_Feature lv2_map_feature = {LV2_URID__map, &lv2_map};
+        const LV2_Feature lv2_map_feature = {LV2_URID__map, &lv2_map};
 
-          const LV2_Feature lv2_unmap_feature = {LV2_URID__unmap, &lv2_unmap};
+        const LV2_Feature lv2_unmap_feature = {LV2_URID__unmap, &lv2_unmap};
 
-          auto options =
-              std::to_array<LV2_Options_Option>({{LV2_OPTIONS_INSTANCE, 0, map_urid(LV2_PARAMETERS__sampleRate),
-                                                  sizeof(float), map_urid(LV2_ATOM__Float), &rate},
-                                                 {LV2_OPTIONS_INSTANCE, 0, map_urid(LV2_BUF_SIZE__minBlockLength),
-                                                  sizeof(int32_t), map_urid(LV2_ATOM__Int), &min_quantum},
-                                                 {LV2_OPTIONS_INSTANCE, 0, map_urid(LV2_BUF_SIZE__maxBlockLength),
-                                                  sizeof(int32_t), map_urid(LV2_ATOM__Int), &max_quantum},
-                                                 {LV2_OPTIONS_INSTANCE, 0, map_urid(LV2_BUF_SIZE__nominalBlockLength),
-                                                  sizeof(int32_t), map_urid(LV2_ATOM__Int), &n_samples},
-                                                 {LV2_OPTIONS_INSTANCE, 0, 0, 0, 0, nullptr}});
+        auto options =
+            std::to_array<LV2_Options_Option>({{LV2_OPTIONS_INSTANCE, 0, map_urid(LV2_PARAMETERS__sampleRate),
+                                                sizeof(float), map_urid(LV2_ATOM__Float), &rate},
+                                               {LV2_OPTIONS_INSTANCE, 0, map_urid(LV2_BUF_SIZE__minBlockLength),
+                                                sizeof(int32_t), map_urid(LV2_ATOM__Int), &min_quantum},
+                                               {LV2_OPTIONS_INSTANCE, 0, map_urid(LV2_BUF_SIZE__maxBlockLength),
+                                                sizeof(int32_t), map_urid(LV2_ATOM__Int), &max_quantum},
+                                               {LV2_OPTIONS_INSTANCE, 0, map_urid(LV2_BUF_SIZE__nominalBlockLength),
+                                                sizeof(int32_t), map_urid(LV2_ATOM__Int), &n_samples},
+                                               {LV2_OPTIONS_INSTANCE, 0, 0, 0, 0, nullptr}});
 
-          LV2_Feature feature_options = {.URI = LV2_OPTIONS__options, .data = options.data()};
+        LV2_Feature feature_options = {.URI = LV2_OPTIONS__options, .data = options.data()};
 
-          LV2_Extension_Data_Feature extension_data = {instance->lv2_descriptor->extension_data};
+        LV2_Extension_Data_Feature extension_data = {instance->lv2_descriptor->extension_data};
 
-          const LV2_Feature feature_dataAccess = {LV2_DATA_ACCESS_URI, &extension_data};
+        const LV2_Feature feature_dataAccess = {LV2_DATA_ACCESS_URI, &extension_data};
 
-          const LV2_Feature feature_instAccess = {LV2_INSTANCE_ACCESS_URI, instance->lv2_handle};
+        const LV2_Feature feature_instAccess = {LV2_INSTANCE_ACCESS_URI, instance->lv2_handle};
 
-          const LV2_Feature idle_feature = {LV2_UI__idleInterface, nullptr};
+        const LV2_Feature idle_feature = {LV2_UI__idleInterface, nullptr};
 
-          const LV2_Feature parent_feature = {LV2_UI__parent, nullptr};
+        const LV2_Feature parent_feature = {LV2_UI__parent, nullptr};
 
-          const LV2_Feature fixed_size_feature = {LV2_UI__fixedSize, nullptr};
+        const LV2_Feature fixed_size_feature = {LV2_UI__fixedSize, nullptr};
 
-          const LV2_Feature no_user_resize_feature = {LV2_UI__noUserResize, nullptr};
+        const LV2_Feature no_user_resize_feature = {LV2_UI__noUserResize, nullptr};
 
-          const LV2_Feature make_resident_feature = {LV2_UI_makeResident, nullptr};
+        const LV2_Feature make_resident_feature = {LV2_UI_makeResident, nullptr};
 
-          const LV2_Feature make_soname_resident_feature = {LV2_UI_makeSONameResident, nullptr};
+        const LV2_Feature make_soname_resident_feature = {LV2_UI_makeSONameResident, nullptr};
 
-          const auto features = std::to_array<const LV2_Feature*>(
-              {&lv2_log_feature, &lv2_map_feature, &lv2_unmap_feature, &feature_options, static_features.data(),
-               &feature_dataAccess, &feature_instAccess, &idle_feature, &parent_feature, &fixed_size_feature,
-               &no_user_resize_feature, &make_resident_feature, &make_soname_resident_feature, nullptr});
+        const auto features = std::to_array<const LV2_Feature*>(
+            {&lv2_log_feature, &lv2_map_feature, &lv2_unmap_feature, &feature_options, static_features.data(),
+             &feature_dataAccess, &feature_instAccess, &idle_feature, &parent_feature, &fixed_size_feature,
+             &no_user_resize_feature, &make_resident_feature, &make_soname_resident_feature, nullptr});
 
-          LV2UI_Widget widget = nullptr;
+        LV2UI_Widget widget = nullptr;
 
-          auto bundle_path = lilv_file_uri_parse(lilv_node_as_uri(bundle_node), nullptr);
+        auto bundle_path = lilv_file_uri_parse(lilv_node_as_uri(bundle_node), nullptr);
 
-          ui_handle = ui_descriptor->instantiate(
-              ui_descriptor, plugin_uri.c_str(), bundle_path,
-              +[](LV2UI_Controller controller, uint32_t port_index, uint32_t buffer_size, uint32_t port_protocol,
-                  const void* buffer) {
-                auto self = static_cast<Lv2Wrapper*>(controller);
+        ui_handle = ui_descriptor->instantiate(
+            ui_descriptor, plugin_uri.c_str(), bundle_path,
+            +[](LV2UI_Controller controller, uint32_t port_index, uint32_t buffer_size, uint32_t port_protocol,
+                const void* buffer) {
+              auto self = static_cast<Lv2Wrapper*>(controller);
 
-                for (auto& p : self->ports) {
-                  if (p.index == port_index) {
-                    // util::warning("The user clicked on port: " + p.name + " -> " + p.symbol);
+              for (auto& p : self->ports) {
+                if (p.index == port_index) {
+                  // util::warning("The user clicked on port: " + p.name + " -> " + p.symbol);
 
-                    if (port_protocol == 0) {  // port is a ui:floatProtocol
-                      p.value = *static_cast<const float*>(buffer);
-                    }
+                  if (port_protocol == 0) {  // port is a ui:floatProtocol
+                    self->stage_control_value(p.index, *static_cast<const float*>(buffer));
                   }
                 }
-              },
-              this, &widget, features.data());
+              }
+            },
+            this, &widget, features.data());
 
-          lilv_free(bundle_path);
+        lilv_free(bundle_path);
 
-          if (ui_handle == nullptr) {
-            continue;
-          }
+        if (ui_handle == nullptr) {
+          continue;
+        }
 
-          util::debug("found ui handle for" + ui_uri);
+        util::debug("found ui handle for" + ui_uri);
 
-          if (show_iface != nullptr) {
-            if (show_iface->show(ui_handle) != 0) {
-              util::warning("failed to show ui for " + ui_uri);
-            }
+        if (show_iface != nullptr) {
+          if (show_iface->show(ui_handle) != 0) {
+            util::warning("failed to show ui for " + ui_uri);
           }
-
-          break;
         }
-      }
 
-      lilv_uis_free(uis);
+        break;
+      }
     }
 
-    // initilizing the ui with the current control values
+    lilv_uis_free(uis);
+  }
 
-    for (const auto& p : ports) {
-      if (p.type == PortType::TYPE_CONTROL) {
-        ui_descriptor->port_event(ui_handle, p.index, sizeof(float), 0, &p.value);
-      }
-    }
+  // initilizing the ui with the current control values
 
-    while (has_ui()) {
-      {
-        std::scoped_lock<std::mutex> lk(ui_mutex);
+  if (ui_handle == nullptr) {
+    return;
+  }
 
-        notify_ui();
-        update_ui();
-      }
+  for (const auto& p : ports) {
+    if (p.type == PortType::TYPE_CONTROL) {
+      const auto value = get_control_port_value(p.index);
 
-      std::this_thread::sleep_for(std::chrono::milliseconds(static_cast<long>(1000.0 / ui_update_rate)));
+      ui_descriptor->port_event(ui_handle, p.index, sizeof(float), 0, &value);
+
+      ui_sent_values[p.index] = value;
     }
-  });
+  }
+}
+
+auto Lv2Wrapper::ui_tick() -> bool {
+  std::scoped_lock<std::mutex> lk(ui_mutex);
+
+  if (ui_handle == nullptr) {
+    instantiate_ui();
+  }
+
+  notify_ui();
+  update_ui();
 
-  ui_updater.detach();
+  return has_ui();
 }
 
 void Lv2Wrapper::notify_ui() {
@@ -668,9 +1023,13 @@ void Lv2Wrapper::notify_ui() {
     return;
   }
 
+  // Only the output ports whose value changed since the last tick are sent
+
   for (const auto& p : ports) {
-    if (p.type == PortType::TYPE_CONTROL && !p.is_input) {
+    if (p.type == PortType::TYPE_CONTROL && !p.is_input && p.value != ui_sent_values[p.index]) {
       ui_descriptor->port_event(ui_handle, p.index, sizeof(float), 0, &p.value);
+
+      ui_sent_values[p.index] = p.value;
     }
   }
 }
@@ -688,6 +1047,12 @@ auto Lv2Wrapper::has_ui() -> bool {
 }
 
 void Lv2Wrapper::close_ui() {
+  if (ui_scheduled) {
+    UiScheduler::get().remove(this);
+
+    ui_scheduled = false;
+  }
+
   std::scoped_lock<std::mutex> lk(ui_mutex);
 
   if (ui_descriptor != nullptr && ui_handle != nullptr) {
@@ -725,4 +1090,53 @@ void Lv2Wrapper::native_ui_to_gsettings() {
   }
 }
 
+void Lv2Wrapper::bind_key_controls(GSettings* settings, const std::string& gkey) {
+  // The plugin may release its settings before destroying the wrapper
+  controls_settings = static_cast<GSettings*>(g_object_ref(settings));
+  controls_gkey = gkey;
+
+  load_controls_from_gsettings();
+
+  controls_handler_id = g_signal_connect(settings, ("changed::" + gkey).c_str(),
+                                         G_CALLBACK(+[](GSettings* settings, char* key, gpointer user_data) {
+                                           static_cast<Lv2Wrapper*>(user_data)->load_controls_from_gsettings();
+                                         }),
+                                         this);
+
+  gsettings_sync_funcs.emplace_back([this]() {
+    GVariantBuilder builder;
+
+    g_variant_builder_init(&builder, G_VARIANT_TYPE("a{sd}"));
+
+    for (const auto& p : ports) {
+      if (p.type == PortType::TYPE_CONTROL && p.is_input) {
+        g_variant_builder_add(&builder, "{sd}", p.symbol.c_str(),
+                              static_cast<gdouble>(get_control_port_value(p.index)));
+      }
+    }
+
+    g_settings_set_value(controls_settings, controls_gkey.c_str(), g_variant_builder_end(&builder));
+  });
+}
+
+void Lv2Wrapper::load_controls_from_gsettings() {
+  auto* dict = g_settings_get_value(controls_settings, controls_gkey.c_str());
+
+  for (const auto& p : ports) {
+    if (p.type != PortType::TYPE_CONTROL || !p.is_input) {
+      continue;
+    }
+
+    gdouble value = 0.0;
+
+    if (g_variant_lookup(dict, p.symbol.c_str(), "d", &value) != 0) {
+      set_control_port_value(p.index, static_cast<float>(value));
+    } else {
+      set_control_port_value(p.index, default_values[p.index]);
+    }
+  }
+
+  g_variant_unref(dict);
+}
+
 }  // namespace lv2
@@ -49,6 +49,9 @@ Maximizer::Maximizer(const std::string& tag,
     util::debug(log_tag + "urn:zamaudio:ZaMaximX2 is not installed");
   }
 
+  latency_port = lv2_wrapper->port_ref<"lv2_latency">();
+  reduction_port = lv2_wrapper->port_ref<"gr">();
+
   lv2_wrapper->bind_key_double<"thresh", "threshold">(settings);
 
   lv2_wrapper->bind_key_double<"rel", "release">(settings);
@@ -115,7 +118,7 @@ void Maximizer::process(std::span<float>& left_in,
     This plugin gives the latency in number of samples
   */
 
-  const auto lv = static_cast<uint>(lv2_wrapper->get_control_port_value("lv2_latency"));
+  const auto lv = static_cast<uint>(lv2_wrapper->get_control_port_value(latency_port));
 
   if (latency_n_frames != lv) {
     latency_n_frames = lv;
@@ -141,9 +144,7 @@ void Maximizer::process(std::span<float>& left_in,
     if (send_notifications) {
       // reduction needed as double for levelbar widget ui, so we convert it here
 
-      reduction_port_value = static_cast<double>(lv2_wrapper->get_control_port_value("gr"));
-
-      reduction.emit(reduction_port_value);
+      reduction_port_value = static_cast<double>(lv2_wrapper->get_control_port_value(reduction_port));
 
       notify();
     }
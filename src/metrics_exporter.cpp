@@ -0,0 +1,292 @@
+/*
+ *  Copyright © 2017-2024 Wellington Wallace
+ *
+ *  This file is part of Easy Effects.
+ *
+ *  Easy Effects is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Easy Effects is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "metrics_exporter.hpp"
+#include <gio/gio.h>
+#include <gio/gunixsocketaddress.h>
+#include <glib-object.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+#define FMT_HEADER_ONLY
+#include <fmt/core.h>
+#include <array>
+#include <map>
+#include <memory>
+#include <string>
+#include <tuple>
+#include "effects_base.hpp"
+#include "pipe_manager.hpp"
+#include "plugin_base.hpp"
+#include "tags_app.hpp"
+#include "util.hpp"
+
+namespace {
+
+auto on_incoming(GSocketService* service, GSocketConnection* connection, GObject* source_object, gpointer user_data)
+    -> gboolean {
+  auto* self = static_cast<MetricsExporter*>(user_data);
+
+  const auto report = self->build_report();
+
+  auto* stream = g_io_stream_get_output_stream(G_IO_STREAM(connection));
+
+  GError* error = nullptr;
+
+  if (g_output_stream_write_all(stream, report.data(), report.size(), nullptr, nullptr, &error) == 0) {
+    util::warning(std::string("metrics_exporter: could not send the report: ") + error->message);
+
+    g_error_free(error);
+  }
+
+  g_io_stream_close(G_IO_STREAM(connection), nullptr, nullptr);
+
+  return 1;
+}
+
+void append_metric_header(std::string& report,
+                          const std::string& name,
+                          const std::string& type,
+                          const std::string& help) {
+  report += "# HELP " + name + " " + help + "\n";
+  report += "# TYPE " + name + " " + type + "\n";
+}
+
+}  // namespace
+
+MetricsExporter::MetricsExporter(PipeManager* pipe_manager, EffectsBase* soe, EffectsBase* sie)
+    : socket_path(std::string(g_get_user_runtime_dir()) + "/" + tags::app::metrics_socket_name),
+      pm(pipe_manager),
+      soe(soe),
+      sie(sie),
+      settings(g_settings_new(tags::app::id)) {
+  gconnections.push_back(g_signal_connect(settings, "changed::metrics-export",
+                                          G_CALLBACK(+[](GSettings* settings, char* key, gpointer user_data) {
+                                            auto* self = static_cast<MetricsExporter*>(user_data);
+
+                                            if (g_settings_get_boolean(settings, key) != 0) {
+                                              self->start();
+                                            } else {
+                                              self->stop();
+                                            }
+                                          }),
+                                          this));
+
+  if (g_settings_get_boolean(settings, "metrics-export") != 0) {
+    start();
+  }
+}
+
+MetricsExporter::~MetricsExporter() {
+  for (auto& handler_id : gconnections) {
+    g_signal_handler_disconnect(settings, handler_id);
+  }
+
+  gconnections.clear();
+
+  stop();
+
+  g_object_unref(settings);
+
+  util::debug(log_tag + "destroyed");
+}
+
+void MetricsExporter::start() {
+  if (service != nullptr) {
+    return;
+  }
+
+  // A previous instance that did not exit cleanly may have left the socket file behind.
+
+  g_unlink(socket_path.c_str());
+
+  service = g_socket_service_new();
+
+  auto* address = g_unix_socket_address_new(socket_path.c_str());
+
+  GError* error = nullptr;
+
+  if (g_socket_listener_add_address(G_SOCKET_LISTENER(service), address, G_SOCKET_TYPE_STREAM,
+                                    G_SOCKET_PROTOCOL_DEFAULT, nullptr, nullptr, &error) == 0) {
+    util::warning(log_tag + "could not listen on " + socket_path + ": " + error->message);
+
+    g_error_free(error);
+    g_object_unref(address);
+    g_object_unref(service);
+
+    service = nullptr;
+
+    return;
+  }
+
+  g_object_unref(address);
+
+  g_signal_connect(service, "incoming", G_CALLBACK(on_incoming), this);
+
+  g_socket_service_start(service);
+
+  soe->set_export_metrics(true);
+  sie->set_export_metrics(true);
+
+  util::info(log_tag + "serving metrics on " + socket_path);
+}
+
+void MetricsExporter::stop() {
+  if (service == nullptr) {
+    return;
+  }
+
+  soe->set_export_metrics(false);
+  sie->set_export_metrics(false);
+
+  g_socket_service_stop(service);
+  g_socket_listener_close(G_SOCKET_LISTENER(service));
+
+  g_object_unref(service);
+
+  service = nullptr;
+
+  g_unlink(socket_path.c_str());
+
+  util::debug(log_tag + "stopped serving metrics");
+}
+
+auto MetricsExporter::build_report() const -> std::string {
+  /*
+    The exposition format requires all the samples of a metric to be grouped after its HELP and TYPE lines. So we loop
+    over the pipelines once for each metric.
+  */
+
+  using Pipeline = std::tuple<std::string, EffectsBase*, std::map<std::string, std::shared_ptr<PluginBase>>>;
+
+  const std::array<Pipeline, 2U> pipelines = {Pipeline{"output", soe, soe->get_plugins_map()},
+                                              Pipeline{"input", sie, sie->get_plugins_map()}};
+
+  std::string report;
+
+  append_metric_header(report, "easyeffects_graph_rate_hz", "gauge", "Default sampling rate of the PipeWire graph.");
+
+  report += "easyeffects_graph_rate_hz " + pm->default_clock_rate + "\n";
+
+  append_metric_header(report, "easyeffects_graph_quantum_frames", "gauge", "Default quantum of the PipeWire graph.");
+
+  report += "easyeffects_graph_quantum_frames " + pm->default_quantum + "\n";
+
+  append_metric_header(report, "easyeffects_pipeline_latency_seconds", "gauge",
+                       "Sum of the latencies reported by the plugins in the pipeline.");
+
+  for (const auto& [pipeline, effects_base, plugins] : pipelines) {
+    report += fmt::format("easyeffects_pipeline_latency_seconds{{pipeline=\"{}\"}} {}\n", pipeline,
+                          0.001F * effects_base->get_pipeline_latency());
+  }
+
+  append_metric_header(report, "easyeffects_pipeline_rate_hz", "gauge", "Sampling rate the pipeline is running at.");
+
+  for (const auto& [pipeline, effects_base, plugins] : pipelines) {
+    report += fmt::format("easyeffects_pipeline_rate_hz{{pipeline=\"{}\"}} {}\n", pipeline,
+                          effects_base->output_level->rate);
+  }
+
+  append_metric_header(report, "easyeffects_pipeline_quantum_frames", "gauge",
+                       "Number of frames processed by the pipeline in each cycle.");
+
+  for (const auto& [pipeline, effects_base, plugins] : pipelines) {
+    report += fmt::format("easyeffects_pipeline_quantum_frames{{pipeline=\"{}\"}} {}\n", pipeline,
+                          effects_base->output_level->n_samples);
+  }
+
+  append_metric_header(report, "easyeffects_pipeline_xruns_total", "counter",
+                       "Discontinuities in the driver clock seen at the end of the pipeline.");
+
+  for (const auto& [pipeline, effects_base, plugins] : pipelines) {
+    report += fmt::format("easyeffects_pipeline_xruns_total{{pipeline=\"{}\"}} {}\n", pipeline,
+                          effects_base->output_level->xruns.load());
+  }
+
+  append_metric_header(report, "easyeffects_pipeline_output_peak_dbfs", "gauge",
+                       "Output peak of the pipeline in the last meters window.");
+
+  for (const auto& [pipeline, effects_base, plugins] : pipelines) {
+    report += fmt::format("easyeffects_pipeline_output_peak_dbfs{{pipeline=\"{}\",channel=\"left\"}} {}\n",
+                          pipeline, effects_base->output_level->output_level_left_db.load());
+
+    report += fmt::format("easyeffects_pipeline_output_peak_dbfs{{pipeline=\"{}\",channel=\"right\"}} {}\n",
+                          pipeline, effects_base->output_level->output_level_right_db.load());
+  }
+
+  append_metric_header(report, "easyeffects_plugin_input_peak_dbfs", "gauge",
+                       "Input peak of the plugin in the last meters window.");
+
+  for (const auto& [pipeline, effects_base, plugins] : pipelines) {
+    for (const auto& [name, plugin] : plugins) {
+      report += fmt::format(
+          "easyeffects_plugin_input_peak_dbfs{{pipeline=\"{}\",plugin=\"{}\",channel=\"left\"}} {}\n", pipeline, name,
+          plugin->input_level_left_db.load());
+
+      report += fmt::format(
+          "easyeffects_plugin_input_peak_dbfs{{pipeline=\"{}\",plugin=\"{}\",channel=\"right\"}} {}\n", pipeline, name,
+          plugin->input_level_right_db.load());
+    }
+  }
+
+  append_metric_header(report, "easyeffects_plugin_output_peak_dbfs", "gauge",
+                       "Output peak of the plugin in the last meters window.");
+
+  for (const auto& [pipeline, effects_base, plugins] : pipelines) {
+    for (const auto& [name, plugin] : plugins) {
+      report += fmt::format(
+          "easyeffects_plugin_output_peak_dbfs{{pipeline=\"{}\",plugin=\"{}\",channel=\"left\"}} {}\n", pipeline, name,
+          plugin->output_level_left_db.load());
+
+      report += fmt::format(
+          "easyeffects_plugin_output_peak_dbfs{{pipeline=\"{}\",plugin=\"{}\",channel=\"right\"}} {}\n", pipeline, name,
+          plugin->output_level_right_db.load());
+    }
+  }
+
+  append_metric_header(report, "easyeffects_plugin_latency_seconds", "gauge", "Latency reported by the plugin.");
+
+  for (const auto& [pipeline, effects_base, plugins] : pipelines) {
+    for (const auto& [name, plugin] : plugins) {
+      report += fmt::format("easyeffects_plugin_latency_seconds{{pipeline=\"{}\",plugin=\"{}\"}} {}\n", pipeline,
+                            name, plugin->get_latency_seconds());
+    }
+  }
+
+  append_metric_header(report, "easyeffects_plugin_dsp_seconds_total", "counter",
+                       "Time spent by the realtime thread inside the plugin.");
+
+  for (const auto& [pipeline, effects_base, plugins] : pipelines) {
+    for (const auto& [name, plugin] : plugins) {
+      report += fmt::format("easyeffects_plugin_dsp_seconds_total{{pipeline=\"{}\",plugin=\"{}\"}} {}\n", pipeline,
+                            name, 1.0E-9 * static_cast<double>(plugin->dsp_time_ns.load()));
+    }
+  }
+
+  append_metric_header(report, "easyeffects_plugin_dsp_load", "gauge",
+                       "Fraction of the quantum duration spent inside the plugin in the last meters window.");
+
+  for (const auto& [pipeline, effects_base, plugins] : pipelines) {
+    for (const auto& [name, plugin] : plugins) {
+      report += fmt::format("easyeffects_plugin_dsp_load{{pipeline=\"{}\",plugin=\"{}\"}} {}\n", pipeline, name,
+                            plugin->dsp_load.load());
+    }
+  }
+
+  return report;
+}
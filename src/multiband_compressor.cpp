@@ -55,6 +55,23 @@ MultibandCompressor::MultibandCompressor(const std::string& tag,
     util::debug(log_tag + "http://lsp-plug.in/plugins/lv2/sc_mb_compressor_stereo is not installed");
   }
 
+  latency_port = lv2_wrapper->port_ref<"out_latency">();
+
+  for (uint n = 0U; n < n_bands; n++) {
+    const auto nstr = util::to_string(n);
+
+    frequency_range_end_port.at(n) = lv2_wrapper->find_control_port("fre_" + nstr);
+
+    envelope_l_port.at(n) = lv2_wrapper->find_control_port("elm_" + nstr + "l");
+    envelope_r_port.at(n) = lv2_wrapper->find_control_port("elm_" + nstr + "r");
+
+    curve_l_port.at(n) = lv2_wrapper->find_control_port("clm_" + nstr + "l");
+    curve_r_port.at(n) = lv2_wrapper->find_control_port("clm_" + nstr + "r");
+
+    reduction_l_port.at(n) = lv2_wrapper->find_control_port("rlm_" + nstr + "l");
+    reduction_r_port.at(n) = lv2_wrapper->find_control_port("rlm_" + nstr + "r");
+  }
+
   gconnections.push_back(g_signal_connect(settings, "changed::sidechain-input-device",
                                           G_CALLBACK(+[](GSettings* settings, char* key, gpointer user_data) {
                                             auto* self = static_cast<MultibandCompressor*>(user_data);
@@ -127,7 +144,7 @@ void MultibandCompressor::process(std::span<float>& left_in,
    This plugin gives the latency in number of samples
  */
 
-  const auto lv = static_cast<uint>(lv2_wrapper->get_control_port_value("out_latency"));
+  const auto lv = static_cast<uint>(lv2_wrapper->get_control_port_value(latency_port));
 
   if (latency_n_frames != lv) {
     latency_n_frames = lv;
@@ -152,25 +169,18 @@ void MultibandCompressor::process(std::span<float>& left_in,
 
     if (send_notifications) {
       for (uint n = 0U; n < n_bands; n++) {
-        const auto nstr = util::to_string(n);
+        frequency_range_end_port_array.at(n) = lv2_wrapper->get_control_port_value(frequency_range_end_port.at(n));
 
-        frequency_range_end_port_array.at(n) = lv2_wrapper->get_control_port_value("fre_" + nstr);
+        envelope_port_array.at(n) = 0.5F * (lv2_wrapper->get_control_port_value(envelope_l_port.at(n)) +
+                                            lv2_wrapper->get_control_port_value(envelope_r_port.at(n)));
 
-        envelope_port_array.at(n) = 0.5F * (lv2_wrapper->get_control_port_value("elm_" + nstr + "l") +
-                                            lv2_wrapper->get_control_port_value("elm_" + nstr + "r"));
+        curve_port_array.at(n) = 0.5F * (lv2_wrapper->get_control_port_value(curve_l_port.at(n)) +
+                                         lv2_wrapper->get_control_port_value(curve_r_port.at(n)));
 
-        curve_port_array.at(n) = 0.5F * (lv2_wrapper->get_control_port_value("clm_" + nstr + "l") +
-                                         lv2_wrapper->get_control_port_value("clm_" + nstr + "r"));
-
-        reduction_port_array.at(n) = 0.5F * (lv2_wrapper->get_control_port_value("rlm_" + nstr + "l") +
-                                             lv2_wrapper->get_control_port_value("rlm_" + nstr + "r"));
+        reduction_port_array.at(n) = 0.5F * (lv2_wrapper->get_control_port_value(reduction_l_port.at(n)) +
+                                             lv2_wrapper->get_control_port_value(reduction_r_port.at(n)));
       }
 
-      frequency_range.emit(frequency_range_end_port_array);
-      envelope.emit(envelope_port_array);
-      curve.emit(curve_port_array);
-      reduction.emit(reduction_port_array);
-
       notify();
     }
   }
@@ -207,104 +207,33 @@ void setup(MultibandCompressorBox* self,
     }
   }
 
-  self->data->connections.push_back(multiband_compressor->input_level.connect([=](const float left, const float right) {
-    g_object_ref(self);
-
-    util::idle_add(
-        [=]() {
-          if (get_ignore_filter_idle_add(serial)) {
-            return;
-          }
-
-          update_level(self->input_level_left, self->input_level_left_label, self->input_level_right,
-                       self->input_level_right_label, left, right);
-        },
-        [=]() { g_object_unref(self); });
-  }));
+  add_meters_tick_callback(GTK_WIDGET(self), multiband_compressor.get(), [=]() {
+    update_level(self->input_level_left, self->input_level_left_label, self->input_level_right,
+                 self->input_level_right_label, multiband_compressor->input_level_left_db,
+                 multiband_compressor->input_level_right_db);
+
+    update_level(self->output_level_left, self->output_level_left_label, self->output_level_right,
+                 self->output_level_right_label, multiband_compressor->output_level_left_db,
+                 multiband_compressor->output_level_right_db);
+
+    for (size_t n = 0U; n < multiband_compressor->frequency_range_end_port_array.size(); n++) {
+      ui::multiband_compressor_band_box::set_end_label(self->bands[n],
+                                                       multiband_compressor->frequency_range_end_port_array[n]);
+    }
+
+    for (size_t n = 0U; n < multiband_compressor->envelope_port_array.size(); n++) {
+      ui::multiband_compressor_band_box::set_envelope_label(self->bands[n],
+                                                            multiband_compressor->envelope_port_array[n]);
+    }
 
-  self->data->connections.push_back(
-      multiband_compressor->output_level.connect([=](const float left, const float right) {
-        g_object_ref(self);
-
-        util::idle_add(
-            [=]() {
-              if (get_ignore_filter_idle_add(serial)) {
-                return;
-              }
-
-              update_level(self->output_level_left, self->output_level_left_label, self->output_level_right,
-                           self->output_level_right_label, left, right);
-            },
-            [=]() { g_object_unref(self); });
-      }));
-
-  self->data->connections.push_back(multiband_compressor->frequency_range.connect(
-      [=](const std::array<float, tags::multiband_compressor::n_bands> values) {
-        g_object_ref(self);
-
-        util::idle_add(
-            [=]() {
-              if (get_ignore_filter_idle_add(serial)) {
-                return;
-              }
-
-              for (size_t n = 0U; n < values.size(); n++) {
-                ui::multiband_compressor_band_box::set_end_label(self->bands[n], values[n]);
-              }
-            },
-            [=]() { g_object_unref(self); });
-      }));
-
-  self->data->connections.push_back(
-      multiband_compressor->envelope.connect([=](const std::array<float, tags::multiband_compressor::n_bands> values) {
-        g_object_ref(self);
-
-        util::idle_add(
-            [=]() {
-              if (get_ignore_filter_idle_add(serial)) {
-                return;
-              }
-
-              for (size_t n = 0U; n < values.size(); n++) {
-                ui::multiband_compressor_band_box::set_envelope_label(self->bands[n], values[n]);
-              }
-            },
-            [=]() { g_object_unref(self); });
-      }));
-
-  self->data->connections.push_back(
-      multiband_compressor->curve.connect([=](const std::array<float, tags::multiband_compressor::n_bands> values) {
-        g_object_ref(self);
-
-        util::idle_add(
-            [=]() {
-              if (get_ignore_filter_idle_add(serial)) {
-                return;
-              }
-
-              for (size_t n = 0U; n < values.size(); n++) {
-                ui::multiband_compressor_band_box::set_curve_label(self->bands[n], values[n]);
-              }
-            },
-            [=]() { g_object_unref(self); });
-      }));
-
-  self->data->connections.push_back(
-      multiband_compressor->reduction.connect([=](const std::array<float, tags::multiband_compressor::n_bands> values) {
-        g_object_ref(self);
-
-        util::idle_add(
-            [=]() {
-              if (get_ignore_filter_idle_add(serial)) {
-                return;
-              }
-
-              for (size_t n = 0U; n < values.size(); n++) {
-                ui::multiband_compressor_band_box::set_gain_label(self->bands[n], values[n]);
-              }
-            },
-            [=]() { g_object_unref(self); });
-      }));
+    for (size_t n = 0U; n < multiband_compressor->curve_port_array.size(); n++) {
+      ui::multiband_compressor_band_box::set_curve_label(self->bands[n], multiband_compressor->curve_port_array[n]);
+    }
+
+    for (size_t n = 0U; n < multiband_compressor->reduction_port_array.size(); n++) {
+      ui::multiband_compressor_band_box::set_gain_label(self->bands[n], multiband_compressor->reduction_port_array[n]);
+    }
+  });
 
   self->data->connections.push_back(pm->source_added.connect([=](const NodeInfo info) {
     for (guint n = 0U; n < g_list_model_get_n_items(G_LIST_MODEL(self->input_devices_model)); n++) {
@@ -207,103 +207,31 @@ void setup(MultibandGateBox* self,
     }
   }
 
-  self->data->connections.push_back(multiband_gate->input_level.connect([=](const float left, const float right) {
-    g_object_ref(self);
-
-    util::idle_add(
-        [=]() {
-          if (get_ignore_filter_idle_add(serial)) {
-            return;
-          }
-
-          update_level(self->input_level_left, self->input_level_left_label, self->input_level_right,
-                       self->input_level_right_label, left, right);
-        },
-        [=]() { g_object_unref(self); });
-  }));
+  add_meters_tick_callback(GTK_WIDGET(self), multiband_gate.get(), [=]() {
+    update_level(self->input_level_left, self->input_level_left_label, self->input_level_right,
+                 self->input_level_right_label, multiband_gate->input_level_left_db,
+                 multiband_gate->input_level_right_db);
 
-  self->data->connections.push_back(multiband_gate->output_level.connect([=](const float left, const float right) {
-    g_object_ref(self);
+    update_level(self->output_level_left, self->output_level_left_label, self->output_level_right,
+                 self->output_level_right_label, multiband_gate->output_level_left_db,
+                 multiband_gate->output_level_right_db);
 
-    util::idle_add(
-        [=]() {
-          if (get_ignore_filter_idle_add(serial)) {
-            return;
-          }
+    for (size_t n = 0U; n < multiband_gate->frequency_range_end_port_array.size(); n++) {
+      ui::multiband_gate_band_box::set_end_label(self->bands[n], multiband_gate->frequency_range_end_port_array[n]);
+    }
 
-          update_level(self->output_level_left, self->output_level_left_label, self->output_level_right,
-                       self->output_level_right_label, left, right);
-        },
-        [=]() { g_object_unref(self); });
-  }));
+    for (size_t n = 0U; n < multiband_gate->envelope_port_array.size(); n++) {
+      ui::multiband_gate_band_box::set_envelope_label(self->bands[n], multiband_gate->envelope_port_array[n]);
+    }
 
-  self->data->connections.push_back(
-      multiband_gate->frequency_range.connect([=](const std::array<float, tags::multiband_gate::n_bands> values) {
-        g_object_ref(self);
-
-        util::idle_add(
-            [=]() {
-              if (get_ignore_filter_idle_add(serial)) {
-                return;
-              }
-
-              for (size_t n = 0U; n < values.size(); n++) {
-                ui::multiband_gate_band_box::set_end_label(self->bands[n], values[n]);
-              }
-            },
-            [=]() { g_object_unref(self); });
-      }));
-
-  self->data->connections.push_back(
-      multiband_gate->envelope.connect([=](const std::array<float, tags::multiband_gate::n_bands> values) {
-        g_object_ref(self);
-
-        util::idle_add(
-            [=]() {
-              if (get_ignore_filter_idle_add(serial)) {
-                return;
-              }
-
-              for (size_t n = 0U; n < values.size(); n++) {
-                ui::multiband_gate_band_box::set_envelope_label(self->bands[n], values[n]);
-              }
-            },
-            [=]() { g_object_unref(self); });
-      }));
-
-  self->data->connections.push_back(
-      multiband_gate->curve.connect([=](const std::array<float, tags::multiband_gate::n_bands> values) {
-        g_object_ref(self);
-
-        util::idle_add(
-            [=]() {
-              if (get_ignore_filter_idle_add(serial)) {
-                return;
-              }
-
-              for (size_t n = 0U; n < values.size(); n++) {
-                ui::multiband_gate_band_box::set_curve_label(self->bands[n], values[n]);
-              }
-            },
-            [=]() { g_object_unref(self); });
-      }));
-
-  self->data->connections.push_back(
-      multiband_gate->reduction.connect([=](const std::array<float, tags::multiband_gate::n_bands> values) {
-        g_object_ref(self);
-
-        util::idle_add(
-            [=]() {
-              if (get_ignore_filter_idle_add(serial)) {
-                return;
-              }
-
-              for (size_t n = 0U; n < values.size(); n++) {
-                ui::multiband_gate_band_box::set_gain_label(self->bands[n], values[n]);
-              }
-            },
-            [=]() { g_object_unref(self); });
-      }));
+    for (size_t n = 0U; n < multiband_gate->curve_port_array.size(); n++) {
+      ui::multiband_gate_band_box::set_curve_label(self->bands[n], multiband_gate->curve_port_array[n]);
+    }
+
+    for (size_t n = 0U; n < multiband_gate->reduction_port_array.size(); n++) {
+      ui::multiband_gate_band_box::set_gain_label(self->bands[n], multiband_gate->reduction_port_array[n]);
+    }
+  });
 
   self->data->connections.push_back(pm->source_added.connect([=](const NodeInfo info) {
     for (guint n = 0U; n < g_list_model_get_n_items(G_LIST_MODEL(self->input_devices_model)); n++) {
@@ -61,10 +61,14 @@
 #include <cstdint>
 #include <cstring>
 #include <ctime>
+#include <mutex>
+#include <optional>
 #include <span>
 #include <stdexcept>
 #include <string>
 #include <thread>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 #include "pipe_objects.hpp"
 #include "tags_app.hpp"
@@ -99,6 +103,72 @@ struct proxy_data {
   uint64_t serial = SPA_ID_INVALID;
 };
 
+/*
+  The object lists are paired with a serial to position index. Removal moves the last element into the hole so that
+  both the vector and the index stay compact without shifting the other elements.
+*/
+
+template <typename T>
+void indexed_insert(std::vector<T>& list, std::unordered_map<uint64_t, size_t>& index, const T& info) {
+  index[info.serial] = list.size();
+
+  list.push_back(info);
+}
+
+template <typename T>
+auto indexed_find(std::vector<T>& list, const std::unordered_map<uint64_t, size_t>& index, const uint64_t& serial)
+    -> T* {
+  const auto it = index.find(serial);
+
+  return (it != index.end()) ? &list[it->second] : nullptr;
+}
+
+template <typename T>
+auto indexed_erase(std::vector<T>& list, std::unordered_map<uint64_t, size_t>& index, const uint64_t& serial)
+    -> std::optional<T> {
+  const auto it = index.find(serial);
+
+  if (it == index.end()) {
+    return std::nullopt;
+  }
+
+  const auto position = it->second;
+
+  index.erase(it);
+
+  std::optional<T> removed = std::move(list[position]);
+
+  if (position != list.size() - 1U) {
+    list[position] = std::move(list.back());
+
+    index[list[position].serial] = position;
+  }
+
+  list.pop_back();
+
+  return removed;
+}
+
+void erase_node_entry(std::unordered_map<uint, std::vector<uint64_t>>& map,
+                      const uint& node_id,
+                      const uint64_t& serial) {
+  if (auto it = map.find(node_id); it != map.end()) {
+    std::erase(it->second, serial);
+
+    if (it->second.empty()) {
+      map.erase(it);
+    }
+  }
+}
+
+// PipeWire recycles ids. The entry is only removed if it still belongs to the node being removed.
+
+void erase_node_serial(std::unordered_map<uint, uint64_t>& map, const uint& node_id, const uint64_t& serial) {
+  if (auto it = map.find(node_id); it != map.end() && it->second == serial) {
+    map.erase(it);
+  }
+}
+
 template <typename T>
 auto spa_dict_get_string(const spa_dict* props, const char* key, T& str) -> bool {
   // If we will use string views in the future, this template could be useful.
@@ -216,6 +286,8 @@ void on_destroy_node_proxy(void* data) {
 
   spa_hook_remove(&nd->proxy_listener);
 
+  erase_node_serial(pm->node_serial_by_id, node_it->second.id, node_it->second.serial);
+
   pm->node_map.erase(node_it);
 
   if (!PipeManager::exiting) {
@@ -371,6 +443,8 @@ void on_node_info(void* object, const struct pw_node_info* info) {
 
     spa_hook_remove(&nd->proxy_listener);
 
+    erase_node_serial(pm->node_serial_by_id, node_it->second.id, node_it->second.serial);
+
     pm->node_map.erase(node_it);
 
     if (nd->nd_info->media_class == tags::pipewire::media_class::source) {
@@ -798,26 +872,20 @@ void on_link_info(void* object, const struct pw_link_info* info) {
   auto* const ld = static_cast<proxy_data*>(object);
   auto* const pm = ld->pm;
 
-  LinkInfo link_copy;
-
-  for (auto& l : ld->pm->list_links) {
-    if (l.serial == ld->serial) {
-      l.state = info->state;
+  if (auto* l = indexed_find(pm->list_links, pm->link_index_by_serial, ld->serial); l != nullptr) {
+    l->state = info->state;
 
-      link_copy = l;
-
-      util::idle_add([pm, link_copy] {
-        if (PipeManager::exiting) {
-          return;
-        }
+    const auto link_copy = *l;
 
-        pm->link_changed.emit(link_copy);
-      });
+    util::idle_add([pm, link_copy] {
+      if (PipeManager::exiting) {
+        return;
+      }
 
-      // util::warning(pw_link_state_as_string(l.state));
+      pm->link_changed.emit(link_copy);
+    });
 
-      break;
-    }
+    // util::warning(pw_link_state_as_string(l->state));
   }
 
   // const struct spa_dict_item* item = nullptr;
@@ -829,9 +897,12 @@ void on_destroy_link_proxy(void* data) {
 
   spa_hook_remove(&ld->proxy_listener);
 
-  ld->pm->list_links.erase(std::remove_if(ld->pm->list_links.begin(), ld->pm->list_links.end(),
-                                          [=](const auto& n) { return n.serial == ld->serial; }),
-                           ld->pm->list_links.end());
+  auto* const pm = ld->pm;
+
+  if (const auto link = indexed_erase(pm->list_links, pm->link_index_by_serial, ld->serial)) {
+    erase_node_entry(pm->link_serials_by_node, link->output_node_id, link->serial);
+    erase_node_entry(pm->link_serials_by_node, link->input_node_id, link->serial);
+  }
 }
 
 void on_destroy_port_proxy(void* data) {
@@ -839,24 +910,25 @@ void on_destroy_port_proxy(void* data) {
 
   spa_hook_remove(&pd->proxy_listener);
 
-  pd->pm->list_ports.erase(std::remove_if(pd->pm->list_ports.begin(), pd->pm->list_ports.end(),
-                                          [=](const auto& n) { return n.serial == pd->serial; }),
-                           pd->pm->list_ports.end());
+  auto* const pm = pd->pm;
+
+  std::scoped_lock<std::mutex> lock(pm->ports_mutex);
+
+  if (const auto port = indexed_erase(pm->list_ports, pm->port_index_by_serial, pd->serial)) {
+    erase_node_entry(pm->port_serials_by_node, port->node_id, port->serial);
+  }
 }
 
 void on_module_info(void* object, const struct pw_module_info* info) {
   auto* const md = static_cast<proxy_data*>(object);
 
-  for (auto& module : md->pm->list_modules) {
-    if (module.id == info->id) {
-      if (info->filename != nullptr) {
-        module.filename = info->filename;
-      }
-
-      spa_dict_get_string(info->props, PW_KEY_MODULE_DESCRIPTION, module.description);
-
-      break;
+  if (auto* module = indexed_find(md->pm->list_modules, md->pm->module_index_by_serial, md->serial);
+      module != nullptr) {
+    if (info->filename != nullptr) {
+      module->filename = info->filename;
     }
+
+    spa_dict_get_string(info->props, PW_KEY_MODULE_DESCRIPTION, module->description);
   }
 }
 
@@ -865,24 +937,19 @@ void on_destroy_module_proxy(void* data) {
 
   spa_hook_remove(&md->proxy_listener);
 
-  md->pm->list_modules.erase(std::remove_if(md->pm->list_modules.begin(), md->pm->list_modules.end(),
-                                            [=](const auto& n) { return n.id == md->id; }),
-                             md->pm->list_modules.end());
+  indexed_erase(md->pm->list_modules, md->pm->module_index_by_serial, md->serial);
 }
 
 void on_client_info(void* object, const struct pw_client_info* info) {
   auto* const cd = static_cast<proxy_data*>(object);
 
-  for (auto& client : cd->pm->list_clients) {
-    if (client.id == info->id) {
-      spa_dict_get_string(info->props, PW_KEY_APP_NAME, client.name);
+  if (auto* client = indexed_find(cd->pm->list_clients, cd->pm->client_index_by_serial, cd->serial);
+      client != nullptr) {
+    spa_dict_get_string(info->props, PW_KEY_APP_NAME, client->name);
 
-      spa_dict_get_string(info->props, PW_KEY_ACCESS, client.access);
+    spa_dict_get_string(info->props, PW_KEY_ACCESS, client->access);
 
-      spa_dict_get_string(info->props, PW_KEY_CLIENT_API, client.api);
-
-      break;
-    }
+    spa_dict_get_string(info->props, PW_KEY_CLIENT_API, client->api);
   }
 }
 
@@ -891,63 +958,61 @@ void on_destroy_client_proxy(void* data) {
 
   spa_hook_remove(&cd->proxy_listener);
 
-  cd->pm->list_clients.erase(std::remove_if(cd->pm->list_clients.begin(), cd->pm->list_clients.end(),
-                                            [=](const auto& n) { return n.serial == cd->serial; }),
-                             cd->pm->list_clients.end());
+  indexed_erase(cd->pm->list_clients, cd->pm->client_index_by_serial, cd->serial);
 }
 
 void on_device_info(void* object, const struct pw_device_info* info) {
   auto* const dd = static_cast<proxy_data*>(object);
 
-  for (auto& device : dd->pm->list_devices) {
-    if (device.id != info->id) {
-      continue;
-    }
+  auto* const device_ptr = indexed_find(dd->pm->list_devices, dd->pm->device_index_by_serial, dd->serial);
+
+  if (device_ptr == nullptr) {
+    return;
+  }
 
-    spa_dict_get_string(info->props, PW_KEY_DEVICE_NAME, device.name);
+  auto& device = *device_ptr;
 
-    spa_dict_get_string(info->props, PW_KEY_DEVICE_NICK, device.nick);
+  spa_dict_get_string(info->props, PW_KEY_DEVICE_NAME, device.name);
 
-    spa_dict_get_string(info->props, PW_KEY_DEVICE_DESCRIPTION, device.description);
+  spa_dict_get_string(info->props, PW_KEY_DEVICE_NICK, device.nick);
 
-    spa_dict_get_string(info->props, PW_KEY_DEVICE_API, device.api);
+  spa_dict_get_string(info->props, PW_KEY_DEVICE_DESCRIPTION, device.description);
 
-    if (spa_dict_get_string(info->props, SPA_KEY_DEVICE_BUS_ID, device.bus_id)) {
-      std::ranges::replace(device.bus_id, ':', '_');
-      std::ranges::replace(device.bus_id, '+', '_');
-    }
+  spa_dict_get_string(info->props, PW_KEY_DEVICE_API, device.api);
 
-    if (spa_dict_get_string(info->props, PW_KEY_DEVICE_BUS_PATH, device.bus_path)) {
-      std::ranges::replace(device.bus_path, ':', '_');
-      std::ranges::replace(device.bus_path, '+', '_');
-    }
+  if (spa_dict_get_string(info->props, SPA_KEY_DEVICE_BUS_ID, device.bus_id)) {
+    std::ranges::replace(device.bus_id, ':', '_');
+    std::ranges::replace(device.bus_id, '+', '_');
+  }
 
-    /*
-        For some reason bluez5 devices do not define bus-path or bus-id. So as a workaround we set
-       SPA_KEY_API_BLUEZ5_ADDRESS as bus_path
-    */
+  if (spa_dict_get_string(info->props, PW_KEY_DEVICE_BUS_PATH, device.bus_path)) {
+    std::ranges::replace(device.bus_path, ':', '_');
+    std::ranges::replace(device.bus_path, '+', '_');
+  }
 
-    if (device.api == "bluez5") {
-      if (spa_dict_get_string(info->props, SPA_KEY_API_BLUEZ5_ADDRESS, device.bus_path)) {
-        std::replace(device.bus_path.begin(), device.bus_path.end(), ':', '_');
-      }
+  /*
+      For some reason bluez5 devices do not define bus-path or bus-id. So as a workaround we set
+     SPA_KEY_API_BLUEZ5_ADDRESS as bus_path
+  */
+
+  if (device.api == "bluez5") {
+    if (spa_dict_get_string(info->props, SPA_KEY_API_BLUEZ5_ADDRESS, device.bus_path)) {
+      std::replace(device.bus_path.begin(), device.bus_path.end(), ':', '_');
     }
+  }
 
-    if ((info->change_mask & PW_DEVICE_CHANGE_MASK_PARAMS) != 0U) {
-      auto params = std::span(info->params, info->n_params);
+  if ((info->change_mask & PW_DEVICE_CHANGE_MASK_PARAMS) != 0U) {
+    auto params = std::span(info->params, info->n_params);
 
-      for (auto param : params) {
-        if ((param.flags & SPA_PARAM_INFO_READ) == 0U) {
-          continue;
-        }
+    for (auto param : params) {
+      if ((param.flags & SPA_PARAM_INFO_READ) == 0U) {
+        continue;
+      }
 
-        if (const auto id = param.id; id == SPA_PARAM_Route) {
-          pw_device_enum_params((struct pw_device*)dd->proxy, 0, id, 0, -1, nullptr);
-        }
+      if (const auto id = param.id; id == SPA_PARAM_Route) {
+        pw_device_enum_params((struct pw_device*)dd->proxy, 0, id, 0, -1, nullptr);
       }
     }
-
-    break;
   }
 }
 
@@ -978,42 +1043,42 @@ void on_device_event_param(void* object,
     return;
   }
 
-  for (auto& device : dd->pm->list_devices) {
-    if (device.id != dd->id) {
-      continue;
-    }
+  auto* const device_ptr = indexed_find(dd->pm->list_devices, dd->pm->device_index_by_serial, dd->serial);
 
-    auto* const pm = dd->pm;
+  if (device_ptr == nullptr) {
+    return;
+  }
 
-    if (direction == SPA_DIRECTION_INPUT) {
-      if (name != device.input_route_name || available != device.input_route_available) {
-        device.input_route_name = name;
-        device.input_route_available = available;
+  auto& device = *device_ptr;
 
-        util::idle_add([pm, device] {
-          if (PipeManager::exiting) {
-            return;
-          }
+  auto* const pm = dd->pm;
 
-          pm->device_input_route_changed.emit(device);
-        });
-      }
-    } else if (direction == SPA_DIRECTION_OUTPUT) {
-      if (name != device.output_route_name || available != device.output_route_available) {
-        device.output_route_name = name;
-        device.output_route_available = available;
-
-        util::idle_add([pm, device] {
-          if (PipeManager::exiting) {
-            return;
-          }
+  if (direction == SPA_DIRECTION_INPUT) {
+    if (name != device.input_route_name || available != device.input_route_available) {
+      device.input_route_name = name;
+      device.input_route_available = available;
 
-          pm->device_output_route_changed.emit(device);
-        });
-      }
+      util::idle_add([pm, device] {
+        if (PipeManager::exiting) {
+          return;
+        }
+
+        pm->device_input_route_changed.emit(device);
+      });
     }
+  } else if (direction == SPA_DIRECTION_OUTPUT) {
+    if (name != device.output_route_name || available != device.output_route_available) {
+      device.output_route_name = name;
+      device.output_route_available = available;
+
+      util::idle_add([pm, device] {
+        if (PipeManager::exiting) {
+          return;
+        }
 
-    break;
+        pm->device_output_route_changed.emit(device);
+      });
+    }
   }
 }
 
@@ -1022,9 +1087,7 @@ void on_destroy_device_proxy(void* data) {
 
   spa_hook_remove(&dd->proxy_listener);
 
-  dd->pm->list_devices.erase(std::remove_if(dd->pm->list_devices.begin(), dd->pm->list_devices.end(),
-                                            [=](const auto& n) { return n.id == dd->id; }),
-                             dd->pm->list_devices.end());
+  indexed_erase(dd->pm->list_devices, dd->pm->device_index_by_serial, dd->serial);
 }
 
 auto on_metadata_property(void* data, uint32_t id, const char* key, const char* type, const char* value) -> int {
@@ -1253,6 +1316,8 @@ void on_registry_global(void* data,
       return;
     }
 
+    pm->node_serial_by_id[id] = serial;
+
     pw_node_add_listener(proxy, &nd->object_listener, &node_events, nd);
     pw_proxy_add_listener(proxy, &nd->proxy_listener, &node_proxy_events, nd);
 
@@ -1331,7 +1396,10 @@ void on_registry_global(void* data,
     link_info.id = id;
     link_info.serial = serial;
 
-    pm->list_links.push_back(link_info);
+    indexed_insert(pm->list_links, pm->link_index_by_serial, link_info);
+
+    pm->link_serials_by_node[link_info.output_node_id].push_back(serial);
+    pm->link_serials_by_node[link_info.input_node_id].push_back(serial);
 
     try {
       const auto input_node = pm->node_map_at_id(link_info.input_node_id);
@@ -1375,7 +1443,15 @@ void on_registry_global(void* data,
     // std::cout << port_info.name << "\t" << port_info.audio_channel << "\t" << port_info.direction << "\t"
     //           << port_info.format_dsp << "\t" << port_info.port_id << "\t" << port_info.node_id << std::endl;
 
-    pm->list_ports.push_back(port_info);
+    {
+      std::scoped_lock<std::mutex> lock(pm->ports_mutex);
+
+      indexed_insert(pm->list_ports, pm->port_index_by_serial, port_info);
+
+      pm->port_serials_by_node[port_info.node_id].push_back(serial);
+    }
+
+    pm->ports_cv.notify_all();
 
     return;
   }
@@ -1406,7 +1482,7 @@ void on_registry_global(void* data,
 
     spa_dict_get_string(props, PW_KEY_MODULE_NAME, m_info.name);
 
-    pm->list_modules.push_back(m_info);
+    indexed_insert(pm->list_modules, pm->module_index_by_serial, m_info);
 
     return;
   }
@@ -1435,7 +1511,7 @@ void on_registry_global(void* data,
 
     ClientInfo c_info{.id = id, .serial = serial};
 
-    pm->list_clients.push_back(c_info);
+    indexed_insert(pm->list_clients, pm->client_index_by_serial, c_info);
 
     return;
   }
@@ -1494,7 +1570,7 @@ void on_registry_global(void* data,
 
         DeviceInfo d_info{.id = id, .serial = serial, .media_class = media_class};
 
-        pm->list_devices.push_back(d_info);
+        indexed_insert(pm->list_devices, pm->device_index_by_serial, d_info);
       }
     }
 
@@ -1709,9 +1785,9 @@ PipeManager::~PipeManager() {
 auto PipeManager::node_map_at_id(const uint& id) -> NodeInfo& {
   // Helper method to access easily a node by id, same functionality as map.at()
 
-  for (auto& [serial, node] : node_map) {
-    if (node.id == id) {
-      return node;
+  if (const auto serial_it = node_serial_by_id.find(id); serial_it != node_serial_by_id.end()) {
+    if (auto node_it = node_map.find(serial_it->second); node_it != node_map.end()) {
+      return node_it->second;
     }
   }
 
@@ -1720,13 +1796,13 @@ auto PipeManager::node_map_at_id(const uint& id) -> NodeInfo& {
 
 auto PipeManager::stream_is_connected(const uint& id, const std::string& media_class) -> bool {
   if (media_class == tags::pipewire::media_class::output_stream) {
-    for (const auto& link : list_links) {
+    for (const auto& link : get_node_links(id)) {
       if (link.output_node_id == id && link.input_node_id == ee_sink_node.id) {
         return true;
       }
     }
   } else if (media_class == tags::pipewire::media_class::input_stream) {
-    for (const auto& link : list_links) {
+    for (const auto& link : get_node_links(id)) {
       if (link.output_node_id == ee_source_node.id && link.input_node_id == id) {
         return true;
       }
@@ -1736,6 +1812,36 @@ auto PipeManager::stream_is_connected(const uint& id, const std::string& media_c
   return false;
 }
 
+auto PipeManager::get_node_links(const uint& node_id) -> std::vector<LinkInfo> {
+  std::vector<LinkInfo> list;
+
+  if (const auto it = link_serials_by_node.find(node_id); it != link_serials_by_node.end()) {
+    for (const auto& serial : it->second) {
+      if (const auto index_it = link_index_by_serial.find(serial); index_it != link_index_by_serial.end()) {
+        list.push_back(list_links[index_it->second]);
+      }
+    }
+  }
+
+  return list;
+}
+
+auto PipeManager::get_node_ports(const uint& node_id) -> std::vector<PortInfo> {
+  std::scoped_lock<std::mutex> lock(ports_mutex);
+
+  std::vector<PortInfo> list;
+
+  if (const auto it = port_serials_by_node.find(node_id); it != port_serials_by_node.end()) {
+    for (const auto& serial : it->second) {
+      if (const auto index_it = port_index_by_serial.find(serial); index_it != port_index_by_serial.end()) {
+        list.push_back(list_ports[index_it->second]);
+      }
+    }
+  }
+
+  return list;
+}
+
 void PipeManager::connect_stream_output(const uint& id) const {
   set_metadata_target_node(id, ee_sink_node.id, ee_sink_node.serial);
 }
@@ -1809,15 +1915,23 @@ void PipeManager::set_node_mute(pw_proxy* proxy, const bool& state) const {
 }
 
 auto PipeManager::count_node_ports(const uint& node_id) -> uint {
-  uint count = 0U;
+  std::scoped_lock<std::mutex> lock(ports_mutex);
 
-  for (const auto& port : list_ports) {
-    if (port.node_id == node_id) {
-      count++;
-    }
-  }
+  const auto it = port_serials_by_node.find(node_id);
+
+  return (it != port_serials_by_node.end()) ? static_cast<uint>(it->second.size()) : 0U;
+}
+
+auto PipeManager::wait_node_ports(const uint& node_id,
+                                  const uint& n_ports,
+                                  const std::chrono::milliseconds& timeout) -> bool {
+  std::unique_lock<std::mutex> lock(ports_mutex);
 
-  return count;
+  return ports_cv.wait_for(lock, timeout, [&]() {
+    const auto it = port_serials_by_node.find(node_id);
+
+    return it != port_serials_by_node.end() && it->second.size() >= n_ports;
+  });
 }
 
 auto PipeManager::link_nodes(const uint& output_node_id,
@@ -1829,8 +1943,8 @@ auto PipeManager::link_nodes(const uint& output_node_id,
   std::vector<PortInfo> list_input_ports;
   auto use_audio_channel = true;
 
-  for (const auto& port : list_ports) {
-    if (port.node_id == output_node_id && port.direction == "out") {
+  for (const auto& port : get_node_ports(output_node_id)) {
+    if (port.direction == "out") {
       list_output_ports.push_back(port);
 
       if (!probe_link) {
@@ -1839,8 +1953,10 @@ auto PipeManager::link_nodes(const uint& output_node_id,
         }
       }
     }
+  }
 
-    if (port.node_id == input_node_id && port.direction == "in") {
+  for (const auto& port : get_node_ports(input_node_id)) {
+    if (port.direction == "in") {
       if (!probe_link) {
         list_input_ports.push_back(port);
 
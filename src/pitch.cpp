@@ -74,6 +74,8 @@ Pitch::Pitch(const std::string& tag,
 
                                               self->data_mutex.lock();
 
+                                              self->prime_output();
+
                                               self->soundtouch_ready = true;
 
                                               self->data_mutex.unlock();
@@ -213,8 +215,8 @@ void Pitch::setup() {
     data.resize(2U * static_cast<size_t>(n_samples));
   }
 
-  deque_out_L.resize(0U);
-  deque_out_R.resize(0U);
+  data_L.resize(n_samples);
+  data_R.resize(n_samples);
 
   util::idle_add([&, this] {
     if (soundtouch_ready) {
@@ -225,6 +227,8 @@ void Pitch::setup() {
 
     std::scoped_lock<std::mutex> lock(data_mutex);
 
+    prime_output();
+
     soundtouch_ready = true;
   });
 }
@@ -259,45 +263,42 @@ void Pitch::process(std::span<float>& left_in,
     n_received = snd_touch->receiveSamples(data.data(), n_samples);
 
     for (size_t n = 0U; n < n_received; n++) {
-      deque_out_L.push_back(data[n * 2U]);
-      deque_out_R.push_back(data[n * 2U + 1U]);
+      data_L[n] = data[n * 2U];
+      data_R[n] = data[n * 2U + 1U];
     }
 
-  } while (n_received != 0);
+    // Never lose the newest frames. If there is no room the oldest ones are dropped instead.
 
-  if (deque_out_L.size() >= left_out.size()) {
-    for (float& v : left_out) {
-      v = deque_out_L.front();
+    const auto no_room = n_received - std::min<size_t>(out_L.capacity() - out_L.size(), n_received);
 
-      deque_out_L.pop_front();
-    }
+    out_L.discard(no_room);
+    out_R.discard(no_room);
 
-    for (float& v : right_out) {
-      v = deque_out_R.front();
+    out_L.push(std::span<const float>(data_L.data(), n_received));
+    out_R.push(std::span<const float>(data_R.data(), n_received));
+  } while (n_received != 0);
 
-      deque_out_R.pop_front();
-    }
-  } else {
-    const uint offset = left_out.size() - deque_out_L.size();
+  /*
+    The priming done in prime_output() keeps a quantum available while the tempo is unchanged. With a faster tempo
+    less comes out than goes in and the fifo runs dry. We then send silence and prime it again, so the gaps are few
+    and the latency stays at the primed value. With a slower tempo the fifo grows instead, and what is more than a
+    quantum above the primed value is dropped.
+  */
 
-    if (offset != latency_n_frames) {
-      latency_n_frames = offset;
+  const auto missing = left_out.size() - std::min(out_L.size(), left_out.size());
 
-      notify_latency = true;
-    }
+  std::fill_n(left_out.begin(), missing, 0.0F);
+  std::fill_n(right_out.begin(), missing, 0.0F);
 
-    for (uint n = 0U; !deque_out_L.empty() && n < left_out.size(); n++) {
-      if (n < offset) {
-        left_out[n] = 0.0F;
-        right_out[n] = 0.0F;
-      } else {
-        left_out[n] = deque_out_L.front();
-        right_out[n] = deque_out_R.front();
+  out_L.pop(left_out.subspan(missing));
+  out_R.pop(right_out.subspan(missing));
 
-        deque_out_R.pop_front();
-        deque_out_L.pop_front();
-      }
-    }
+  if (missing != 0U) {
+    out_L.push_silence(latency_n_frames);
+    out_R.push_silence(latency_n_frames);
+  } else if (out_L.size() > latency_n_frames + n_samples) {
+    out_L.discard(out_L.size() - latency_n_frames);
+    out_R.discard(out_R.size() - latency_n_frames);
   }
 
   if (output_gain != 1.0F) {
@@ -429,6 +430,32 @@ void Pitch::init_soundtouch() {
   set_rate_difference();
 }
 
+void Pitch::prime_output() {
+  /*
+    SoundTouch needs its initial latency worth of input before it outputs anything and after that its output comes in
+    chunks of one nominal output sequence. Starting the output with this much silence keeps a full quantum available
+    at every cycle, so the latency is constant and equal to the amount of silence.
+  */
+
+#ifdef SETTING_INITIAL_LATENCY
+  const auto initial_latency = snd_touch->getSetting(SETTING_INITIAL_LATENCY);
+#else
+  const auto initial_latency = (sequence_length_ms + seek_window_ms) * static_cast<int>(rate) / 1000;
+#endif
+
+  const auto output_sequence = snd_touch->getSetting(SETTING_NOMINAL_OUTPUT_SEQUENCE);
+
+  latency_n_frames = static_cast<uint>(std::max(initial_latency, 0) + std::max(output_sequence, 0));
+
+  out_L.resize(2U * (latency_n_frames + n_samples));
+  out_R.resize(2U * (latency_n_frames + n_samples));
+
+  out_L.push_silence(latency_n_frames);
+  out_R.push_silence(latency_n_frames);
+
+  notify_latency = true;
+}
+
 auto Pitch::get_latency_seconds() -> float {
   return latency_value;
 }
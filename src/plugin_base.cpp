@@ -40,14 +40,18 @@
 #include <sys/types.h>
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <chrono>
 #include <cstddef>
 #include <cstdint>
+#include <memory>
+#include <mutex>
 #include <span>
 #include <string>
-#include <thread>
 #include <utility>
+#include <vector>
 #include "pipe_manager.hpp"
+#include "resampler.hpp"
 #include "tags_app.hpp"
 #include "tags_plugin_name.hpp"
 #include "util.hpp"
@@ -76,7 +80,22 @@ void on_process(void* userdata, spa_io_position* position) {
 
     d->pb->clock_start = std::chrono::system_clock::now();
 
-    d->pb->setup();
+    d->pb->initialized = false;
+  }
+
+  if (!d->pb->initialized && !d->pb->bypass && !d->pb->setting_up.exchange(true, std::memory_order_acquire)) {
+    // Skipped if warm_up() already did it for this configuration
+
+    if (d->pb->setup_rate != d->pb->rate || d->pb->setup_n_samples != d->pb->n_samples) {
+      d->pb->setup();
+
+      d->pb->setup_rate = d->pb->rate;
+      d->pb->setup_n_samples = d->pb->n_samples;
+    }
+
+    d->pb->initialized = true;
+
+    d->pb->setting_up.store(false, std::memory_order_release);
   }
 
   d->pb->delta_t = 0.001F * static_cast<float>(std::chrono::duration_cast<std::chrono::milliseconds>(
@@ -122,7 +141,24 @@ void on_process(void* userdata, spa_io_position* position) {
     right_out = d->pb->dummy_right;
   }
 
-  if (!d->pb->enable_probe) {
+  const auto collect_metrics = d->pb->collect_metrics.load(std::memory_order_relaxed);
+
+  std::chrono::time_point<std::chrono::steady_clock> process_start;
+
+  if (collect_metrics) {
+    process_start = std::chrono::steady_clock::now();
+  }
+
+  d->pb->receive_island();
+
+  if (d->pb->island_leader) {
+    d->pb->process_island(left_in, right_in, left_out, right_out);
+  } else if (d->pb->island_member) {
+    d->pb->follow_island(left_in, right_in, left_out, right_out);
+  } else if (!d->pb->initialized) {
+    std::ranges::copy(left_in, left_out.begin());
+    std::ranges::copy(right_in, right_out.begin());
+  } else if (!d->pb->enable_probe) {
     d->pb->process(left_in, right_in, left_out, right_out);
   } else {
     auto* probe_left = static_cast<float*>(pw_filter_get_dsp_buffer(d->probe_left, n_samples));
@@ -141,6 +177,13 @@ void on_process(void* userdata, spa_io_position* position) {
     }
   }
 
+  if (collect_metrics) {
+    const auto process_time = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - process_start);
+
+    d->pb->update_metrics(position->clock.position, static_cast<uint64_t>(process_time.count()));
+  }
+
   if (d->pb->send_notifications) {
     d->pb->clock_start = std::chrono::system_clock::now();
 
@@ -154,7 +197,7 @@ auto update_filter(struct spa_loop* loop, bool async, uint32_t seq, const void*
 
   spa_process_latency_info latency_info{};
 
-  latency_info.ns = static_cast<uint64_t>(self->latency_value * 1000000000.0F);
+  latency_info.ns = static_cast<uint64_t>(self->get_latency_seconds() * 1000000000.0F);
 
   std::array<char, 1024U> buffer{};
 
@@ -172,27 +215,33 @@ auto update_filter(struct spa_loop* loop, bool async, uint32_t seq, const void*
 void on_filter_state_changed(void* userdata, pw_filter_state old, pw_filter_state state, const char* error) {
   auto* d = static_cast<PluginBase::data*>(userdata);
 
-  d->pb->state = state;
-
-  switch (state) {
-    case PW_FILTER_STATE_ERROR:
-      d->pb->can_get_node_id = false;
-      break;
-    case PW_FILTER_STATE_UNCONNECTED:
-      d->pb->can_get_node_id = false;
-      break;
-    case PW_FILTER_STATE_CONNECTING:
-      d->pb->can_get_node_id = false;
-      break;
-    case PW_FILTER_STATE_STREAMING:
-      d->pb->can_get_node_id = true;
-      break;
-    case PW_FILTER_STATE_PAUSED:
-      d->pb->can_get_node_id = true;
-      break;
-    default:
-      break;
+  {
+    std::scoped_lock<std::mutex> lock(d->pb->state_mutex);
+
+    d->pb->state = state;
+
+    switch (state) {
+      case PW_FILTER_STATE_ERROR:
+        d->pb->can_get_node_id = false;
+        break;
+      case PW_FILTER_STATE_UNCONNECTED:
+        d->pb->can_get_node_id = false;
+        break;
+      case PW_FILTER_STATE_CONNECTING:
+        d->pb->can_get_node_id = false;
+        break;
+      case PW_FILTER_STATE_STREAMING:
+        d->pb->can_get_node_id = true;
+        break;
+      case PW_FILTER_STATE_PAUSED:
+        d->pb->can_get_node_id = true;
+        break;
+      default:
+        break;
+    }
   }
+
+  d->pb->state_cv.notify_all();
 }
 
 const struct pw_filter_events filter_events = {.state_changed = on_filter_state_changed, .process = on_process};
@@ -227,6 +276,10 @@ PluginBase::PluginBase(std::string tag,
                                               auto* self = static_cast<PluginBase*>(user_data);
 
                                               self->bypass = g_settings_get_boolean(settings, "bypass") != 0;
+
+                                              if (!self->bypass) {
+                                                self->warm_up();
+                                              }
                                             }),
                                             this));
   } else if (name == "output_level") {
@@ -340,6 +393,12 @@ PluginBase::~PluginBase() {
 
   pm->sync_wait_unlock();
 
+  // The filter is gone, so the realtime thread can not be using any of these anymore
+
+  delete island_pending.exchange(nullptr);
+  delete island_retired.exchange(nullptr);
+  delete island_state;
+
   for (auto& handler_id : gconnections) {
     g_signal_handler_disconnect(settings, handler_id);
   }
@@ -350,7 +409,41 @@ PluginBase::~PluginBase() {
 }
 
 void PluginBase::set_post_messages(const bool& state) {
-  post_messages = state;
+  ui_post_messages = state;
+
+  post_messages = ui_post_messages || collect_metrics;
+}
+
+void PluginBase::set_export_metrics(const bool& state) {
+  collect_metrics = state;
+
+  // The exporter needs the level meters even when no window is showing them.
+
+  post_messages = ui_post_messages || collect_metrics;
+}
+
+void PluginBase::update_metrics(const uint64_t& clock_position, const uint64_t& process_time_ns) {
+  if (expected_clock_position != 0U && clock_position != expected_clock_position) {
+    xruns.fetch_add(1U, std::memory_order_relaxed);
+  }
+
+  expected_clock_position = clock_position + n_samples;
+
+  dsp_time_ns.fetch_add(process_time_ns, std::memory_order_relaxed);
+
+  window_dsp_time_ns += process_time_ns;
+
+  if (rate != 0U) {
+    window_audio_time_ns += static_cast<uint64_t>(n_samples) * 1000000000U / rate;
+  }
+
+  if (send_notifications && window_audio_time_ns > 0U) {
+    dsp_load.store(static_cast<float>(window_dsp_time_ns) / static_cast<float>(window_audio_time_ns),
+                   std::memory_order_relaxed);
+
+    window_dsp_time_ns = 0U;
+    window_audio_time_ns = 0U;
+  }
 }
 
 void PluginBase::reset_settings() {
@@ -358,9 +451,18 @@ void PluginBase::reset_settings() {
 }
 
 auto PluginBase::connect_to_pw() -> bool {
+  return request_pw_connection() && wait_pw_connection();
+}
+
+auto PluginBase::request_pw_connection() -> bool {
   connected_to_pw = false;
-  can_get_node_id = false;
-  state = PW_FILTER_STATE_UNCONNECTED;
+
+  {
+    std::scoped_lock<std::mutex> lock(state_mutex);
+
+    can_get_node_id = false;
+    state = PW_FILTER_STATE_UNCONNECTED;
+  }
 
   pm->lock();
 
@@ -376,8 +478,19 @@ auto PluginBase::connect_to_pw() -> bool {
 
   pm->sync_wait_unlock();
 
-  while (!can_get_node_id) {
-    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  return true;
+}
+
+auto PluginBase::wait_pw_connection() -> bool {
+  {
+    std::unique_lock<std::mutex> lock(state_mutex);
+
+    if (!state_cv.wait_for(lock, PipeManager::wait_timeout,
+                           [this]() { return can_get_node_id || state == PW_FILTER_STATE_ERROR; })) {
+      util::warning(log_tag + name + " took too long to connect to PipeWire");
+
+      return false;
+    }
 
     if (state == PW_FILTER_STATE_ERROR) {
       util::warning(log_tag + name + " is in an error");
@@ -397,8 +510,10 @@ auto PluginBase::connect_to_pw() -> bool {
     wait until the information about their ports is available in PipeManager's list_ports vector.
   */
 
-  while (pm->count_node_ports(node_id) != n_ports) {
-    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  if (!pm->wait_node_ports(node_id, n_ports)) {
+    util::warning(log_tag + name + " ports are taking too long to be available");
+
+    return false;
   }
 
   connected_to_pw = true;
@@ -441,6 +556,28 @@ void PluginBase::disconnect_from_pw() {
 
 void PluginBase::setup() {}
 
+void PluginBase::warm_up() {
+  if (initialized || rate == 0U || setting_up.exchange(true, std::memory_order_acquire)) {
+    return;
+  }
+
+  const auto r = rate;
+  const auto n = n_samples;
+
+  if (setup_rate != r || setup_n_samples != n) {
+    util::debug(log_tag + name + " warming up");
+
+    setup();
+
+    setup_rate = r;
+    setup_n_samples = n;
+  }
+
+  // The realtime thread marks the plugin as initialized in its next cycle
+
+  setting_up.store(false, std::memory_order_release);
+}
+
 void PluginBase::process(std::span<float>& left_in,
                          std::span<float>& right_in,
                          std::span<float>& left_out,
@@ -457,6 +594,10 @@ auto PluginBase::get_latency_seconds() -> float {
   return 0.0F;
 }
 
+auto PluginBase::get_island_latency_seconds() const -> float {
+  return native_latency_value + (island_leader ? island_latency_value : 0.0F);
+}
+
 void PluginBase::show_native_ui() {
   if (lv2_wrapper == nullptr) {
     return;
@@ -539,14 +680,15 @@ void PluginBase::apply_gain(std::span<float>& left, std::span<float>& right, con
 }
 
 void PluginBase::notify() {
-  const auto input_peak_db_l = util::linear_to_db(input_peak_left);
-  const auto input_peak_db_r = util::linear_to_db(input_peak_right);
+  input_level_left_db.store(util::linear_to_db(input_peak_left), std::memory_order_relaxed);
+  input_level_right_db.store(util::linear_to_db(input_peak_right), std::memory_order_relaxed);
+
+  output_level_left_db.store(util::linear_to_db(output_peak_left), std::memory_order_relaxed);
+  output_level_right_db.store(util::linear_to_db(output_peak_right), std::memory_order_relaxed);
 
-  const auto output_peak_db_l = util::linear_to_db(output_peak_left);
-  const auto output_peak_db_r = util::linear_to_db(output_peak_right);
+  // Plugin specific meters are written before calling notify(), so releasing the serial publishes them as well.
 
-  input_level.emit(input_peak_db_l, input_peak_db_r);
-  output_level.emit(output_peak_db_l, output_peak_db_r);
+  meters_serial.fetch_add(1U, std::memory_order_release);
 
   input_peak_left = util::minimum_linear_level;
   input_peak_right = util::minimum_linear_level;
@@ -556,6 +698,233 @@ void PluginBase::notify() {
 
 void PluginBase::update_probe_links() {}
 
+auto PluginBase::get_native_rate() const -> uint {
+  return 0U;
+}
+
+void PluginBase::process_native(std::span<float>& left_in,
+                                std::span<float>& right_in,
+                                std::span<float>& left_out,
+                                std::span<float>& right_out) {}
+
+void PluginBase::set_island(const std::vector<std::shared_ptr<PluginBase>>& members) {
+  // Whatever the realtime thread gave back since the last call is freed here
+
+  delete island_retired.exchange(nullptr, std::memory_order_acquire);
+
+  if (members == island) {
+    return;
+  }
+
+  island = members;
+
+  if (island.empty()) {
+    island_leader = false;
+
+    publish_island();
+  } else {
+    publish_island();
+
+    island_leader = true;
+  }
+}
+
+void PluginBase::publish_island() {
+  delete island_retired.exchange(nullptr, std::memory_order_acquire);
+
+  auto* next = new Island();
+
+  next->members = island;
+
+  next->rate = rate;
+  next->n_samples = n_samples;
+
+  const auto native_rate = get_native_rate();
+
+  island_latency_value = 0.0F;
+
+  if (!island.empty() && rate != 0U && n_samples != 0U) {
+    auto max_native_frames = static_cast<size_t>(n_samples);
+
+    if (native_rate != rate) {
+      next->resampler_inL = std::make_unique<Resampler>(rate, native_rate);
+      next->resampler_inR = std::make_unique<Resampler>(rate, native_rate);
+      next->resampler_outL = std::make_unique<Resampler>(native_rate, rate);
+      next->resampler_outR = std::make_unique<Resampler>(native_rate, rate);
+
+      max_native_frames = next->resampler_inL->get_max_output_frames(n_samples);
+
+      next->out_L.resize(next->resampler_outL->get_max_output_frames(max_native_frames));
+      next->out_R.resize(next->resampler_outR->get_max_output_frames(max_native_frames));
+
+      /*
+        The number of frames coming back from the resamplers changes a little from one cycle to the next. Starting
+        the fifo with a few silent frames keeps it from running dry.
+      */
+
+      constexpr auto headroom_frames = 8U;
+
+      next->fifo_L.resize(n_samples + next->out_L.size() + headroom_frames);
+      next->fifo_R.resize(n_samples + next->out_R.size() + headroom_frames);
+
+      next->fifo_L.push_silence(headroom_frames);
+      next->fifo_R.push_silence(headroom_frames);
+
+      const auto latency_frames = next->resampler_outL->get_latency_frames() +
+                                  next->resampler_inL->get_latency_frames() * rate / native_rate + headroom_frames;
+
+      island_latency_value = static_cast<float>(latency_frames) / static_cast<float>(rate);
+    }
+
+    for (auto& buffer : next->buffer_L) {
+      buffer.resize(max_native_frames);
+    }
+
+    for (auto& buffer : next->buffer_R) {
+      buffer.resize(max_native_frames);
+    }
+  }
+
+  // A state the realtime thread did not take yet was never seen by it
+
+  delete island_pending.exchange(next, std::memory_order_acq_rel);
+}
+
+void PluginBase::receive_island() {
+  if (island_pending.load(std::memory_order_relaxed) == nullptr) {
+    return;
+  }
+
+  auto* next = island_pending.exchange(nullptr, std::memory_order_acq_rel);
+
+  if (next == nullptr) {
+    return;
+  }
+
+  /*
+    The main thread empties island_retired before every publish_island(), and a state is only retired here when a
+    new one arrives, so nothing is overwritten.
+  */
+
+  if (island_state != nullptr) {
+    island_retired.store(island_state, std::memory_order_release);
+  }
+
+  island_state = next;
+}
+
+void PluginBase::process_island(std::span<float>& left_in,
+                                std::span<float>& right_in,
+                                std::span<float>& left_out,
+                                std::span<float>& right_out) {
+  auto* state = island_state;
+
+  if (state == nullptr || state->members.empty() || state->rate != rate || state->n_samples != n_samples) {
+    // Built for another rate or quantum. The audio passes through until the main thread sends a new one.
+
+    std::ranges::copy(left_in, left_out.begin());
+    std::ranges::copy(right_in, right_out.begin());
+
+    if (!island_rebuild_requested.exchange(true, std::memory_order_relaxed)) {
+      util::idle_add([this] {
+        island_rebuild_requested.store(false, std::memory_order_relaxed);
+
+        if (island.empty()) {
+          return;
+        }
+
+        publish_island();
+
+        if (post_messages && !latency.empty()) {
+          latency.emit();
+        }
+
+        update_filter_params();
+      });
+    }
+
+    return;
+  }
+
+  // Both channels go through identical resamplers, so they always produce the same number of frames
+
+  auto n_native = left_in.size();
+
+  if (state->resampler_inL != nullptr) {
+    n_native = state->resampler_inL->process(left_in, state->buffer_L[0]);
+
+    state->resampler_inR->process(right_in, state->buffer_R[0]);
+  } else {
+    std::ranges::copy(left_in, state->buffer_L[0].begin());
+    std::ranges::copy(right_in, state->buffer_R[0].begin());
+  }
+
+  uint current = 0U;
+
+  const auto run_member = [&](PluginBase* member) {
+    if (!member->initialized || member->bypass) {
+      return;
+    }
+
+    std::span<float> l_in(state->buffer_L[current].data(), n_native);
+    std::span<float> r_in(state->buffer_R[current].data(), n_native);
+    std::span<float> l_out(state->buffer_L[1U - current].data(), n_native);
+    std::span<float> r_out(state->buffer_R[1U - current].data(), n_native);
+
+    member->process_native(l_in, r_in, l_out, r_out);
+
+    current = 1U - current;
+  };
+
+  run_member(this);
+
+  for (auto& member : state->members) {
+    run_member(member.get());
+  }
+
+  const std::span<const float> processed_l(state->buffer_L[current].data(), n_native);
+  const std::span<const float> processed_r(state->buffer_R[current].data(), n_native);
+
+  if (state->resampler_outL == nullptr) {
+    std::ranges::copy(processed_l, left_out.begin());
+    std::ranges::copy(processed_r, right_out.begin());
+  } else {
+    const auto n_out = state->resampler_outL->process(processed_l, state->out_L);
+
+    state->resampler_outR->process(processed_r, state->out_R);
+
+    state->fifo_L.push(std::span<const float>(state->out_L.data(), n_out));
+    state->fifo_R.push(std::span<const float>(state->out_R.data(), n_out));
+
+    const auto count = std::min(state->fifo_L.size(), left_out.size());
+    const auto offset = left_out.size() - count;
+
+    std::fill(left_out.begin(), left_out.begin() + offset, 0.0F);
+    std::fill(right_out.begin(), right_out.begin() + offset, 0.0F);
+
+    state->fifo_L.pop(left_out.subspan(offset, count));
+    state->fifo_R.pop(right_out.subspan(offset, count));
+  }
+
+  if (post_messages && send_notifications) {
+    notify();
+  }
+}
+
+void PluginBase::follow_island(std::span<float>& left_in,
+                               std::span<float>& right_in,
+                               std::span<float>& left_out,
+                               std::span<float>& right_out) {
+  // The leader already ran this plugin on the resampled audio. Only its meters are left to be published here.
+
+  std::ranges::copy(left_in, left_out.begin());
+  std::ranges::copy(right_in, right_out.begin());
+
+  if (post_messages && send_notifications) {
+    notify();
+  }
+}
+
 void PluginBase::update_filter_params() {
   pw_loop_invoke(pw_thread_loop_get_loop(pm->thread_loop), update_filter, 1, nullptr, 0, false, this);
 }
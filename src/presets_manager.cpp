@@ -53,6 +53,7 @@
 #include "expander_preset.hpp"
 #include "filter_preset.hpp"
 #include "gate_preset.hpp"
+#include "generic_lv2_preset.hpp"
 #include "level_meter_preset.hpp"
 #include "limiter_preset.hpp"
 #include "loudness_preset.hpp"
@@ -1270,6 +1271,10 @@ auto PresetsManager::create_wrapper(const PresetType& preset_type, std::string_v
     return std::make_unique<GatePreset>(preset_type, instance_id);
   }
 
+  if (filter_name.starts_with(tags::plugin_name::generic_lv2)) {
+    return std::make_unique<GenericLv2Preset>(preset_type, instance_id);
+  }
+
   if (filter_name.starts_with(tags::plugin_name::level_meter)) {
     return std::make_unique<LevelMeterPreset>(preset_type, instance_id);
   }
@@ -19,11 +19,32 @@
 
 #include "resampler.hpp"
 #include <samplerate.h>
+#include <sys/types.h>
+#include <cmath>
+#include <cstddef>
+#include <span>
+#include <vector>
 
-Resampler::Resampler(const int& input_rate, const int& output_rate) : output(1, 0) {
+Resampler::Resampler(const int& input_rate, const int& output_rate, const ResamplerQuality& quality) : output(1, 0) {
   resample_ratio = static_cast<double>(output_rate) / static_cast<double>(input_rate);
 
-  src_state = src_new(SRC_SINC_FASTEST, 1, nullptr);
+  switch (quality) {
+    case ResamplerQuality::fastest:
+      converter_type = SRC_SINC_FASTEST;
+      break;
+    case ResamplerQuality::medium:
+      converter_type = SRC_SINC_MEDIUM_QUALITY;
+      break;
+    case ResamplerQuality::best:
+      converter_type = SRC_SINC_BEST_QUALITY;
+      break;
+  }
+
+  int error = 0;
+
+  src_state = src_new(converter_type, 1, &error);
+
+  measure_latency();
 }
 
 Resampler::~Resampler() {
@@ -31,3 +52,102 @@ Resampler::~Resampler() {
     src_delete(src_state);
   }
 }
+
+auto Resampler::process(const std::span<const float>& input, const std::span<float>& out, const bool& end_of_input)
+    -> size_t {
+  if (src_state == nullptr) {
+    return 0U;
+  }
+
+  // The number of frames of data pointed to by data_in
+  src_data.input_frames = static_cast<long>(input.size());
+
+  // A pointer to the input data samples
+  src_data.data_in = input.data();
+
+  // Maximum number of frames pointed to by data_out
+  src_data.output_frames = static_cast<long>(out.size());
+
+  // A pointer to the output data samples
+  src_data.data_out = out.data();
+
+  // Equal to output_sample_rate / input_sample_rate
+  src_data.src_ratio = resample_ratio;
+
+  // Equal to 0 if more input data is available and 1 otherwise
+  src_data.end_of_input = static_cast<int>(end_of_input);
+
+  src_process(src_state, &src_data);
+
+  return static_cast<size_t>(src_data.output_frames_gen);
+}
+
+auto Resampler::get_max_output_frames(const size_t& n_input_frames) const -> size_t {
+  // The converter keeps some frames between calls, so one call can produce a little more than the ratio says
+
+  return static_cast<size_t>(std::ceil(1.5 * resample_ratio * static_cast<double>(n_input_frames))) + 1U;
+}
+
+auto Resampler::get_latency_frames() const -> uint {
+  return latency_frames;
+}
+
+void Resampler::measure_latency() {
+  /*
+    libsamplerate does not tell the length of its filters. So an impulse is sent through a converter of the same kind
+    and the delay is the position of the peak in the output.
+  */
+
+  int error = 0;
+
+  auto* state = src_new(converter_type, 1, &error);
+
+  if (state == nullptr) {
+    return;
+  }
+
+  constexpr size_t block_size = 1024U;
+  constexpr size_t max_blocks = 64U;
+
+  std::vector<float> impulse(block_size, 0.0F);
+  std::vector<float> response(get_max_output_frames(block_size));
+
+  impulse[0] = 1.0F;
+
+  SRC_DATA data{};
+
+  float peak = 0.0F;
+  size_t peak_position = 0U;
+  size_t position = 0U;
+
+  for (size_t n = 0U; n < max_blocks; n++) {
+    data.data_in = impulse.data();
+    data.input_frames = static_cast<long>(impulse.size());
+    data.data_out = response.data();
+    data.output_frames = static_cast<long>(response.size());
+    data.src_ratio = resample_ratio;
+    data.end_of_input = 0;
+
+    if (src_process(state, &data) != 0) {
+      break;
+    }
+
+    for (long i = 0; i < data.output_frames_gen; i++, position++) {
+      if (std::fabs(response[i]) > peak) {
+        peak = std::fabs(response[i]);
+        peak_position = position;
+      }
+    }
+
+    impulse[0] = 0.0F;
+
+    // The response of the filters is much shorter than this
+    if (peak > 0.0F && position > peak_position + block_size) {
+      break;
+    }
+  }
+
+  src_delete(state);
+
+  latency_frames = static_cast<uint>(peak_position);
+}
@@ -24,17 +24,24 @@
 #ifdef ENABLE_RNNOISE
 #include <rnnoise.h>
 #endif
+#include <pthread.h>
+#include <sched.h>
 #include <sys/types.h>
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cmath>
-#include <cstdio>
 #include <memory>
 #include <mutex>
 #include <span>
 #include <string>
+#include <thread>
+#include <vector>
 #include "pipe_manager.hpp"
 #include "plugin_base.hpp"
 #include "resampler.hpp"
+#include "ring_buffer.hpp"
+#include "rnnoise_model_cache.hpp"
 #include "tags_plugin_name.hpp"
 #include "tags_resources.hpp"
 #include "util.hpp"
@@ -53,11 +60,14 @@ RNNoise::RNNoise(const std::string& tag,
                  pipe_type),
       enable_vad(g_settings_get_boolean(settings, "enable-vad")),
       vad_thres(g_settings_get_double(settings, "vad-thres") / 100.0F),
+      linked_mono(g_settings_get_boolean(settings, "linked-mono") != 0),
       data_L(0),
       data_R(0) {
   data_L.reserve(blocksize);
   data_R.reserve(blocksize);
-  data_tmp.reserve(blocksize);
+  data_tmp_L.resize(blocksize);
+  data_tmp_R.resize(blocksize);
+  worker_data_R.resize(blocksize);
 
   // Initialize directories for local and community models
   local_dir_rnnoise = std::string{g_get_user_config_dir()} + "/easyeffects/rnnoise";
@@ -84,23 +94,13 @@ RNNoise::RNNoise(const std::string& tag,
                                           G_CALLBACK(+[](GSettings* settings, char* key, gpointer user_data) {
                                             auto* self = static_cast<RNNoise*>(user_data);
 
-                                            self->data_mutex.lock();
-
-                                            self->rnnoise_ready = false;
-
-                                            self->data_mutex.unlock();
-
 #ifdef ENABLE_RNNOISE
-                                            self->free_rnnoise();
+                                            // The current model keeps running until the new one is ready
 
-                                            auto* m = self->get_model_from_name();
+                                            const auto generation = ++self->model_generation;
 
-                                            self->model = m;
-
-                                            self->state_left = rnnoise_create(self->model);
-                                            self->state_right = rnnoise_create(self->model);
-
-                                            self->rnnoise_ready = true;
+                                            self->mythreads.emplace_back(  // Using emplace_back here makes sense
+                                                [self, generation]() { self->load_model(generation); });
 #endif
                                           }),
                                           this));
@@ -117,6 +117,18 @@ RNNoise::RNNoise(const std::string& tag,
                                           }),
                                           this));
 
+  gconnections.push_back(g_signal_connect(settings, "changed::linked-mono",
+                                          G_CALLBACK(+[](GSettings* settings, char* key, RNNoise* self) {
+                                            self->linked_mono = g_settings_get_boolean(settings, key) != 0;
+
+                                            if (self->linked_mono) {
+                                              self->stop_worker();
+                                            } else {
+                                              self->start_worker();
+                                            }
+                                          }),
+                                          this));
+
   g_signal_connect(settings, "changed::vad-thres", G_CALLBACK(+[](GSettings* settings, char* key, gpointer user_data) {
                      auto self = static_cast<RNNoise*>(user_data);
 
@@ -141,19 +153,16 @@ RNNoise::RNNoise(const std::string& tag,
                    }),
                    this);
 
-  auto* m = get_model_from_name();
-
-  model = m;
-
-  state_left = rnnoise_create(model);
-  state_right = rnnoise_create(model);
+  load_model(model_generation);
 
   vad_prob_left = 1.0F;
   vad_prob_right = 1.0F;
   vad_grace_left = release;
   vad_grace_right = release;
 
-  rnnoise_ready = true;
+  if (!linked_mono) {
+    start_worker();
+  }
 #else
   util::warning("The RNNoise library was not available at compilation time. The noise reduction filter won't work");
 
@@ -166,6 +175,16 @@ RNNoise::~RNNoise() {
     disconnect_from_pw();
   }
 
+#ifdef ENABLE_RNNOISE
+  for (auto& t : mythreads) {
+    t.join();
+  }
+
+  mythreads.clear();
+
+  stop_worker();
+#endif
+
   std::scoped_lock<std::mutex> lock(data_mutex);
 
   resampler_ready = false;
@@ -189,15 +208,30 @@ void RNNoise::setup() {
   data_L.resize(0U);
   data_R.resize(0U);
 
-  deque_out_L.resize(0U);
-  deque_out_R.resize(0U);
-
   resampler_inL = std::make_unique<Resampler>(rate, rnnoise_rate);
   resampler_inR = std::make_unique<Resampler>(rate, rnnoise_rate);
 
   resampler_outL = std::make_unique<Resampler>(rnnoise_rate, rate);
   resampler_outR = std::make_unique<Resampler>(rnnoise_rate, rate);
 
+  // RNNoise hands back whole blocks, so at most one block more than what came in can be waiting to be resampled
+
+  resampled_data_L.reserve(resampler_inL->get_max_output_frames(n_samples) + blocksize);
+  resampled_data_R.reserve(resampler_inR->get_max_output_frames(n_samples) + blocksize);
+
+  /*
+    Each cycle adds at most one block more than the quantum, at the graph rate or at 48 kHz inside an island, while a
+    whole quantum is taken out. Twice that leaves room for the zero padding done by pop_output().
+  */
+
+  const auto max_native_frames = resampler_inL->get_max_output_frames(n_samples);
+
+  const auto max_out_frames =
+      std::max(max_native_frames, resampler_outL->get_max_output_frames(max_native_frames + blocksize));
+
+  out_L.resize(2U * (max_out_frames + blocksize));
+  out_R.resize(2U * (max_out_frames + blocksize));
+
   resampler_ready = true;
 }
 
@@ -220,8 +254,8 @@ void RNNoise::process(std::span<float>& left_in,
 
   if (resample) {
     if (resampler_ready) {
-      const auto resampled_inL = resampler_inL->process(left_in, false);
-      const auto resampled_inR = resampler_inR->process(right_in, false);
+      const auto& resampled_inL = resampler_inL->process(left_in, false);
+      const auto& resampled_inR = resampler_inR->process(right_in, false);
 
       resampled_data_L.resize(0U);
       resampled_data_R.resize(0U);
@@ -230,45 +264,70 @@ void RNNoise::process(std::span<float>& left_in,
       remove_noise(resampled_inL, resampled_inR, resampled_data_L, resampled_data_R);
 #endif
 
-      auto resampled_outL = resampler_outL->process(resampled_data_L, false);
-      auto resampled_outR = resampler_outR->process(resampled_data_R, false);
-
-      for (const auto& v : resampled_outL) {
-        deque_out_L.push_back(v);
-      }
+      const auto& resampled_outL = resampler_outL->process(resampled_data_L, false);
+      const auto& resampled_outR = resampler_outR->process(resampled_data_R, false);
 
-      for (const auto& v : resampled_outR) {
-        deque_out_R.push_back(v);
-      }
+      out_L.push(resampled_outL);
+      out_R.push(resampled_outR);
     } else {
-      for (const auto& v : left_in) {
-        deque_out_L.push_back(v);
-      }
-
-      for (const auto& v : right_in) {
-        deque_out_R.push_back(v);
-      }
+      out_L.push(left_in);
+      out_R.push(right_in);
     }
   } else {
 #ifdef ENABLE_RNNOISE
-    remove_noise(left_in, right_in, deque_out_L, deque_out_R);
+    remove_noise(left_in, right_in, out_L, out_R);
 #endif
   }
 
-  if (deque_out_L.size() >= left_out.size()) {
-    for (float& v : left_out) {
-      v = deque_out_L.front();
+  pop_output(left_out, right_out, rate);
+
+  if (post_messages) {
+    get_peaks(left_in, right_in, left_out, right_out);
 
-      deque_out_L.pop_front();
+    if (send_notifications) {
+      notify();
     }
+  }
+}
 
-    for (float& v : right_out) {
-      v = deque_out_R.front();
+void RNNoise::process_native(std::span<float>& left_in,
+                             std::span<float>& right_in,
+                             std::span<float>& left_out,
+                             std::span<float>& right_out) {
+  std::scoped_lock<std::mutex> lock(data_mutex);
 
-      deque_out_R.pop_front();
-    }
+  if (!rnnoise_ready) {
+    std::copy(left_in.begin(), left_in.end(), left_out.begin());
+    std::copy(right_in.begin(), right_in.end(), right_out.begin());
+
+    return;
+  }
+
+  if (input_gain != 1.0F) {
+    apply_gain(left_in, right_in, input_gain);
+  }
+
+#ifdef ENABLE_RNNOISE
+  remove_noise(left_in, right_in, out_L, out_R);
+#endif
+
+  pop_output(left_out, right_out, rnnoise_rate);
+
+  if (post_messages) {
+    get_peaks(left_in, right_in, left_out, right_out);
+  }
+}
+
+auto RNNoise::get_native_rate() const -> uint {
+  return rnnoise_rate;
+}
+
+void RNNoise::pop_output(std::span<float>& left_out, std::span<float>& right_out, const uint& output_rate) {
+  if (out_L.size() >= left_out.size()) {
+    out_L.pop(left_out);
+    out_R.pop(right_out);
   } else {
-    const uint offset = 2U * (left_out.size() - deque_out_L.size());
+    const uint offset = 2U * (left_out.size() - out_L.size());
 
     if (offset != latency_n_frames) {
       latency_n_frames = offset;
@@ -276,18 +335,13 @@ void RNNoise::process(std::span<float>& left_in,
       notify_latency = true;
     }
 
-    for (uint n = 0U; !deque_out_L.empty() && n < left_out.size(); n++) {
-      if (n < offset) {
-        left_out[n] = 0.0F;
-        right_out[n] = 0.0F;
-      } else {
-        left_out[n] = deque_out_L.front();
-        right_out[n] = deque_out_R.front();
+    const auto n_zeros = std::min<size_t>(offset, left_out.size());
 
-        deque_out_R.pop_front();
-        deque_out_L.pop_front();
-      }
-    }
+    std::fill_n(left_out.begin(), n_zeros, 0.0F);
+    std::fill_n(right_out.begin(), n_zeros, 0.0F);
+
+    out_L.pop(left_out.subspan(n_zeros));
+    out_R.pop(right_out.subspan(n_zeros));
   }
 
   if (output_gain != 1.0F) {
@@ -295,7 +349,11 @@ void RNNoise::process(std::span<float>& left_in,
   }
 
   if (notify_latency) {
-    latency_value = static_cast<float>(latency_n_frames) / static_cast<float>(rate);
+    latency_value = static_cast<float>(latency_n_frames) / static_cast<float>(output_rate);
+
+    if (output_rate == rnnoise_rate) {
+      native_latency_value = latency_value;
+    }
 
     util::debug(log_tag + name + " latency: " + util::to_string(latency_value, "") + " s");
 
@@ -311,14 +369,6 @@ void RNNoise::process(std::span<float>& left_in,
 
     notify_latency = false;
   }
-
-  if (post_messages) {
-    get_peaks(left_in, right_in, left_out, right_out);
-
-    if (send_notifications) {
-      notify();
-    }
-  }
 }
 
 auto RNNoise::search_model_path(const std::string& name) -> std::string {
@@ -354,53 +404,39 @@ auto RNNoise::search_model_path(const std::string& name) -> std::string {
 
 #ifdef ENABLE_RNNOISE
 
-auto RNNoise::get_model_from_name() -> RNNModel* {
-  RNNModel* m = nullptr;
+auto RNNoise::get_model_from_name() -> std::pair<std::shared_ptr<RNNModel>, bool> {
+  std::shared_ptr<RNNModel> m;
 
   const auto name = util::gsettings_get_string(settings, "model-name");
 
   // Standard Model
   if (name.empty()) {
-    standard_model = true;
-
     util::warning(log_tag + " empty model name set, using the standard model");
 
-    model_changed.emit(false);
-
-    return m;
+    return {m, false};
   }
 
   const auto path = search_model_path(name);
 
   // Standard Model
   if (path.empty()) {
-    standard_model = true;
-
     util::debug(log_tag + name + " model does not exist on the filesystem, using the standard model.");
 
-    model_changed.emit(false);
-
-    return m;
+    return {m, false};
   }
 
   // Custom Model
   util::debug(log_tag + name + " loading custom model from path: " + path);
 
-  if (FILE* f = fopen(path.c_str(), "r"); f != nullptr) {
-    m = rnnoise_model_from_file(f);
+  m = RNNoiseModelCache::get().load(path);
 
-    fclose(f);
-  }
+  const auto load_error = (m == nullptr);
 
-  standard_model = (m == nullptr);
-
-  if (standard_model) {
+  if (load_error) {
     util::warning(log_tag + name + " failed to load the custom model. Using the standard one.");
   }
 
-  model_changed.emit(standard_model);
-
-  return m;
+  return {m, load_error};
 }
 
 void RNNoise::free_rnnoise() {
@@ -414,19 +450,192 @@ void RNNoise::free_rnnoise() {
     rnnoise_destroy(state_right);
   }
 
-  if (model != nullptr) {
-    rnnoise_model_free(model);
-  }
-
   state_left = nullptr;
   state_right = nullptr;
-  model = nullptr;
+
+  model.reset();
+}
+
+void RNNoise::load_model(const uint& generation) {
+  auto [m, load_error] = get_model_from_name();
+
+  const auto standard = (m == nullptr);
+
+  auto* new_state_left = rnnoise_create(m.get());
+  auto* new_state_right = rnnoise_create(m.get());
+
+  data_mutex.lock();
+
+  const auto current = generation == model_generation;
+
+  if (current) {
+    std::swap(state_left, new_state_left);
+    std::swap(state_right, new_state_right);
+    std::swap(model, m);
+
+    rnnoise_ready = true;
+  }
+
+  data_mutex.unlock();
+
+  if (current) {
+    util::idle_add([this, generation, standard, error = load_error]() {
+      if (generation != model_generation) {
+        return;
+      }
+
+      standard_model = standard;
+
+      model_changed.emit(error);
+    });
+  }
+
+  // Either the replaced states or the new ones if a newer model was requested in the meantime
+
+  if (new_state_left != nullptr) {
+    rnnoise_destroy(new_state_left);
+  }
+
+  if (new_state_right != nullptr) {
+    rnnoise_destroy(new_state_right);
+  }
+}
+
+void RNNoise::denoise_block(DenoiseState* state,
+                            std::vector<float>& data,
+                            std::vector<float>& data_tmp,
+                            float& vad_prob,
+                            int& vad_grace) {
+  if (state == nullptr) {
+    return;
+  }
+
+  std::ranges::for_each(data, [](auto& v) { v *= static_cast<float>(SHRT_MAX + 1); });
+
+  std::ranges::copy(data, data_tmp.begin());
+
+  vad_prob = rnnoise_process_frame(state, data.data(), data.data());
+
+  if (enable_vad) {
+    if (vad_prob >= vad_thres) {
+      vad_grace = release;
+    }
+
+    if (vad_grace < 0) {
+      std::ranges::fill(data, 0.0F);
+
+      return;
+    }
+
+    --vad_grace;
+  }
+
+  for (size_t i = 0U; i < data.size(); i++) {
+    data[i] = data[i] * wet_ratio + data_tmp[i] * (1.0F - wet_ratio);
+
+    data[i] *= inv_short_max;
+  }
+}
+
+void RNNoise::worker_loop() {
+  sched_param param{};
+
+  param.sched_priority = 1;
+
+  if (pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) != 0) {
+    util::debug(log_tag + name + " could not give realtime priority to the worker");
+  }
+
+  while (!worker_quit) {
+    const auto serial = worker_serial.load(std::memory_order_acquire);
+
+    // The realtime thread may have taken the job back already. Whoever moves it out of pending owns it.
+
+    auto expected = job_pending;
+
+    if (worker_job.compare_exchange_strong(expected, job_busy, std::memory_order_acq_rel)) {
+      denoise_block(state_right, worker_data_R, data_tmp_R, vad_prob_right, vad_grace_right);
+
+      worker_job.store(job_idle, std::memory_order_release);
+      worker_job.notify_one();
+    }
+
+    worker_serial.wait(serial, std::memory_order_acquire);
+  }
+}
+
+void RNNoise::start_worker() {
+  if (worker.joinable()) {
+    return;
+  }
+
+  worker_quit = false;
+
+  worker = std::thread([this]() { worker_loop(); });
+
+  worker_running.store(true, std::memory_order_release);
+}
+
+void RNNoise::stop_worker() {
+  if (!worker.joinable()) {
+    return;
+  }
+
+  worker_running.store(false, std::memory_order_release);
+
+  worker_quit = true;
+
+  worker_serial.fetch_add(1U, std::memory_order_release);
+  worker_serial.notify_one();
+
+  worker.join();
+}
+
+void RNNoise::denoise_stereo_block() {
+  if (!worker_running.load(std::memory_order_acquire)) {
+    denoise_block(state_left, data_L, data_tmp_L, vad_prob_left, vad_grace_left);
+    denoise_block(state_right, data_R, data_tmp_R, vad_prob_right, vad_grace_right);
+
+    return;
+  }
+
+  std::ranges::copy(data_R, worker_data_R.begin());
+
+  worker_job.store(job_pending, std::memory_order_release);
+
+  worker_serial.fetch_add(1U, std::memory_order_release);
+  worker_serial.notify_one();
+
+  denoise_block(state_left, data_L, data_tmp_L, vad_prob_left, vad_grace_left);
+
+  // Only a job the worker has not claimed yet is waited for with a deadline
+
+  const auto deadline = std::chrono::steady_clock::now() + max_worker_wait;
+
+  while (worker_job.load(std::memory_order_acquire) == job_pending && std::chrono::steady_clock::now() < deadline) {
+  }
+
+  auto expected = job_pending;
+
+  if (worker_job.compare_exchange_strong(expected, job_idle, std::memory_order_acq_rel)) {
+    // The worker never started it
+
+    denoise_block(state_right, data_R, data_tmp_R, vad_prob_right, vad_grace_right);
+
+    return;
+  }
+
+  // Once claimed the block is already being denoised on a realtime thread, so it is finished rather than dropped
+
+  worker_job.wait(job_busy, std::memory_order_acquire);
+
+  std::ranges::copy(worker_data_R, data_R.begin());
 }
 
 #endif
 
 auto RNNoise::get_latency_seconds() -> float {
-  return latency_value;
+  return (island_leader || island_member) ? get_island_latency_seconds() : latency_value;
 }
 
 void RNNoise::init_release() {
@@ -0,0 +1,79 @@
+/*
+ *  Copyright © 2017-2024 Wellington Wallace
+ *
+ *  This file is part of Easy Effects.
+ *
+ *  Easy Effects is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Easy Effects is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "rnnoise_model_cache.hpp"
+
+#ifdef ENABLE_RNNOISE
+
+#include <rnnoise.h>
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include "util.hpp"
+
+auto RNNoiseModelCache::get() -> RNNoiseModelCache& {
+  static RNNoiseModelCache instance;
+
+  return instance;
+}
+
+auto RNNoiseModelCache::load(const std::string& path) -> std::shared_ptr<RNNModel> {
+  std::error_code ec;
+
+  const auto mtime = std::filesystem::last_write_time(path, ec);
+
+  if (ec) {
+    return nullptr;
+  }
+
+  std::scoped_lock<std::mutex> lock(mutex);
+
+  if (auto it = models.find(path); it != models.end() && it->second.mtime == mtime) {
+    if (auto model = it->second.model.lock(); model != nullptr) {
+      util::debug("rnnoise_model_cache: reusing the model " + path);
+
+      return model;
+    }
+  }
+
+  RNNModel* m = nullptr;
+
+  if (FILE* f = fopen(path.c_str(), "r"); f != nullptr) {
+    m = rnnoise_model_from_file(f);
+
+    fclose(f);
+  }
+
+  if (m == nullptr) {
+    models.erase(path);
+
+    return nullptr;
+  }
+
+  auto model = std::shared_ptr<RNNModel>(m, [](RNNModel* m) { rnnoise_model_free(m); });
+
+  models[path] = Entry{.mtime = mtime, .model = model};
+
+  return model;
+}
+
+#endif
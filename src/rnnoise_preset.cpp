@@ -45,6 +45,8 @@ void RNNoisePreset::save(nlohmann::json& json) {
 
   json[section][instance_name]["model-name"] = util::gsettings_get_string(settings, "model-name");
 
+  json[section][instance_name]["linked-mono"] = g_settings_get_boolean(settings, "linked-mono") != 0;
+
   json[section][instance_name]["enable-vad"] = g_settings_get_boolean(settings, "enable-vad") != 0;
 
   json[section][instance_name]["vad-thres"] = g_settings_get_double(settings, "vad-thres");
@@ -61,6 +63,8 @@ void RNNoisePreset::load(const nlohmann::json& json) {
 
   update_key<double>(json.at(section).at(instance_name), settings, "output-gain", "output-gain");
 
+  update_key<bool>(json.at(section).at(instance_name), settings, "linked-mono", "linked-mono");
+
   update_key<bool>(json.at(section).at(instance_name), settings, "enable-vad", "enable-vad");
 
   update_key<double>(json.at(section).at(instance_name), settings, "vad-thres", "vad-thres");
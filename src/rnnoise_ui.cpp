@@ -84,7 +84,7 @@ struct _RNNoiseBox {
   GtkLabel *active_model_name, *model_active_state, *model_error_state, *input_level_left_label,
       *input_level_right_label, *output_level_left_label, *output_level_right_label, *plugin_credit;
 
-  GtkSwitch* enable_vad;
+  GtkSwitch *enable_vad, *linked_mono;
 
   GtkListView* listview;
 
@@ -255,40 +255,19 @@ void setup(RNNoiseBox* self,
         [=]() { g_object_unref(self); });
   }));
 
-  self->data->connections.push_back(rnnoise->input_level.connect([=](const float left, const float right) {
-    g_object_ref(self);
-
-    util::idle_add(
-        [=]() {
-          if (get_ignore_filter_idle_add(serial)) {
-            return;
-          }
-
-          update_level(self->input_level_left, self->input_level_left_label, self->input_level_right,
-                       self->input_level_right_label, left, right);
-        },
-        [=]() { g_object_unref(self); });
-  }));
+  add_meters_tick_callback(GTK_WIDGET(self), rnnoise.get(), [=]() {
+    update_level(self->input_level_left, self->input_level_left_label, self->input_level_right,
+                 self->input_level_right_label, rnnoise->input_level_left_db, rnnoise->input_level_right_db);
 
-  self->data->connections.push_back(rnnoise->output_level.connect([=](const float left, const float right) {
-    g_object_ref(self);
-
-    util::idle_add(
-        [=]() {
-          if (get_ignore_filter_idle_add(serial)) {
-            return;
-          }
-
-          update_level(self->output_level_left, self->output_level_left_label, self->output_level_right,
-                       self->output_level_right_label, left, right);
-        },
-        [=]() { g_object_unref(self); });
-  }));
+    update_level(self->output_level_left, self->output_level_left_label, self->output_level_right,
+                 self->output_level_right_label, rnnoise->output_level_left_db, rnnoise->output_level_right_db);
+  });
 
   gtk_label_set_text(self->plugin_credit, ui::get_plugin_credit_translated(self->data->rnnoise->package).c_str());
 
-  gsettings_bind_widgets<"input-gain", "output-gain", "enable-vad", "vad-thres", "wet", "release">(
-      self->settings, self->input_gain, self->output_gain, self->enable_vad, self->vad_thres, self->wet, self->release);
+  gsettings_bind_widgets<"input-gain", "output-gain", "linked-mono", "enable-vad", "vad-thres", "wet", "release">(
+      self->settings, self->input_gain, self->output_gain, self->linked_mono, self->enable_vad, self->vad_thres,
+      self->wet, self->release);
 
   g_settings_bind_with_mapping(
       self->settings, "model-name", self->selection_model, "selected", G_SETTINGS_BIND_DEFAULT,
@@ -440,6 +419,7 @@ void rnnoise_box_class_init(RNNoiseBoxClass* klass) {
   gtk_widget_class_bind_template_child(widget_class, RNNoiseBox, output_level_right_label);
   gtk_widget_class_bind_template_child(widget_class, RNNoiseBox, plugin_credit);
 
+  gtk_widget_class_bind_template_child(widget_class, RNNoiseBox, linked_mono);
   gtk_widget_class_bind_template_child(widget_class, RNNoiseBox, enable_vad);
   gtk_widget_class_bind_template_child(widget_class, RNNoiseBox, vad_thres);
   gtk_widget_class_bind_template_child(widget_class, RNNoiseBox, wet);
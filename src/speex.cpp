@@ -26,6 +26,7 @@
 #include <climits>
 #include <cstddef>
 #include <mutex>
+#include <numeric>
 #include <span>
 #include <string>
 #include "pipe_manager.hpp"
@@ -182,23 +183,54 @@ Speex::~Speex() {
 void Speex::setup() {
   std::scoped_lock<std::mutex> lock(data_mutex);
 
-  latency_n_frames = 0U;
-
   speex_ready = false;
 
-  data_L.resize(n_samples);
-  data_R.resize(n_samples);
-
-  if (state_left != nullptr) {
-    speex_preprocess_state_destroy(state_left);
+  if (n_samples == 0U || rate == 0U) {
+    return;
   }
 
-  if (state_right != nullptr) {
-    speex_preprocess_state_destroy(state_right);
+  if (rate != state_rate || state_left == nullptr || state_right == nullptr) {
+    init_speex();
   }
 
-  state_left = speex_preprocess_state_init(static_cast<int>(n_samples), static_cast<int>(rate));
-  state_right = speex_preprocess_state_init(static_cast<int>(n_samples), static_cast<int>(rate));
+  /*
+    Priming the output with frame_size - gcd(n_samples, frame_size) frames of silence is the minimum that guarantees a
+    full quantum is always available. It is also the exact latency added by the frame adapter.
+  */
+
+  latency_n_frames = frame_size - std::gcd(n_samples, frame_size);
+
+  input_L.resize(frame_size + n_samples);
+  input_R.resize(frame_size + n_samples);
+
+  output_L.resize(latency_n_frames + frame_size + n_samples);
+  output_R.resize(latency_n_frames + frame_size + n_samples);
+
+  output_L.push_silence(latency_n_frames);
+  output_R.push_silence(latency_n_frames);
+
+  notify_latency = true;
+
+  speex_ready = state_left != nullptr && state_right != nullptr;
+}
+
+void Speex::init_speex() {
+  free_speex();
+
+  state_rate = rate;
+
+  frame_size = static_cast<uint>(frame_duration * static_cast<float>(rate));
+
+  frame_L.resize(frame_size);
+  frame_R.resize(frame_size);
+
+  data_L.resize(frame_size);
+  data_R.resize(frame_size);
+
+  util::debug(log_tag + name + " frame size: " + util::to_string(frame_size));
+
+  state_left = speex_preprocess_state_init(static_cast<int>(frame_size), static_cast<int>(rate));
+  state_right = speex_preprocess_state_init(static_cast<int>(frame_size), static_cast<int>(rate));
 
   if (state_left != nullptr) {
     speex_preprocess_ctl(state_left, SPEEX_PREPROCESS_SET_DENOISE, &enable_denoise);
@@ -225,8 +257,6 @@ void Speex::setup() {
 
     speex_preprocess_ctl(state_right, SPEEX_PREPROCESS_SET_DEREVERB, &enable_dereverb);
   }
-
-  speex_ready = true;
 }
 
 void Speex::process(std::span<float>& left_in,
@@ -246,32 +276,52 @@ void Speex::process(std::span<float>& left_in,
     apply_gain(left_in, right_in, input_gain);
   }
 
-  for (size_t i = 0; i < n_samples; i++) {
-    data_L[i] = static_cast<spx_int16_t>(left_in[i] * (SHRT_MAX + 1));
+  input_L.push(left_in);
+  input_R.push(right_in);
 
-    data_R[i] = static_cast<spx_int16_t>(right_in[i] * (SHRT_MAX + 1));
-  }
+  while (input_L.size() >= frame_size && input_R.size() >= frame_size) {
+    input_L.pop(frame_L);
+    input_R.pop(frame_R);
 
-  if (speex_preprocess_run(state_left, data_L.data()) == 1) {
-    for (size_t i = 0; i < n_samples; i++) {
-      left_out[i] = static_cast<float>(data_L[i]) * inv_short_max;
-    }
-  } else {
-    std::ranges::fill(left_out, 0.0F);
-  }
+    preprocess_frame(state_left, data_L, frame_L);
+    preprocess_frame(state_right, data_R, frame_R);
 
-  if (speex_preprocess_run(state_right, data_R.data()) == 1) {
-    for (size_t i = 0; i < n_samples; i++) {
-      right_out[i] = static_cast<float>(data_R[i]) * inv_short_max;
-    }
-  } else {
-    std::ranges::fill(right_out, 0.0F);
+    output_L.push(frame_L);
+    output_R.push(frame_R);
   }
 
+  // The priming done in setup() makes this branch unreachable unless frames were dropped
+
+  const auto missing = left_out.size() - std::min(output_L.size(), left_out.size());
+
+  std::fill_n(left_out.begin(), missing, 0.0F);
+  std::fill_n(right_out.begin(), missing, 0.0F);
+
+  output_L.pop(left_out.subspan(missing));
+  output_R.pop(right_out.subspan(missing));
+
   if (output_gain != 1.0F) {
     apply_gain(left_out, right_out, output_gain);
   }
 
+  if (notify_latency) {
+    latency_value = static_cast<float>(latency_n_frames) / static_cast<float>(rate);
+
+    util::debug(log_tag + name + " latency: " + util::to_string(latency_value, "") + " s");
+
+    util::idle_add([this]() {
+      if (!post_messages || latency.empty()) {
+        return;
+      }
+
+      latency.emit();
+    });
+
+    update_filter_params();
+
+    notify_latency = false;
+  }
+
   if (post_messages) {
     get_peaks(left_in, right_in, left_out, right_out);
 
@@ -281,6 +331,22 @@ void Speex::process(std::span<float>& left_in,
   }
 }
 
+void Speex::preprocess_frame(SpeexPreprocessState* state,
+                             std::vector<spx_int16_t>& data,
+                             std::vector<float>& frame) {
+  for (size_t i = 0; i < frame.size(); i++) {
+    data[i] = static_cast<spx_int16_t>(frame[i] * (SHRT_MAX + 1));
+  }
+
+  if (speex_preprocess_run(state, data.data()) == 1) {
+    for (size_t i = 0; i < frame.size(); i++) {
+      frame[i] = static_cast<float>(data[i]) * inv_short_max;
+    }
+  } else {
+    std::ranges::fill(frame, 0.0F);
+  }
+}
+
 void Speex::free_speex() {
   if (state_left != nullptr) {
     speex_preprocess_state_destroy(state_left);
@@ -292,6 +358,8 @@ void Speex::free_speex() {
 
   state_left = nullptr;
   state_right = nullptr;
+
+  state_rate = 0U;
 }
 
 auto Speex::get_latency_seconds() -> float {
@@ -26,12 +26,10 @@
 #include <sigc++/functors/mem_fun.h>
 #include <spa/utils/defs.h>
 #include <algorithm>
-#include <chrono>
 #include <cstdlib>
 #include <ranges>
 #include <set>
 #include <string>
-#include <thread>
 #include <vector>
 #include "effects_base.hpp"
 #include "pipe_manager.hpp"
@@ -147,7 +145,7 @@ void StreamInputEffects::on_app_added(const NodeInfo node_info) {
 }
 
 auto StreamInputEffects::apps_want_to_play() -> bool {
-  return std::ranges::any_of(pm->list_links, [&](const auto& link) {
+  return std::ranges::any_of(pm->get_node_links(pm->ee_source_node.id), [&](const auto& link) {
     return (link.output_node_id == pm->ee_source_node.id) && (link.state == PW_LINK_STATE_ACTIVE);
   });
 
@@ -174,7 +172,7 @@ void StreamInputEffects::on_link_changed(const LinkInfo link_info) {
   }
 
   if (apps_want_to_play()) {
-    if (list_proxies.empty()) {
+    if (chain_links.empty()) {
       util::debug("At least one app linked to our device wants to play. Linking our filters.");
 
       connect_filters();
@@ -185,7 +183,7 @@ void StreamInputEffects::on_link_changed(const LinkInfo link_info) {
       // if the timer is enabled, wait for the timeout, then unlink plugin pipeline
       int inactivity_timeout = g_settings_get_int(global_settings, "inactivity-timeout");
       g_timeout_add_seconds(inactivity_timeout, GSourceFunc(+[](StreamInputEffects* self) {
-                              if (!self->apps_want_to_play() && !self->list_proxies.empty()) {
+                              if (!self->apps_want_to_play() && !self->chain_links.empty()) {
                                 util::debug("No app linked to our device wants to play. Unlinking our filters.");
 
                                 self->disconnect_filters();
@@ -197,7 +195,7 @@ void StreamInputEffects::on_link_changed(const LinkInfo link_info) {
 
     } else {
       // otherwise, do nothing
-      if (!list_proxies.empty()) {
+      if (!chain_links.empty()) {
         util::debug(
             "No app linked to our device wants to play, but the inactivity timer is disabled. Leaving filters linked.");
       };
@@ -237,110 +235,75 @@ void StreamInputEffects::connect_filters(const bool& bypass) {
   const auto list =
       (bypass) ? std::vector<std::string>() : util::gchar_array_to_vector(g_settings_get_strv(settings, "plugins"));
 
-  auto mic_linked = false;
-
   // waiting for the input device ports information to be available.
 
-  int timeout = 0;
+  if (!pm->wait_node_ports(pm->input_device.id, 1U)) {
+    util::warning("Information about the ports of the input device " + pm->input_device.name + " with id " +
+                  util::to_string(pm->input_device.id) + " are taking to long to be available. Aborting the link");
 
-  while (pm->count_node_ports(pm->input_device.id) < 1) {
-    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    return;
+  }
 
-    timeout++;
+  connect_plugins_to_pw(list);
 
-    if (timeout > 10000) {
-      util::warning("Information about the ports of the input device " + pm->input_device.name + " with id " +
-                    util::to_string(pm->input_device.id) + " are taking to long to be available. Aborting the link");
+  std::vector<uint> chain = {pm->input_device.id};
 
-      return;
+  for (const auto& name : list) {
+    if (plugins.contains(name) && plugins[name]->connected_to_pw) {
+      chain.push_back(plugins[name]->get_node_id());
     }
   }
 
-  uint prev_node_id = pm->input_device.id;
-  uint next_node_id = 0U;
+  // spectrum, output level meter and source node
 
-  // link plugins
+  chain.push_back(spectrum->get_node_id());
+  chain.push_back(output_level->get_node_id());
+  chain.push_back(pm->ee_source_node.id);
 
-  if (!list.empty()) {
-    for (const auto& name : list) {
-      if (!plugins.contains(name)) {
-        continue;
-      }
+  // mono microphones have a single output port
 
-      if (!plugins[name]->connected_to_pw ? plugins[name]->connect_to_pw() : true) {
-        next_node_id = plugins[name]->get_node_id();
+  link_chain(chain, true);
 
-        const auto links = pm->link_nodes(prev_node_id, next_node_id);
+  update_islands(list);
 
-        for (auto* link : links) {
-          list_proxies.push_back(link);
-        }
+  // checking if we have to link the echo_canceller probe to the output device
 
-        if (mic_linked && (links.size() == 2U)) {
-          prev_node_id = next_node_id;
-        } else if (!mic_linked && (!links.empty())) {
-          prev_node_id = next_node_id;
-          mic_linked = true;
-        } else {
-          util::warning(" link from node " + util::to_string(prev_node_id) + " to node " +
-                        util::to_string(next_node_id) + " failed");
-        }
-      }
-    }
+  pm->destroy_links(list_proxies);
 
-    // checking if we have to link the echo_canceller probe to the output device
+  list_proxies.clear();
 
-    for (const auto& name : list) {
-      if (!plugins.contains(name)) {
-        continue;
-      }
+  for (const auto& name : list) {
+    if (!plugins.contains(name)) {
+      continue;
+    }
 
-      if (name.starts_with(tags::plugin_name::echo_canceller)) {
-        if (plugins[name]->connected_to_pw) {
-          for (const auto& link : pm->link_nodes(pm->output_device.id, plugins[name]->get_node_id(), true)) {
-            list_proxies.push_back(link);
-          }
+    if (name.starts_with(tags::plugin_name::echo_canceller)) {
+      if (plugins[name]->connected_to_pw) {
+        for (const auto& link : pm->link_nodes(pm->output_device.id, plugins[name]->get_node_id(), true)) {
+          list_proxies.push_back(link);
         }
       }
-
-      plugins[name]->update_probe_links();
     }
-  }
-
-  // link spectrum, output level meter and source node
-
-  for (const auto node_id : {spectrum->get_node_id(), output_level->get_node_id(), pm->ee_source_node.id}) {
-    next_node_id = node_id;
 
-    const auto links = pm->link_nodes(prev_node_id, next_node_id);
+    plugins[name]->update_probe_links();
+  }
 
-    for (auto* link : links) {
-      list_proxies.push_back(link);
-    }
+  disconnect_unused_plugins(list);
 
-    if (mic_linked && (links.size() == 2U)) {
-      prev_node_id = next_node_id;
-    } else if (!mic_linked && (!links.empty())) {
-      prev_node_id = next_node_id;
-      mic_linked = true;
-    } else {
-      util::warning(" link from node " + util::to_string(prev_node_id) + " to node " + util::to_string(next_node_id) +
-                    " failed");
-    }
-  }
+  remove_unused_filters();
 }
 
 void StreamInputEffects::disconnect_filters() {
+  unlink_chain();
+
   std::set<uint> link_id_list;
 
   const auto selected_plugins_list =
       (bypass) ? std::vector<std::string>() : util::gchar_array_to_vector(g_settings_get_strv(settings, "plugins"));
 
   for (const auto& plugin : plugins | std::views::values) {
-    for (const auto& link : pm->list_links) {
-      if (link.input_node_id == plugin->get_node_id() || link.output_node_id == plugin->get_node_id()) {
-        link_id_list.insert(link.id);
-      }
+    for (const auto& link : pm->get_node_links(plugin->get_node_id())) {
+      link_id_list.insert(link.id);
     }
 
     if (plugin->connected_to_pw) {
@@ -352,9 +315,8 @@ void StreamInputEffects::disconnect_filters() {
     }
   }
 
-  for (const auto& link : pm->list_links) {
-    if (link.input_node_id == spectrum->get_node_id() || link.output_node_id == spectrum->get_node_id() ||
-        link.input_node_id == output_level->get_node_id() || link.output_node_id == output_level->get_node_id()) {
+  for (const auto& node_id : {spectrum->get_node_id(), output_level->get_node_id()}) {
+    for (const auto& link : pm->get_node_links(node_id)) {
       link_id_list.insert(link.id);
     }
   }
@@ -373,8 +335,6 @@ void StreamInputEffects::disconnect_filters() {
 void StreamInputEffects::set_bypass(const bool& state) {
   bypass = state;
 
-  disconnect_filters();
-
   connect_filters(state);
 }
 
@@ -27,12 +27,10 @@
 #include <sigc++/functors/mem_fun.h>
 #include <spa/utils/defs.h>
 #include <algorithm>
-#include <chrono>
 #include <cstdlib>
 #include <ranges>
 #include <set>
 #include <string>
-#include <thread>
 #include <vector>
 #include "effects_base.hpp"
 #include "pipe_manager.hpp"
@@ -147,7 +145,7 @@ void StreamOutputEffects::on_app_added(const NodeInfo node_info) {
 }
 
 auto StreamOutputEffects::apps_want_to_play() -> bool {
-  return std::ranges::any_of(pm->list_links, [&](const auto& link) {
+  return std::ranges::any_of(pm->get_node_links(pm->ee_sink_node.id), [&](const auto& link) {
     return (link.input_node_id == pm->ee_sink_node.id) && (link.state == PW_LINK_STATE_ACTIVE);
   });
 }
@@ -184,117 +182,76 @@ void StreamOutputEffects::connect_filters(const bool& bypass) {
   const auto list =
       (bypass) ? std::vector<std::string>() : util::gchar_array_to_vector(g_settings_get_strv(settings, "plugins"));
 
-  uint prev_node_id = pm->ee_sink_node.id;
-  uint next_node_id = 0U;
+  connect_plugins_to_pw(list);
 
-  // link plugins
+  std::vector<uint> chain = {pm->ee_sink_node.id};
 
-  if (!list.empty()) {
-    for (const auto& name : list) {
-      if (!plugins.contains(name)) {
-        continue;
-      }
-
-      if (!plugins[name]->connected_to_pw ? plugins[name]->connect_to_pw() : true) {
-        next_node_id = plugins[name]->get_node_id();
-
-        const auto links = pm->link_nodes(prev_node_id, next_node_id);
-
-        for (auto* link : links) {
-          list_proxies.push_back(link);
-        }
-
-        if (links.size() == 2U) {
-          prev_node_id = next_node_id;
-        } else {
-          util::warning(" link from node " + util::to_string(prev_node_id) + " to node " +
-                        util::to_string(next_node_id) + " failed");
-        }
-      }
-    }
-
-    // checking if we have to link the echo_canceller probe to the output device
-
-    for (const auto& name : list) {
-      if (!plugins.contains(name)) {
-        continue;
-      }
-
-      if (name.starts_with(tags::plugin_name::echo_canceller)) {
-        if (plugins[name]->connected_to_pw) {
-          for (const auto& link : pm->link_nodes(pm->output_device.id, plugins[name]->get_node_id(), true)) {
-            list_proxies.push_back(link);
-          }
-        }
-      }
-
-      plugins[name]->update_probe_links();
+  for (const auto& name : list) {
+    if (plugins.contains(name) && plugins[name]->connected_to_pw) {
+      chain.push_back(plugins[name]->get_node_id());
     }
   }
 
-  // link spectrum and output level meter
+  // spectrum and output level meter
 
-  for (const auto& node_id : {spectrum->get_node_id(), output_level->get_node_id()}) {
-    next_node_id = node_id;
+  chain.push_back(spectrum->get_node_id());
+  chain.push_back(output_level->get_node_id());
 
-    const auto links = pm->link_nodes(prev_node_id, next_node_id);
+  // waiting for the output device ports information to be available.
 
-    for (auto* link : links) {
-      list_proxies.push_back(link);
-    }
+  if (!pm->wait_node_ports(pm->output_device.id, 2U)) {
+    util::warning("Information about the ports of the output device " + pm->output_device.name + " with id " +
+                  util::to_string(pm->output_device.id) + " are taking to long to be available. Aborting the link");
 
-    if (links.size() == 2U) {
-      prev_node_id = next_node_id;
-    } else {
-      util::warning(" link from node " + util::to_string(prev_node_id) + " to node " + util::to_string(next_node_id) +
-                    " failed");
-    }
-  }
+    // Linking a chain without the device would destroy the link it still has to the previous one
 
-  // waiting for the output device ports information to be available.
+    return;
+  }
 
-  int timeout = 0;
+  chain.push_back(pm->output_device.id);
 
-  while (pm->count_node_ports(pm->output_device.id) < 2) {
-    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  link_chain(chain);
 
-    timeout++;
+  update_islands(list);
 
-    if (timeout > 10000) {  // 10 seconds
-      util::warning("Information about the ports of the output device " + pm->output_device.name + " with id " +
-                    util::to_string(pm->output_device.id) + " are taking to long to be available. Aborting the link");
+  // checking if we have to link the echo_canceller probe to the output device
 
-      return;
-    }
-  }
+  pm->destroy_links(list_proxies);
 
-  // link output device
+  list_proxies.clear();
 
-  next_node_id = pm->output_device.id;
+  for (const auto& name : list) {
+    if (!plugins.contains(name)) {
+      continue;
+    }
 
-  const auto links = pm->link_nodes(prev_node_id, next_node_id);
+    if (name.starts_with(tags::plugin_name::echo_canceller)) {
+      if (plugins[name]->connected_to_pw) {
+        for (const auto& link : pm->link_nodes(pm->output_device.id, plugins[name]->get_node_id(), true)) {
+          list_proxies.push_back(link);
+        }
+      }
+    }
 
-  for (auto* link : links) {
-    list_proxies.push_back(link);
+    plugins[name]->update_probe_links();
   }
 
-  if (links.size() < 2U) {
-    util::warning(" link from node " + util::to_string(prev_node_id) + " to output device " +
-                  util::to_string(next_node_id) + " failed");
-  }
+  disconnect_unused_plugins(list);
+
+  remove_unused_filters();
 }
 
 void StreamOutputEffects::disconnect_filters() {
+  unlink_chain();
+
   std::set<uint> link_id_list;
 
   const auto selected_plugins_list =
       (bypass) ? std::vector<std::string>() : util::gchar_array_to_vector(g_settings_get_strv(settings, "plugins"));
 
   for (const auto& plugin : plugins | std::views::values) {
-    for (const auto& link : pm->list_links) {
-      if (link.input_node_id == plugin->get_node_id() || link.output_node_id == plugin->get_node_id()) {
-        link_id_list.insert(link.id);
-      }
+    for (const auto& link : pm->get_node_links(plugin->get_node_id())) {
+      link_id_list.insert(link.id);
     }
 
     if (plugin->connected_to_pw) {
@@ -306,9 +263,8 @@ void StreamOutputEffects::disconnect_filters() {
     }
   }
 
-  for (const auto& link : pm->list_links) {
-    if (link.input_node_id == spectrum->get_node_id() || link.output_node_id == spectrum->get_node_id() ||
-        link.input_node_id == output_level->get_node_id() || link.output_node_id == output_level->get_node_id()) {
+  for (const auto& node_id : {spectrum->get_node_id(), output_level->get_node_id()}) {
+    for (const auto& link : pm->get_node_links(node_id)) {
       link_id_list.insert(link.id);
     }
   }
@@ -327,7 +283,5 @@ void StreamOutputEffects::disconnect_filters() {
 void StreamOutputEffects::set_bypass(const bool& state) {
   bypass = state;
 
-  disconnect_filters();
-
   connect_filters(state);
 }
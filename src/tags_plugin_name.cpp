@@ -51,6 +51,7 @@ auto get_translated() -> std::map<std::string, std::string> {
                                                    {expander, _("Expander")},
                                                    {filter, _("Filter")},
                                                    {gate, _("Gate")},
+                                                   {generic_lv2, _("Generic LV2")},
                                                    {level_meter, _("Level Meter")},
                                                    {limiter, _("Limiter")},
                                                    {loudness, _("Loudness")},
@@ -131,6 +132,10 @@ auto get_base_name(std::string_view name) -> std::string {
     return tags::plugin_name::gate;
   }
 
+  if (name.starts_with(tags::plugin_name::generic_lv2)) {
+    return tags::plugin_name::generic_lv2;
+  }
+
   if (name.starts_with(tags::plugin_name::level_meter)) {
     return tags::plugin_name::level_meter;
   }
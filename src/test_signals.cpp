@@ -25,11 +25,10 @@
 #include <spa/node/io.h>
 #include <spa/utils/hook.h>
 #include <sys/types.h>
-#include <chrono>
 #include <cmath>
+#include <mutex>
 #include <numbers>
 #include <span>
-#include <thread>
 #include "pipe_manager.hpp"
 #include "tags_app.hpp"
 #include "util.hpp"
@@ -109,27 +108,33 @@ void on_process(void* userdata, spa_io_position* position) {
 void on_filter_state_changed(void* userdata, pw_filter_state old, pw_filter_state state, const char* error) {
   auto* d = static_cast<TestSignals::data*>(userdata);
 
-  d->ts->state = state;
-
-  switch (state) {
-    case PW_FILTER_STATE_ERROR:
-      d->ts->can_get_node_id = false;
-      break;
-    case PW_FILTER_STATE_UNCONNECTED:
-      d->ts->can_get_node_id = false;
-      break;
-    case PW_FILTER_STATE_CONNECTING:
-      d->ts->can_get_node_id = false;
-      break;
-    case PW_FILTER_STATE_STREAMING:
-      d->ts->can_get_node_id = true;
-      break;
-    case PW_FILTER_STATE_PAUSED:
-      d->ts->can_get_node_id = true;
-      break;
-    default:
-      break;
+  {
+    std::scoped_lock<std::mutex> lock(d->ts->state_mutex);
+
+    d->ts->state = state;
+
+    switch (state) {
+      case PW_FILTER_STATE_ERROR:
+        d->ts->can_get_node_id = false;
+        break;
+      case PW_FILTER_STATE_UNCONNECTED:
+        d->ts->can_get_node_id = false;
+        break;
+      case PW_FILTER_STATE_CONNECTING:
+        d->ts->can_get_node_id = false;
+        break;
+      case PW_FILTER_STATE_STREAMING:
+        d->ts->can_get_node_id = true;
+        break;
+      case PW_FILTER_STATE_PAUSED:
+        d->ts->can_get_node_id = true;
+        break;
+      default:
+        break;
+    }
   }
+
+  d->ts->state_cv.notify_all();
 }
 
 const struct pw_filter_events filter_events = {.state_changed = on_filter_state_changed, .process = on_process};
@@ -192,12 +197,19 @@ TestSignals::TestSignals(PipeManager* pipe_manager) : pm(pipe_manager), random_g
 
   pm->sync_wait_unlock();
 
-  while (!can_get_node_id) {
-    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  {
+    using namespace std::string_literals;
+
+    std::unique_lock<std::mutex> lock(state_mutex);
 
-    if (state == PW_FILTER_STATE_ERROR) {
-      using namespace std::string_literals;
+    if (!state_cv.wait_for(lock, PipeManager::wait_timeout,
+                           [this]() { return can_get_node_id || state == PW_FILTER_STATE_ERROR; })) {
+      util::warning(filter_name + " took too long to connect to PipeWire"s);
 
+      return;
+    }
+
+    if (state == PW_FILTER_STATE_ERROR) {
       util::warning(filter_name + " is in an error"s);
 
       return;
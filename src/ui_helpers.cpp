@@ -30,11 +30,14 @@
 #include <gtk/gtkshortcut.h>
 #include <sys/types.h>
 #include <algorithm>
+#include <atomic>
+#include <functional>
 #include <locale>
 #include <map>
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include "plugin_base.hpp"
 #include "tags_app.hpp"
 #include "tags_plugin_name.hpp"
 #include "util.hpp"
@@ -49,6 +52,50 @@ std::map<uint, bool> map_ignore_filter_idle_add;
 
 GSettings* global_app_settings = nullptr;
 
+struct MetersTick {
+  PluginBase* plugin = nullptr;
+
+  uint serial = 0U;
+
+  guint tick_id = 0U;
+
+  gulong map_handler_id = 0U, unmap_handler_id = 0U;
+
+  std::function<void()> callback;
+};
+
+auto on_meters_tick(GtkWidget* widget, GdkFrameClock* frame_clock, gpointer user_data) -> gboolean {
+  auto* mt = static_cast<MetersTick*>(user_data);
+
+  const auto serial = mt->plugin->meters_serial.load(std::memory_order_acquire);
+
+  // No new values were published since the last frame, no redraw required.
+
+  if (serial == mt->serial) {
+    return G_SOURCE_CONTINUE;
+  }
+
+  mt->serial = serial;
+
+  mt->callback();
+
+  return G_SOURCE_CONTINUE;
+}
+
+void add_meters_tick(GtkWidget* widget, MetersTick* mt) {
+  if (mt->tick_id == 0U) {
+    mt->tick_id = gtk_widget_add_tick_callback(widget, on_meters_tick, mt, nullptr);
+  }
+}
+
+void remove_meters_tick(GtkWidget* widget, MetersTick* mt) {
+  if (mt->tick_id != 0U) {
+    gtk_widget_remove_tick_callback(widget, mt->tick_id);
+
+    mt->tick_id = 0U;
+  }
+}
+
 }  // namespace
 
 namespace ui {
@@ -248,6 +295,29 @@ void update_level(GtkLevelBar* w_left,
   }
 }
 
+void add_meters_tick_callback(GtkWidget* widget, PluginBase* plugin, std::function<void()> callback) {
+  // A previous registration is replaced. Its handlers must be gone before g_object_set_data_full frees it.
+
+  if (auto* old_mt = static_cast<MetersTick*>(g_object_get_data(G_OBJECT(widget), "meters-tick")); old_mt != nullptr) {
+    remove_meters_tick(widget, old_mt);
+
+    g_signal_handler_disconnect(widget, old_mt->map_handler_id);
+    g_signal_handler_disconnect(widget, old_mt->unmap_handler_id);
+  }
+
+  auto* mt = new MetersTick{.plugin = plugin, .callback = std::move(callback)};
+
+  g_object_set_data_full(G_OBJECT(widget), "meters-tick", mt,
+                         +[](gpointer data) { delete static_cast<MetersTick*>(data); });
+
+  mt->map_handler_id = g_signal_connect(widget, "map", G_CALLBACK(add_meters_tick), mt);
+  mt->unmap_handler_id = g_signal_connect(widget, "unmap", G_CALLBACK(remove_meters_tick), mt);
+
+  if (gtk_widget_get_mapped(widget) != 0) {
+    add_meters_tick(widget, mt);
+  }
+}
+
 auto get_plugin_credit_translated(const std::string& plugin_package) -> std::string {
   try {
     // For translators: {} is replaced by the library used by the plugin. I.e. "Using Calf Studio".